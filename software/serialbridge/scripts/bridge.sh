@@ -5,18 +5,8 @@ if [[ $# -eq 3 ]]; then
 	baudrate=$2
 	port=$3
 	cmdline="SerialBridge -d $1 -b $2 -p $3"
-	
-	while true; do
-		if [[ -c "$1" ]]; then
-			printf -- "\rStarting $1\n"
-			exec $cmdline
-		else
-			printf -- "\rWaiting for $1";
-			sleep 3;
-		fi
-	done
-
 
+	# the bridge waits for the device itself and reopens it after a replug, while serving its clients
+	printf -- "Starting $1\n"
+	exec $cmdline
 fi
-
-
@@ -6,12 +6,197 @@
  * @copyright	GPLv3
  */
 
+#include <algorithm>
+#include <sstream>
+
 #include <boost/system/config.hpp>
 #include <boost/program_options.hpp>
+#include <boost/property_tree/ini_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
 
 #include "Arguments.h"
 #include "System.h"
 
+static const char* toString(NetworkServer::eOverflowPolicy policy)
+{
+    switch (policy)
+    {
+    case NetworkServer::eOverflowPolicy::DropOldest: return "drop";
+    case NetworkServer::eOverflowPolicy::Disconnect: return "disconnect";
+    default: return "pause";
+    }
+}
+
+static NetworkServer::eOverflowPolicy parseOverflowPolicy(const std::string& policy)
+{
+    if (policy == "pause")
+        return NetworkServer::eOverflowPolicy::PauseSource;
+    if (policy == "drop")
+        return NetworkServer::eOverflowPolicy::DropOldest;
+    if (policy == "disconnect")
+        return NetworkServer::eOverflowPolicy::Disconnect;
+
+    throw std::invalid_argument("unknown overflow policy: " + policy);
+}
+
+static const char* toString(System::eIoBackend backend)
+{
+    return System::eIoBackend::IoUring == backend ? "uring" : "asio";
+}
+
+static System::eIoBackend parseIoBackend(const std::string& backend)
+{
+    if (backend == "asio")
+        return System::eIoBackend::Asio;
+    if (backend == "uring")
+        return System::eIoBackend::IoUring;
+
+    throw std::invalid_argument("unknown io backend: " + backend);
+}
+
+static SerialPort::eParity parseParity(const std::string& parity)
+{
+    if (parity == "none")
+        return SerialPort::eParity::None;
+    if (parity == "odd")
+        return SerialPort::eParity::Odd;
+    if (parity == "even")
+        return SerialPort::eParity::Even;
+
+    throw std::invalid_argument("unknown parity: " + parity);
+}
+
+static SerialPort::eStopBits parseStopBits(const std::string& stopBits)
+{
+    if (stopBits == "1")
+        return SerialPort::eStopBits::One;
+    if (stopBits == "1.5")
+        return SerialPort::eStopBits::OnePointFive;
+    if (stopBits == "2")
+        return SerialPort::eStopBits::Two;
+
+    throw std::invalid_argument("unknown stop bits: " + stopBits);
+}
+
+static const char* toString(SerialPort::eFlowControl flowControl)
+{
+    switch (flowControl)
+    {
+    case SerialPort::eFlowControl::Hardware: return "hardware";
+    case SerialPort::eFlowControl::Software: return "software";
+    default: return "none";
+    }
+}
+
+static SerialPort::eFlowControl parseFlowControl(const std::string& flowControl)
+{
+    if (flowControl == "none")
+        return SerialPort::eFlowControl::None;
+    if (flowControl == "hardware" || flowControl == "rtscts")
+        return SerialPort::eFlowControl::Hardware;
+    if (flowControl == "software" || flowControl == "xonxoff")
+        return SerialPort::eFlowControl::Software;
+
+    throw std::invalid_argument("unknown flow control: " + flowControl);
+}
+
+static const char* toString(SerialPort::eLatencyMode mode)
+{
+    switch (mode)
+    {
+    case SerialPort::eLatencyMode::LowLatency: return "low-latency";
+    case SerialPort::eLatencyMode::Batching: return "batching";
+    default: return "system";
+    }
+}
+
+static SerialPort::eLatencyMode parseLatencyMode(const std::string& mode)
+{
+    if (mode == "system")
+        return SerialPort::eLatencyMode::System;
+    if (mode == "low-latency")
+        return SerialPort::eLatencyMode::LowLatency;
+    if (mode == "batching")
+        return SerialPort::eLatencyMode::Batching;
+
+    throw std::invalid_argument("unknown serial latency mode: " + mode);
+}
+
+static const char* toString(SerialPort::eOfflinePolicy policy)
+{
+    switch (policy)
+    {
+    case SerialPort::eOfflinePolicy::Drop: return "drop";
+    case SerialPort::eOfflinePolicy::Notify: return "notify";
+    default: return "pause";
+    }
+}
+
+static SerialPort::eOfflinePolicy parseOfflinePolicy(const std::string& policy)
+{
+    if (policy == "pause")
+        return SerialPort::eOfflinePolicy::Pause;
+    if (policy == "drop")
+        return SerialPort::eOfflinePolicy::Drop;
+    if (policy == "notify")
+        return SerialPort::eOfflinePolicy::Notify;
+
+    throw std::invalid_argument("unknown serial offline policy: " + policy);
+}
+
+/** a single character, an escape (\n, \r, \t, \0) or a hex byte (0x0a) */
+static int parseDelimiter(const std::string& delimiter)
+{
+    if (delimiter.empty())
+        return -1;
+    if (1 == delimiter.size())
+        return static_cast<unsigned char>(delimiter[0]);
+    if (delimiter == "\\n")
+        return '\n';
+    if (delimiter == "\\r")
+        return '\r';
+    if (delimiter == "\\t")
+        return '\t';
+    if (delimiter == "\\0")
+        return 0;
+
+    if (delimiter.size() > 2 && '0' == delimiter[0] && ('x' == delimiter[1] || 'X' == delimiter[1]))
+    {
+        size_t parsed = 0;
+        const unsigned long value = std::stoul(delimiter.substr(2), &parsed, 16);
+
+        if (parsed + 2 == delimiter.size() && value <= 0xFF)
+            return static_cast<int>(value);
+    }
+
+    throw std::invalid_argument("unknown delimiter: " + delimiter);
+}
+
+static const char* toString(NetworkServer::eSocketProfile profile)
+{
+    switch (profile)
+    {
+    case NetworkServer::eSocketProfile::Interactive: return "interactive";
+    case NetworkServer::eSocketProfile::Bulk: return "bulk";
+    case NetworkServer::eSocketProfile::Custom: return "custom";
+    default: return "system";
+    }
+}
+
+static NetworkServer::eSocketProfile parseSocketProfile(const std::string& profile)
+{
+    if (profile == "system")
+        return NetworkServer::eSocketProfile::System;
+    if (profile == "interactive")
+        return NetworkServer::eSocketProfile::Interactive;
+    if (profile == "bulk")
+        return NetworkServer::eSocketProfile::Bulk;
+    if (profile == "custom")
+        return NetworkServer::eSocketProfile::Custom;
+
+    throw std::invalid_argument("unknown tcp profile: " + profile);
+}
+
 std::ostream &operator<<(std::ostream & oStream, const Arguments & conf)
 {
     oStream << "SerialBridge Configuration " << std::endl
@@ -20,6 +205,80 @@ std::ostream &operator<<(std::ostream & oStream, const Arguments & conf)
     oStream << "Port: " << conf.port << std::endl;
     oStream << "Device: " << conf.strDevice << std::endl;
     oStream << "Baudrate: " << conf.uiBaudrate << std::endl;
+    oStream << "Framing: " << conf.uiDataBits << "NOE"[static_cast<size_t>(conf.parity)]
+            << (SerialPort::eStopBits::One == conf.stopBits ? "1" : (SerialPort::eStopBits::Two == conf.stopBits ? "2" : "1.5")) << std::endl;
+    oStream << "Flow Control: " << toString(conf.flowControl) << std::endl;
+    oStream << "RX Buffers: " << conf.uiRxBufferCount << " x " << conf.uiRxBufferSize << " bytes" << std::endl;
+    oStream << "TX Watermarks: " << conf.uiTxLowWatermark << " / " << conf.uiTxHighWatermark << " KiB" << std::endl;
+    oStream << "Overflow Policy: " << toString(conf.overflowPolicy) << std::endl;
+    oStream << "Serial Latency: " << toString(conf.latencyMode);
+
+    if (conf.uiLatencyTimer > 0)
+    {
+        oStream << " (latency timer " << conf.uiLatencyTimer << " ms)";
+    }
+
+    oStream << std::endl;
+    oStream << "Serial Coalescing: ";
+
+    if (conf.uiSerialCoalesceMicros > 0)
+    {
+        oStream << conf.uiSerialCoalesceMicros << " us / " << conf.uiSerialCoalesceBytes << " B";
+
+        if (conf.serialDelimiter >= 0)
+        {
+            oStream << ", delimiter 0x" << std::hex << conf.serialDelimiter << std::dec;
+        }
+    }
+    else
+    {
+        oStream << "off";
+    }
+
+    oStream << std::endl;
+    oStream << "History: ";
+
+    if (conf.uiHistory > 0)
+    {
+        oStream << conf.uiHistory << " KiB";
+    }
+    else
+    {
+        oStream << "off";
+    }
+
+    oStream << std::endl;
+    oStream << "Spool: ";
+
+    if (!conf.strSpoolDir.empty())
+    {
+        oStream << conf.strSpoolDir << " (" << conf.uiSpoolSize << " MiB in " << conf.uiSpoolSegment << " KiB segments, sync " << conf.uiSpoolSync << " ms)";
+    }
+    else
+    {
+        oStream << "off";
+    }
+
+    oStream << std::endl;
+    oStream << "Capture: " << (conf.strCapture.empty() ? "off" : conf.strCapture) << std::endl;
+    oStream << "Reconnect: " << conf.uiReconnectMin << " - " << conf.uiReconnectMax << " ms, offline " << toString(conf.offlinePolicy) << std::endl;
+    oStream << "I/O Backend: " << toString(conf.ioBackend) << std::endl;
+    oStream << "Splice Passthrough: " << (conf.useSplice ? "on" : "off") << std::endl;
+
+    const NetworkServer::SocketOptions & tcp = conf.socketOptions;
+    oStream << "TCP Profile: " << toString(tcp.profile)
+            << " (nodelay " << tcp.noDelay << ", quickack " << tcp.quickAck
+            << ", sndbuf " << tcp.sendBuffer << ", rcvbuf " << tcp.receiveBuffer
+            << ", keepalive " << tcp.keepAliveIdle << "/" << tcp.keepAliveInterval << "/" << tcp.keepAliveCount
+            << ", user timeout " << tcp.userTimeoutMillis << " ms)" << std::endl;
+    oStream << "Threads: " << conf.uiThreads;
+
+    for (size_t i = 0; i < conf.cpuAffinity.size(); ++i)
+    {
+        oStream << (0 == i ? " (cpus " : ",") << conf.cpuAffinity[i];
+    }
+
+    oStream << (conf.cpuAffinity.empty() ? "" : ")") << std::endl;
 
     return oStream;
 }
@@ -30,72 +289,413 @@ std::ostream &operator<<(std::ostream & oStream, const Arguments & conf)
 
 using namespace boost::program_options;
 
-bool parseArguments(Arguments & config, int argc, char* argv[])
+/** the options shared by the command line and the bridge sections of a config file */
+static void addBridgeOptions(options_description & options)
 {
-    options_description cmdlineOptions("Usage");
-    options_description generic("Generic");
     options_description device("Device");
     options_description serverInterface("Server Interface (UDP/TCP)");
-
-    generic.add_options()
-            ("help,h", "this description")
-            ("config", "prints the current configuration")
-            ("version,v", "about this software")
-            ;
+    options_description queues("Queues");
+    options_description tcpOptions("TCP Socket Options (with --tcp-profile custom)");
 
     device.add_options()
-            ("device,d", value< std::string >()->default_value( "/dev/ttyUSB0" ), "path to the serial device")
+            ("device,d", value< std::string >()->default_value( "/dev/ttyUSB0" ), "path to the serial device, or usb:VID:PID[:SERIAL] for the node a usb-serial adapter gets (Linux)")
             ("baudrate,b", value<unsigned int>()->default_value( 115200U ), "sets baudrate for selected device")
+            ("data-bits", value<unsigned int>()->default_value( 8U ), "character size, 5 to 8")
+            ("parity", value< std::string >()->default_value( "none" ), "none, odd or even")
+            ("stop-bits", value< std::string >()->default_value( "1" ), "1, 1.5 (windows only) or 2")
+            ("flow-control", value< std::string >()->default_value( "none" ), "none, hardware (RTS/CTS) or software (XON/XOFF)")
+            ("rx-buffer", value<unsigned int>()->default_value( 512U ), "size of each receive buffer in bytes (serial and network)")
+            ("rx-buffers", value<unsigned int>()->default_value( 2U ), "number of receive buffers cycled per read path (>= 2)")
+            ("serial-latency", value< std::string >()->default_value( "system" ), "system (driver settings), low-latency (ASYNC_LOW_LATENCY, 1 ms usb latency timer) or batching (16 ms latency timer)")
+            ("latency-timer", value<unsigned int>()->default_value( 0U ), "usb-serial latency timer in ms (1-255) overriding the latency mode, 0 keeps the mode's value")
+            ("serial-coalesce-us", value<unsigned int>()->default_value( 0U ), "collects serial data for at most the given microseconds into larger network writes (0 = off, disables --splice)")
+            ("serial-coalesce-bytes", value<unsigned int>()->default_value( 1448U ), "sends the collected serial data once it reaches this size")
+            ("serial-delimiter", value< std::string >()->default_value( "" ), "sends the collected serial data up to this byte at once: a character, \\n, \\r, \\t, \\0 or 0xNN")
+            ("history", value<unsigned int>()->default_value( 0U ), "KiB of recent serial output replayed to each new client before live data (0 = off, at most the tx high watermark, disables --splice)")
+            ("spool-dir", value< std::string >()->default_value( "" ), "directory keeping the serial data while no client is connected, the first client gets it before live data (one per bridge, disables --splice)")
+            ("spool-size", value<unsigned int>()->default_value( 64U ), "MiB the spool may take, the oldest data is dropped beyond")
+            ("spool-segment", value<unsigned int>()->default_value( 1024U ), "KiB per spool segment file")
+            ("spool-sync-ms", value<unsigned int>()->default_value( 1000U ), "ms spooled data may wait for a sync to disk, batching the writes (0 = left to the kernel)")
+            ("capture", value< std::string >()->default_value( "" ), "records every chunk in either direction with a timestamp into this file, see serialbridge_dump (disables --splice)")
+            ("reconnect-min", value<unsigned int>()->default_value( 100U ), "ms before retrying to open a missing or failed device, doubled per attempt")
+            ("reconnect-max", value<unsigned int>()->default_value( 5000U ), "ms the retry interval grows to")
+            ("serial-offline", value< std::string >()->default_value( "pause" ), "client data while the device is away: pause (kept in the socket buffers), drop, notify (drop and tell the clients)")
+            ("io-backend", value< std::string >()->default_value( "asio" ), "asio (epoll reactor) or uring (io_uring for the device and plain TCP clients, falls back to asio)")
+            ("splice", "moves the data through kernel pipes (splice) while a single plain TCP client is attached (asio backend)")
             ;
 
     serverInterface.add_options()
             ("ip,i", value< std::string >()->default_value( System::ALL_INTERFACES ), "Address of the server" )
             ("port,p", value<uint16_t>()->default_value( 23 ), "Port of the server" )
             ("udp,u", "Use UDP/IP instead of TCP/IP" )
-            //("ssl-cert,r", value< std::string >()->default_value( "" ), "ssl cert of the server" )
+            ("udp-max-datagram", value<unsigned int>()->default_value( 1472U ), "UDP payload bytes per datagram")
+            ("udp-coalesce-us", value<unsigned int>()->default_value( 1000U ), "UDP window in microseconds for collecting serial data into one datagram (0 = off)")
+            ("udp-peer-timeout", value<unsigned int>()->default_value( 60U ), "seconds until a silent UDP peer is dropped")
+            ("udp-reliable", "sequenced frames with selective acks and retransmission on top of UDP")
+            ("udp-sim-loss", value<unsigned int>()->default_value( 0U ), "testing: drops the given percentage of datagrams (reliable mode)")
+            ("udp-sim-reorder", value<unsigned int>()->default_value( 0U ), "testing: reorders the given percentage of sent datagrams (reliable mode)")
+            ("ssl-cert,r", value< std::string >()->default_value( "" ), "PEM certificate (chain) of the server, enables TLS on TCP" )
+            ("ssl-key", value< std::string >()->default_value( "" ), "PEM private key, if not contained in the certificate file" )
             ;
 
-    cmdlineOptions.add(generic).add(device).add(serverInterface);
+    queues.add_options()
+            ("tx-high-watermark", value<unsigned int>()->default_value( 256U ), "KiB queued per client (and towards the device) before the overflow policy applies")
+            ("tx-low-watermark", value<unsigned int>()->default_value( 64U ), "KiB a congested queue has to drain to")
+            ("overflow-policy", value< std::string >()->default_value( "pause" ), "slow client handling: pause (serial reads), drop (oldest data), disconnect")
+            ("stats", value<unsigned int>()->default_value( 0U ), "prints queue statistics every given seconds (0 = off)")
+            ;
 
-    try
+    tcpOptions.add_options()
+            ("tcp-profile", value< std::string >()->default_value( "system" ), "socket options of accepted clients: system, interactive (low latency consoles), bulk (throughput), custom (the system defaults plus the options below)")
+            ("tcp-nodelay", value<bool>(), "disables Nagle's algorithm (0/1)")
+            ("tcp-quickack", value<bool>(), "acknowledges every segment immediately instead of delaying acks (0/1)")
+            ("tcp-sndbuf", value<unsigned int>(), "socket send buffer in bytes")
+            ("tcp-rcvbuf", value<unsigned int>(), "socket receive buffer in bytes")
+            ("tcp-keepalive", value<unsigned int>(), "seconds of silence before keepalive probing starts (0 = off)")
+            ("tcp-keepalive-interval", value<unsigned int>(), "seconds between keepalive probes")
+            ("tcp-keepalive-count", value<unsigned int>(), "unanswered probes until a client is dropped")
+            ("tcp-user-timeout", value<unsigned int>(), "milliseconds sent data may stay unacknowledged before the client is dropped")
+            ;
+
+    options.add(device).add(serverInterface).add(queues).add(tcpOptions);
+}
+
+
+/** copies the parsed bridge options into the configuration */
+static void applyBridgeOptions(Arguments & config, const variables_map & vm)
+{
+    // device
+    if (vm.count("baudrate"))
     {
-        variables_map vm;
-        store(parse_command_line(argc, argv, cmdlineOptions), vm);
-        notify(vm);
+        config.uiBaudrate = vm["baudrate"].as<unsigned int>();
+    }
+
+    if (vm.count("device"))
+    {
+        config.strDevice = vm["device"].as< std::string >();
+    }
+
+    if (vm.count("data-bits"))
+    {
+        config.uiDataBits = vm["data-bits"].as<unsigned int>();
 
-        // device
-        if (vm.count("baudrate"))
+        if (config.uiDataBits < 5 || config.uiDataBits > 8)
         {
-            config.uiBaudrate = vm["baudrate"].as<unsigned int>();
+            throw std::invalid_argument("data bits have to be 5 to 8");
         }
+    }
+
+    if (vm.count("parity"))
+    {
+        config.parity = parseParity(vm["parity"].as< std::string >());
+    }
+
+    if (vm.count("stop-bits"))
+    {
+        config.stopBits = parseStopBits(vm["stop-bits"].as< std::string >());
+    }
+
+    if (vm.count("flow-control"))
+    {
+        config.flowControl = parseFlowControl(vm["flow-control"].as< std::string >());
+    }
 
-        if (vm.count("device"))
+    if (vm.count("rx-buffer"))
+    {
+        config.uiRxBufferSize = std::max(1U, vm["rx-buffer"].as<unsigned int>());
+    }
+
+    if (vm.count("rx-buffers"))
+    {
+        config.uiRxBufferCount = std::max(2U, vm["rx-buffers"].as<unsigned int>());
+    }
+
+    if (vm.count("serial-latency"))
+    {
+        config.latencyMode = parseLatencyMode(vm["serial-latency"].as< std::string >());
+    }
+
+    if (vm.count("latency-timer"))
+    {
+        config.uiLatencyTimer = std::min(255U, vm["latency-timer"].as<unsigned int>());
+    }
+
+    if (vm.count("serial-coalesce-us"))
+    {
+        config.uiSerialCoalesceMicros = vm["serial-coalesce-us"].as<unsigned int>();
+    }
+
+    if (vm.count("serial-coalesce-bytes"))
+    {
+        config.uiSerialCoalesceBytes = std::max(1U, vm["serial-coalesce-bytes"].as<unsigned int>());
+    }
+
+    if (vm.count("serial-delimiter"))
+    {
+        config.serialDelimiter = parseDelimiter(vm["serial-delimiter"].as< std::string >());
+    }
+
+    if (vm.count("history"))
+    {
+        config.uiHistory = vm["history"].as<unsigned int>();
+    }
+
+    if (vm.count("spool-dir"))
+    {
+        config.strSpoolDir = vm["spool-dir"].as< std::string >();
+    }
+
+    if (vm.count("spool-size"))
+    {
+        config.uiSpoolSize = std::max(1U, vm["spool-size"].as<unsigned int>());
+    }
+
+    if (vm.count("spool-segment"))
+    {
+        config.uiSpoolSegment = std::max(4U, vm["spool-segment"].as<unsigned int>());
+    }
+
+    if (vm.count("spool-sync-ms"))
+    {
+        config.uiSpoolSync = vm["spool-sync-ms"].as<unsigned int>();
+    }
+
+    if (vm.count("capture"))
+    {
+        config.strCapture = vm["capture"].as< std::string >();
+    }
+
+    if (vm.count("reconnect-min"))
+    {
+        config.uiReconnectMin = std::max(1U, vm["reconnect-min"].as<unsigned int>());
+    }
+
+    if (vm.count("reconnect-max"))
+    {
+        config.uiReconnectMax = std::max(config.uiReconnectMin, vm["reconnect-max"].as<unsigned int>());
+    }
+
+    if (vm.count("serial-offline"))
+    {
+        config.offlinePolicy = parseOfflinePolicy(vm["serial-offline"].as< std::string >());
+    }
+
+    // webserver
+    if (vm.count("ip"))
+    {
+        config.strAddress = vm["ip"].as< std::string > ();
+    }
+
+    if (vm.count("port"))
+    {
+        config.port = vm["port"].as<uint16_t> ();
+    }
+
+    if (vm.count("ssl-cert"))
+    {
+        config.strSSLCert = vm["ssl-cert"].as< std::string >();
+    }
+
+    if (vm.count("ssl-key"))
+    {
+        config.strSSLKey = vm["ssl-key"].as< std::string >();
+    }
+
+    if (vm.count("udp"))
+    {
+        config.useUDP = true;
+    }
+
+    if (vm.count("udp-max-datagram"))
+    {
+        config.uiMaxDatagram = std::max(1U, std::min(65507U, vm["udp-max-datagram"].as<unsigned int>()));
+    }
+
+    if (vm.count("udp-coalesce-us"))
+    {
+        config.uiCoalesceMicros = vm["udp-coalesce-us"].as<unsigned int>();
+    }
+
+    if (vm.count("udp-peer-timeout"))
+    {
+        config.uiPeerTimeout = std::max(1U, vm["udp-peer-timeout"].as<unsigned int>());
+    }
+
+    if (vm.count("udp-reliable"))
+    {
+        config.useReliableUDP = true;
+    }
+
+    if (vm.count("udp-sim-loss"))
+    {
+        config.uiSimLoss = std::min(100U, vm["udp-sim-loss"].as<unsigned int>());
+    }
+
+    if (vm.count("udp-sim-reorder"))
+    {
+        config.uiSimReorder = std::min(100U, vm["udp-sim-reorder"].as<unsigned int>());
+    }
+
+    // queues
+    if (vm.count("tx-high-watermark"))
+    {
+        config.uiTxHighWatermark = std::max(1U, vm["tx-high-watermark"].as<unsigned int>());
+    }
+
+    if (vm.count("tx-low-watermark"))
+    {
+        config.uiTxLowWatermark = std::min(config.uiTxHighWatermark, vm["tx-low-watermark"].as<unsigned int>());
+    }
+
+    if (vm.count("io-backend"))
+    {
+        config.ioBackend = parseIoBackend(vm["io-backend"].as< std::string >());
+    }
+
+    if (vm.count("splice"))
+    {
+        config.useSplice = true;
+    }
+
+    if (vm.count("overflow-policy"))
+    {
+        config.overflowPolicy = parseOverflowPolicy(vm["overflow-policy"].as< std::string >());
+    }
+
+    if (vm.count("stats"))
+    {
+        config.uiStatsInterval = vm["stats"].as<unsigned int>();
+    }
+
+    // tcp socket options
+    if (vm.count("tcp-profile"))
+    {
+        config.socketOptions = NetworkServer::SocketOptions::forProfile(parseSocketProfile(vm["tcp-profile"].as< std::string >()));
+    }
+
+    // a preset is taken as a whole, mixing it with single options would leave its intent unclear
+    if (NetworkServer::eSocketProfile::Custom != config.socketOptions.profile)
+    {
+        for (const char* const option : { "tcp-nodelay", "tcp-quickack", "tcp-sndbuf", "tcp-rcvbuf", "tcp-keepalive",
+                                          "tcp-keepalive-interval", "tcp-keepalive-count", "tcp-user-timeout" })
         {
-            config.strDevice = vm["device"].as< std::string >();
+            if (vm.count(option))
+            {
+                throw std::invalid_argument(std::string("--") + option + " requires --tcp-profile custom");
+            }
         }
+    }
+
+    if (vm.count("tcp-nodelay"))
+    {
+        config.socketOptions.noDelay = vm["tcp-nodelay"].as<bool>();
+    }
+
+    if (vm.count("tcp-quickack"))
+    {
+        config.socketOptions.quickAck = vm["tcp-quickack"].as<bool>();
+    }
+
+    if (vm.count("tcp-sndbuf"))
+    {
+        config.socketOptions.sendBuffer = static_cast<int>(std::min(1U << 30, vm["tcp-sndbuf"].as<unsigned int>()));
+    }
+
+    if (vm.count("tcp-rcvbuf"))
+    {
+        config.socketOptions.receiveBuffer = static_cast<int>(std::min(1U << 30, vm["tcp-rcvbuf"].as<unsigned int>()));
+    }
+
+    if (vm.count("tcp-keepalive"))
+    {
+        config.socketOptions.keepAliveIdle = vm["tcp-keepalive"].as<unsigned int>();
+    }
+
+    if (vm.count("tcp-keepalive-interval"))
+    {
+        config.socketOptions.keepAliveInterval = vm["tcp-keepalive-interval"].as<unsigned int>();
+    }
 
-        // webserver
-        if (vm.count("ip"))
+    if (vm.count("tcp-keepalive-count"))
+    {
+        config.socketOptions.keepAliveCount = vm["tcp-keepalive-count"].as<unsigned int>();
+    }
+
+    if (vm.count("tcp-user-timeout"))
+    {
+        config.socketOptions.userTimeoutMillis = vm["tcp-user-timeout"].as<unsigned int>();
+    }
+}
+
+
+/** options of the process rather than of a bridge */
+static void addGenericOptions(options_description & options)
+{
+    options.add_options()
+            ("help,h", "this description")
+            ("config", "prints the current configuration")
+            ("version,v", "about this software")
+            ("bridges,c", value< std::string >(), "ini file with one [section] per bridge, serving many devices in one process (SIGHUP reloads it)")
+            ("threads", value< unsigned int >(), "event loop threads, each bridge stays serialized on its own strand (default: 1)")
+            ("cpu-affinity", value< std::string >(), "comma separated cpus the event loop threads are pinned to, e.g. 0,2,4")
+            ;
+}
+
+
+/** "0,2,4" -> { 0, 2, 4 } */
+static std::vector<unsigned> parseCpuList(const std::string & text)
+{
+    std::vector<unsigned> cpus;
+    std::stringstream stream(text);
+    std::string item;
+
+    while (std::getline(stream, item, ','))
+    {
+        if (item.empty() || item.find_first_not_of("0123456789") != std::string::npos)
         {
-            config.strAddress = vm["ip"].as< std::string > ();
+            throw "Invalid cpu affinity!";
         }
 
-        if (vm.count("port"))
+        cpus.push_back(static_cast<unsigned>(std::stoul(item)));
+    }
+
+    return cpus;
+}
+
+
+bool parseArguments(Arguments & config, int argc, char* argv[])
+{
+    options_description cmdlineOptions("Usage");
+    options_description generic("Generic");
+
+    addGenericOptions(generic);
+
+    cmdlineOptions.add(generic);
+    addBridgeOptions(cmdlineOptions);
+
+    try
+    {
+        variables_map vm;
+        store(parse_command_line(argc, argv, cmdlineOptions), vm);
+        notify(vm);
+
+        applyBridgeOptions(config, vm);
+
+        if (vm.count("bridges"))
         {
-            config.port = vm["port"].as<uint16_t> ();
+            config.strBridgesFile = vm["bridges"].as< std::string >();
         }
 
-        if (vm.count("ssl-cert"))
+        if (vm.count("threads"))
         {
-            config.strSSLCert = vm["ssl-cert"].as< std::string >();
+            config.uiThreads = std::max(1U, vm["threads"].as<unsigned int>());
         }
 
-        if (vm.count("udp"))
+        if (vm.count("cpu-affinity"))
         {
-            config.useUDP = true;
+            config.cpuAffinity = parseCpuList(vm["cpu-affinity"].as< std::string >());
         }
 
-
         // generic
         if (vm.count("help"))
         {
@@ -117,6 +717,12 @@ bool parseArguments(Arguments & config, int argc, char* argv[])
             return false;
         }
     }
+    catch (const std::exception & error)
+    {
+        std::cerr << ">>> " << error.what() << std::endl;
+        std::cout << cmdlineOptions << std::endl;
+        return false;
+    }
     catch(...)
     {
         std::cout << cmdlineOptions << std::endl;
@@ -125,3 +731,128 @@ bool parseArguments(Arguments & config, int argc, char* argv[])
 
     return true;
 }
+
+
+/** a boolean switch in the ini file enables a flag option like --udp */
+static bool isEnabled(const std::string & value)
+{
+    return value == "1" || value == "true" || value == "yes" || value == "on" || value.empty();
+}
+
+
+bool parseBridgeConfig(const std::string & file, int argc, char* argv[], std::vector<BridgeConfig> & bridges)
+{
+    options_description cmdlineOptions("Usage");
+    options_description generic("Generic");
+    options_description bridgeOptions("Bridge");
+
+    addGenericOptions(generic);
+    addBridgeOptions(bridgeOptions);
+    cmdlineOptions.add(generic).add(bridgeOptions);
+
+    boost::property_tree::ptree tree;
+
+    try
+    {
+        boost::property_tree::ini_parser::read_ini(file, tree);
+    }
+    catch (const boost::property_tree::ini_parser_error & error)
+    {
+        std::cerr << "Reading " << file << " failed: " << error.what() << std::endl;
+        return false;
+    }
+
+    // keys outside of any section apply to every bridge
+    std::vector<std::string> globals;
+    std::vector<BridgeConfig> result;
+
+    auto toArguments = [&bridgeOptions](const boost::property_tree::ptree & section, std::vector<std::string> & args)
+                       {
+                           for (const auto & entry : section)
+                           {
+                               const std::string value = entry.second.data();
+                               const option_description * option = bridgeOptions.find_nothrow(entry.first, false);
+
+                               if (nullptr != option && 0 == option->semantic()->max_tokens())
+                               {
+                                   if (isEnabled(value))
+                                   {
+                                       args.push_back("--" + entry.first);
+                                   }
+                               }
+                               else
+                               {
+                                   args.push_back("--" + entry.first + "=" + value);
+                               }
+                           }
+                       };
+
+    boost::property_tree::ptree defaults;
+
+    for (const auto & entry : tree)
+    {
+        if (entry.second.empty())
+        {
+            defaults.push_back(entry);
+        }
+    }
+
+    toArguments(defaults, globals);
+
+    for (const auto & entry : tree)
+    {
+        if (entry.second.empty())
+        {
+            continue;
+        }
+
+        BridgeConfig bridge;
+        bridge.name = entry.first;
+
+        std::vector<std::string> args;
+        toArguments(entry.second, args);
+
+        try
+        {
+            // the first stored value wins: section, then the global keys, then the command line
+            variables_map vm;
+            store(command_line_parser(args).options(bridgeOptions).run(), vm);
+            store(command_line_parser(globals).options(bridgeOptions).run(), vm);
+            store(parse_command_line(argc, argv, cmdlineOptions), vm);
+            notify(vm);
+
+            applyBridgeOptions(bridge.options, vm);
+        }
+        catch (const std::exception & error)
+        {
+            std::cerr << "Bridge [" << bridge.name << "]: " << error.what() << std::endl;
+            return false;
+        }
+
+        bridge.options.strName = bridge.name;
+
+        for (const std::string & arg : globals)
+        {
+            bridge.settings += arg + " ";
+        }
+
+        for (const std::string & arg : args)
+        {
+            bridge.settings += arg + " ";
+        }
+
+        for (const BridgeConfig & other : result)
+        {
+            if (other.options.port == bridge.options.port || other.options.strDevice == bridge.options.strDevice)
+            {
+                std::cerr << "Bridges [" << other.name << "] and [" << bridge.name << "] share a port or device" << std::endl;
+                return false;
+            }
+        }
+
+        result.push_back(std::move(bridge));
+    }
+
+    bridges = std::move(result);
+    return true;
+}
@@ -11,27 +11,108 @@
 #include <cstdint>
 #include <iostream>
 #include <string>
+#include <vector>
+
+#include "NetworkServer.h"
+#include "SerialPort.h"
+#include "System.h"
 
 
 /** command line arguments for this application */
 struct Arguments
 {
   Arguments()
-    : strAddress("127.0.0.1"),
+    : strName(""),
+      strBridgesFile(""),
+      strAddress("127.0.0.1"),
       port(23),
       strSSLCert(""),
+      strSSLKey(""),
       strDevice("/dev/ttyUSB0"),
       uiBaudrate(115200),
-      useUDP(false)
+      uiDataBits(8),
+      parity(SerialPort::eParity::None),
+      stopBits(SerialPort::eStopBits::One),
+      flowControl(SerialPort::eFlowControl::None),
+      useUDP(false),
+      uiRxBufferSize(512),
+      uiRxBufferCount(2),
+      latencyMode(SerialPort::eLatencyMode::System),
+      uiLatencyTimer(0),
+      uiReconnectMin(100),
+      uiReconnectMax(5000),
+      offlinePolicy(SerialPort::eOfflinePolicy::Pause),
+      uiSerialCoalesceMicros(0),
+      uiSerialCoalesceBytes(1448),
+      serialDelimiter(-1),
+      uiHistory(0),
+      strSpoolDir(""),
+      uiSpoolSize(64),
+      uiSpoolSegment(1024),
+      uiSpoolSync(1000),
+      strCapture(""),
+      uiTxHighWatermark(256),
+      uiTxLowWatermark(64),
+      overflowPolicy(NetworkServer::eOverflowPolicy::PauseSource),
+      uiStatsInterval(0),
+      uiMaxDatagram(1472),
+      uiCoalesceMicros(1000),
+      uiPeerTimeout(60),
+      useReliableUDP(false),
+      uiSimLoss(0),
+      uiSimReorder(0),
+      socketOptions(),
+      uiThreads(1),
+      cpuAffinity(),
+      ioBackend(System::eIoBackend::Asio),
+      useSplice(false)
   {
   }
 
+  std::string strName;         /**< section of the bridge in the config file, empty for a single bridge */
+  std::string strBridgesFile;  /**< config file with many bridges */
   std::string strAddress;
   uint16_t      port;
   std::string strSSLCert;
+  std::string strSSLKey;
   std::string strDevice;
   uint32_t uiBaudrate;
+  uint32_t uiDataBits;        /**< 5 to 8 */
+  SerialPort::eParity parity;
+  SerialPort::eStopBits stopBits;
+  SerialPort::eFlowControl flowControl;
   bool useUDP;
+  uint32_t uiRxBufferSize;  /**< bytes per receive buffer (serial and network) */
+  uint32_t uiRxBufferCount; /**< receive buffers cycled, so a read is pending while a chunk is processed */
+  SerialPort::eLatencyMode latencyMode;
+  uint32_t uiLatencyTimer;    /**< usb-serial latency timer in ms, 0 keeps the one of the latency mode */
+  uint32_t uiReconnectMin;    /**< ms before the first retry to open a missing or failed device, doubled per attempt */
+  uint32_t uiReconnectMax;    /**< ms the retry interval grows to */
+  SerialPort::eOfflinePolicy offlinePolicy;
+  uint32_t uiSerialCoalesceMicros;  /**< max delay serial data is held back to fill larger network writes, 0 = off */
+  uint32_t uiSerialCoalesceBytes;   /**< collected serial data is sent once it reaches this size */
+  int serialDelimiter;              /**< byte flushing the collected serial data (e.g. '\n'), -1 for none */
+  uint32_t uiHistory;               /**< KiB of recent serial output replayed to each new client, 0 = off */
+  std::string strSpoolDir;          /**< keeps serial data on disk while no client is connected, empty = off */
+  uint32_t uiSpoolSize;             /**< MiB the spool segments may take in total */
+  uint32_t uiSpoolSegment;          /**< KiB per segment file */
+  uint32_t uiSpoolSync;             /**< ms between syncs of the spooled data, 0 leaves writeback to the kernel */
+  std::string strCapture;           /**< file recording every chunk in either direction, empty = off */
+  uint32_t uiTxHighWatermark; /**< KiB queued per tx queue before the overflow policy applies */
+  uint32_t uiTxLowWatermark;  /**< KiB a congested tx queue has to drain to */
+  NetworkServer::eOverflowPolicy overflowPolicy;
+  uint32_t uiStatsInterval;   /**< seconds between statistics reports, 0 disables them */
+  uint32_t uiMaxDatagram;     /**< UDP payload bytes per datagram */
+  uint32_t uiCoalesceMicros;  /**< UDP coalescing window */
+  uint32_t uiPeerTimeout;     /**< seconds until a silent UDP peer is dropped */
+  bool useReliableUDP;        /**< ARQ framing on top of UDP */
+  uint32_t uiSimLoss;         /**< simulated loss in percent (testing) */
+  uint32_t uiSimReorder;      /**< simulated reordering in percent (testing) */
+  NetworkServer::SocketOptions socketOptions; /**< profile plus explicit overrides for accepted tcp connections */
+  uint32_t uiThreads;                 /**< threads running the event loop */
+  std::vector<unsigned> cpuAffinity;  /**< cpus the event loop threads are pinned to, round robin */
+  System::eIoBackend ioBackend;       /**< io_uring falls back to asio if the kernel lacks it */
+  bool useSplice;                     /**< kernel passthrough while a single plain tcp client is attached */
 };
 
 std::ostream &operator<<(std::ostream & oStream, const Arguments & conf);
@@ -39,4 +120,17 @@ std::ostream &operator<<(std::ostream & oStream, const Arguments & conf);
 
 bool parseArguments(Arguments & config, int argc, char* argv[]);
 
+
+/** one section of the bridges config file */
+struct BridgeConfig
+{
+  std::string name;
+  Arguments   options;
+  std::string settings;   /**< the options the bridge was configured with, changes restart it */
+};
+
+/** reads the bridges of an ini file, each section being a set of the long command line options;
+ *  keys outside of any section and then the command line provide the defaults */
+bool parseBridgeConfig(const std::string & file, int argc, char* argv[], std::vector<BridgeConfig> & bridges);
+
 #endif /* ARGUMENTS_H_D0B5E333_DDD7_4F7C_B571_EB8BF014FFB6 */
@@ -0,0 +1,1011 @@
+/**
+ * @file		Benchmark.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ *
+ * serialbridge_bench: runs bridges against pseudo-terminals and loopback TCP clients and
+ * measures them over a matrix of bridge counts, chunk sizes and client counts. Per cell fresh
+ * bridges measure
+ *
+ *   serial->net   throughput of the device data fanned out to all clients, checked byte by byte
+ *   net->serial   throughput of all clients writing to their devices at once
+ *   rtt           round trips of the first client of the first bridge through its device, echoed by the bench
+ *
+ * together with the CPU time and the read/write system calls of the bridges per MB entering
+ * them and their peak RSS. Several bridges run in one process (-c, the bridges file) or with
+ * --processes in one process each; --tls makes the clients talk TLS to the bridges. Arguments
+ * after -- are passed to each bridge process (e.g. --threads 4), so features are compared run
+ * by run.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#ifdef SERIALBRIDGE_WITH_TLS
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#else
+typedef struct ssl_st SSL;
+typedef struct ssl_ctx_st SSL_CTX;
+#endif
+
+#include "BridgeHarness.h"
+
+
+using namespace boost::program_options;
+using Clock = BridgeHarness::Clock;
+
+
+
+struct Settings
+{
+    std::string bridge;
+    std::vector<std::string> bridgeArguments;
+    double duration = 2.0;          /**< seconds each throughput direction is loaded */
+    unsigned samples = 2000;        /**< round trips per cell */
+    double rttDuration = 5.0;       /**< seconds the round trips may take per cell, slow cells get fewer samples */
+    bool processes = false;         /**< one process per bridge instead of one process serving all of them */
+    std::string certificate;        /**< PEM certificate and key the bridges serve TLS with, empty for plain TCP */
+    SSL_CTX* tls = nullptr;         /**< client context, set with the certificate */
+};
+
+struct Cell
+{
+    unsigned bridges = 1;
+    unsigned chunk = 0;
+    unsigned clients = 0;           /**< per bridge */
+};
+
+struct Result
+{
+    double   serialToNetwork = 0.0;       /**< MB/s of device data of all bridges, each client received all of its device's data */
+    double   networkToSerial = 0.0;       /**< MB/s of all clients together */
+    uint64_t corrupted = 0;               /**< bytes of device data not arriving as sent, summed over the clients */
+    uint64_t missing = 0;                 /**< bytes not arriving before the deadline, both directions */
+    double   cpuSerialToNetwork = 0.0;    /**< ms of bridge CPU time per MB of device data */
+    double   cpuNetworkToSerial = 0.0;    /**< ms of bridge CPU time per MB of client data */
+    double   syscallsSerialToNetwork = 0.0;  /**< read and write calls of the bridges per KB of device data */
+    double   syscallsNetworkToSerial = 0.0;  /**< read and write calls of the bridges per KB of client data */
+    std::vector<uint64_t> rtt;            /**< us, sorted */
+    uint64_t peakRss = 0;                 /**< KiB, summed over the bridge processes */
+    std::string session;                  /**< TLS session of the first client as logged by the bridge, e.g. kTLS state */
+    std::string error;
+};
+
+
+static double seconds(Clock::duration duration)
+{
+    return std::chrono::duration<double>(duration).count();
+}
+
+static uint64_t percentile(const std::vector<uint64_t> & sorted, double fraction)
+{
+    return sorted.empty() ? 0 : sorted[std::min(sorted.size() - 1, static_cast<size_t>(fraction * static_cast<double>(sorted.size())))];
+}
+
+
+/** a loopback client of a bridge, plain or TLS on a non-blocking socket */
+class Client
+{
+public:
+    /** takes the connected socket, a TLS client completes its handshake before the deadline */
+    Client(int fd, SSL_CTX* tls, Clock::time_point deadline)
+        : m_fd(fd)
+    {
+#ifdef SERIALBRIDGE_WITH_TLS
+        if (nullptr != tls)
+        {
+            m_ssl = SSL_new(tls);
+
+            if (nullptr == m_ssl || 1 != SSL_set_fd(m_ssl, m_fd))
+            {
+                close();
+                throw "Failed to create a TLS client!";
+            }
+
+            SSL_set_mode(m_ssl, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+            for (int result = SSL_connect(m_ssl); 1 != result; result = SSL_connect(m_ssl))
+            {
+                if (!waitFor(result, deadline))
+                {
+                    close();
+                    throw "The TLS handshake failed!";
+                }
+            }
+        }
+#else
+        (void) tls;
+        (void) deadline;
+#endif
+    }
+
+    ~Client()
+    {
+        close();
+    }
+
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    /** bytes read into the buffer, 0 on timeout, -1 on failure or end of stream */
+    ssize_t readSome(char* buffer, size_t length, Clock::time_point deadline)
+    {
+#ifdef SERIALBRIDGE_WITH_TLS
+        if (nullptr != m_ssl)
+        {
+            for (;;)
+            {
+                const int result = SSL_read(m_ssl, buffer, static_cast<int>(std::min<size_t>(length, INT32_MAX)));
+
+                if (result > 0)
+                {
+                    return result;
+                }
+
+                if (!waitFor(result, deadline))
+                {
+                    return Clock::now() >= deadline ? 0 : -1;
+                }
+            }
+        }
+#endif
+        return BridgeHarness::readSome(m_fd, buffer, length, deadline);
+    }
+
+    bool writeAll(const char* data, size_t length, Clock::time_point deadline)
+    {
+#ifdef SERIALBRIDGE_WITH_TLS
+        if (nullptr != m_ssl)
+        {
+            while (length > 0)
+            {
+                const int result = SSL_write(m_ssl, data, static_cast<int>(std::min<size_t>(length, INT32_MAX)));
+
+                if (result > 0)
+                {
+                    data += result;
+                    length -= static_cast<size_t>(result);
+                }
+                else if (!waitFor(result, deadline))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+#endif
+        return BridgeHarness::writeAll(m_fd, data, length, deadline);
+    }
+
+    /** reads until the buffer is full, false on timeout or end of stream */
+    bool readExactly(char* buffer, size_t length, Clock::time_point deadline)
+    {
+        while (length > 0)
+        {
+            const ssize_t result = readSome(buffer, length, deadline);
+
+            if (result < 0 || (0 == result && Clock::now() >= deadline))
+            {
+                return false;
+            }
+
+            buffer += result;
+            length -= static_cast<size_t>(result);
+        }
+
+        return true;
+    }
+
+private:
+#ifdef SERIALBRIDGE_WITH_TLS
+    /** waits for what the failed TLS call needs from the socket, false if it failed for good */
+    bool waitFor(int result, Clock::time_point deadline)
+    {
+        switch (SSL_get_error(m_ssl, result))
+        {
+        case SSL_ERROR_WANT_READ:
+            return BridgeHarness::waitFor(m_fd, POLLIN, deadline);
+
+        case SSL_ERROR_WANT_WRITE:
+            return BridgeHarness::waitFor(m_fd, POLLOUT, deadline);
+
+        default:
+            ERR_clear_error();
+            return false;
+        }
+    }
+#endif
+
+    void close()
+    {
+#ifdef SERIALBRIDGE_WITH_TLS
+        if (nullptr != m_ssl)
+        {
+            SSL_free(m_ssl);
+            m_ssl = nullptr;
+        }
+#endif
+        if (m_fd >= 0)
+        {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    int  m_fd = -1;
+    SSL* m_ssl = nullptr;
+};
+
+using Clients = std::vector<std::unique_ptr<Client>>;
+
+
+/** the bridges of a cell: a pseudo-terminal, a port and clients per bridge, served by one process or one process each */
+class Rig
+{
+public:
+    Rig(const Settings & settings, const Cell & cell)
+    {
+        for (unsigned i = 0; i < cell.bridges; ++i)
+        {
+            m_terminals.emplace_back(new Terminal());
+            m_ports.push_back(BridgeHarness::freePort());
+        }
+
+        std::vector<std::string> common;
+
+        if (!settings.certificate.empty())
+        {
+            common = { "--ssl-cert", settings.certificate };
+        }
+
+        common.insert(common.end(), settings.bridgeArguments.begin(), settings.bridgeArguments.end());
+
+        if (1 == cell.bridges || settings.processes)
+        {
+            for (unsigned i = 0; i < cell.bridges; ++i)
+            {
+                std::vector<std::string> arguments = { "-d", m_terminals[i]->slaveName(), "-p", std::to_string(m_ports[i]), "-i", "127.0.0.1" };
+
+                arguments.insert(arguments.end(), common.begin(), common.end());
+                m_processes.emplace_back(new BridgeProcess(settings.bridge, arguments, m_directory / ("bridge" + std::to_string(i) + ".log")));
+            }
+        }
+        else
+        {
+            const std::string file = m_directory / "bridges.ini";
+            std::ofstream ini(file);
+
+            ini << "ip = 127.0.0.1\n";
+
+            for (unsigned i = 0; i < cell.bridges; ++i)
+            {
+                ini << "[bridge" << i << "]\ndevice = " << m_terminals[i]->slaveName() << "\nport = " << m_ports[i] << "\n";
+            }
+
+            ini.close();
+
+            std::vector<std::string> arguments = { "-c", file };
+
+            arguments.insert(arguments.end(), common.begin(), common.end());
+            m_processes.emplace_back(new BridgeProcess(settings.bridge, arguments, m_directory / "bridge0.log"));
+        }
+
+        for (unsigned i = 0; i < cell.bridges; ++i)
+        {
+            m_clients.push_back(connectClients(*m_processes[settings.processes ? i : 0], m_ports[i], cell.clients, settings.tls));
+        }
+    }
+
+    Rig(const Rig&) = delete;
+    Rig& operator=(const Rig&) = delete;
+
+    size_t bridges() const { return m_terminals.size(); }
+
+    /** the device side of a bridge */
+    int master(size_t bridge) const { return m_terminals[bridge]->master(); }
+
+    Clients & clients(size_t bridge) { return m_clients[bridge]; }
+
+    bool alive() const
+    {
+        return std::all_of(m_processes.begin(), m_processes.end(), [](const std::unique_ptr<BridgeProcess> & process) { return process->alive(); });
+    }
+
+    double cpuSeconds() const
+    {
+        double total = 0.0;
+
+        for (const auto & process : m_processes)
+        {
+            total += process->cpuSeconds();
+        }
+
+        return total;
+    }
+
+    uint64_t syscalls() const
+    {
+        uint64_t total = 0;
+
+        for (const auto & process : m_processes)
+        {
+            total += process->syscalls();
+        }
+
+        return total;
+    }
+
+    uint64_t peakRss() const
+    {
+        uint64_t total = 0;
+
+        for (const auto & process : m_processes)
+        {
+            total += process->peakRss();
+        }
+
+        return total;
+    }
+
+    /** "TLSv1.3, kTLS tx on, rx on", as the bridge logs its first client; empty for plain TCP */
+    std::string session() const
+    {
+        std::ifstream log(m_directory / "bridge0.log");
+
+        for (std::string line; std::getline(log, line); )
+        {
+            const size_t begin = line.find(": TLS");
+
+            if (0 == line.compare(0, 7, "Client ") && std::string::npos != begin)
+            {
+                return line.substr(begin + 2);
+            }
+        }
+
+        return std::string();
+    }
+
+private:
+    /** connects the clients, retrying until the bridge listens, and waits for each hello */
+    static Clients connectClients(const BridgeProcess & process, uint16_t port, unsigned count, SSL_CTX* tls)
+    {
+        Clients clients;
+        const Clock::time_point deadline = Clock::now() + std::chrono::seconds(5);
+
+        while (clients.size() < count)
+        {
+            const int fd = process.alive() ? BridgeHarness::connect(port, std::min(deadline, Clock::now() + std::chrono::milliseconds(200))) : -1;
+
+            if (fd >= 0)
+            {
+                clients.emplace_back(new Client(fd, tls, deadline));
+            }
+            else if (Clock::now() > deadline || !process.alive())
+            {
+                throw "The bridge does not accept clients!";
+            }
+        }
+
+        for (const auto & client : clients)
+        {
+            char hello[BridgeHarness::HELLO_LENGTH];
+
+            if (!client->readExactly(hello, sizeof(hello), deadline))
+            {
+                throw "The bridge did not open the device!";
+            }
+        }
+
+        return clients;
+    }
+
+    ScratchDirectory                            m_directory{ "serialbridge-bench" };
+    std::vector<std::unique_ptr<Terminal>>      m_terminals;
+    std::vector<uint16_t>                       m_ports;
+    std::vector<std::unique_ptr<BridgeProcess>> m_processes;
+    std::vector<Clients>                        m_clients;
+};
+
+
+/** every device writes the pattern for the duration, every client has to receive all of its device's data */
+static void measureSerialToNetwork(const Settings & settings, const Cell & cell, Rig & rig, Result & result)
+{
+    const std::string pattern = BridgeHarness::pattern(BridgeHarness::PATTERN_PERIOD + cell.chunk);
+
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(settings.duration));
+    const Clock::time_point deadline = end + std::chrono::seconds(10);
+    const double cpu = rig.cpuSeconds();
+    const uint64_t syscalls = rig.syscalls();
+
+    std::vector<std::atomic<uint64_t>> targets(rig.bridges());
+    std::vector<uint64_t> sent(rig.bridges(), 0);
+    std::vector<std::vector<uint64_t>> received(rig.bridges(), std::vector<uint64_t>(cell.clients, 0));
+    std::vector<std::vector<uint64_t>> corrupted(rig.bridges(), std::vector<uint64_t>(cell.clients, 0));
+    std::vector<std::vector<Clock::time_point>> finished(rig.bridges(), std::vector<Clock::time_point>(cell.clients, start));
+    std::vector<std::thread> threads;
+
+    for (size_t b = 0; b < rig.bridges(); ++b)
+    {
+        targets[b] = UINT64_MAX;
+
+        for (size_t i = 0; i < cell.clients; ++i)
+        {
+            threads.emplace_back([&, b, i]()
+            {
+                std::vector<char> buffer(64 * 1024);
+
+                while (received[b][i] < targets[b].load() && Clock::now() < deadline)
+                {
+                    const ssize_t length = rig.clients(b)[i]->readSome(buffer.data(), buffer.size(), deadline);
+
+                    if (length < 0)
+                    {
+                        break;
+                    }
+
+                    for (ssize_t k = 0; k < length; ++k)
+                    {
+                        corrupted[b][i] += (static_cast<char>((received[b][i] + k) % BridgeHarness::PATTERN_PERIOD) != buffer[k]) ? 1 : 0;
+                    }
+
+                    received[b][i] += static_cast<uint64_t>(length);
+                    finished[b][i] = Clock::now();
+                }
+            });
+        }
+
+        threads.emplace_back([&, b]()
+        {
+            while (Clock::now() < end)
+            {
+                if (!BridgeHarness::writeAll(rig.master(b), pattern.data() + sent[b] % BridgeHarness::PATTERN_PERIOD, cell.chunk, deadline))
+                {
+                    break;
+                }
+
+                sent[b] += cell.chunk;
+            }
+
+            targets[b] = sent[b];
+        });
+    }
+
+    for (auto & thread : threads)
+    {
+        thread.join();
+    }
+
+    Clock::time_point last = start;
+    uint64_t total = 0;
+
+    for (size_t b = 0; b < rig.bridges(); ++b)
+    {
+        total += sent[b];
+
+        for (size_t i = 0; i < cell.clients; ++i)
+        {
+            last = std::max(last, finished[b][i]);
+            result.corrupted += corrupted[b][i];
+            result.missing += sent[b] - std::min(sent[b], received[b][i]);
+        }
+    }
+
+    const double megabytes = static_cast<double>(total) / 1e6;
+
+    result.serialToNetwork = megabytes / std::max(1e-9, seconds(last - start));
+    result.cpuSerialToNetwork = megabytes > 0.0 ? (rig.cpuSeconds() - cpu) * 1e3 / megabytes : 0.0;
+    result.syscallsSerialToNetwork = total > 0 ? static_cast<double>(rig.syscalls() - syscalls) * 1e3 / static_cast<double>(total) : 0.0;
+}
+
+
+/** all clients write for the duration, every device has to receive the sum of its clients */
+static void measureNetworkToSerial(const Settings & settings, const Cell & cell, Rig & rig, Result & result)
+{
+    const std::vector<char> chunk(cell.chunk, 'n');
+
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(settings.duration));
+    const Clock::time_point deadline = end + std::chrono::seconds(10);
+    const double cpu = rig.cpuSeconds();
+    const uint64_t syscalls = rig.syscalls();
+
+    std::vector<std::atomic<uint64_t>> targets(rig.bridges());
+    std::vector<std::vector<uint64_t>> sent(rig.bridges(), std::vector<uint64_t>(cell.clients, 0));
+    std::vector<uint64_t> received(rig.bridges(), 0);
+    std::vector<Clock::time_point> finished(rig.bridges(), start);
+    std::vector<std::thread> devices;
+    std::vector<std::thread> writers;
+
+    for (size_t b = 0; b < rig.bridges(); ++b)
+    {
+        targets[b] = UINT64_MAX;
+
+        devices.emplace_back([&, b]()
+        {
+            std::vector<char> buffer(64 * 1024);
+
+            while (received[b] < targets[b].load() && Clock::now() < deadline)
+            {
+                const ssize_t length = BridgeHarness::readSome(rig.master(b), buffer.data(), buffer.size(), deadline);
+
+                if (length < 0)
+                {
+                    break;
+                }
+
+                received[b] += static_cast<uint64_t>(length);
+                finished[b] = Clock::now();
+            }
+        });
+
+        for (size_t i = 0; i < cell.clients; ++i)
+        {
+            writers.emplace_back([&, b, i]()
+            {
+                while (Clock::now() < end && rig.clients(b)[i]->writeAll(chunk.data(), chunk.size(), deadline))
+                {
+                    sent[b][i] += chunk.size();
+                }
+            });
+        }
+    }
+
+    for (auto & writer : writers)
+    {
+        writer.join();
+    }
+
+    uint64_t total = 0;
+
+    for (size_t b = 0; b < rig.bridges(); ++b)
+    {
+        uint64_t bridgeTotal = 0;
+
+        for (const uint64_t bytes : sent[b])
+        {
+            bridgeTotal += bytes;
+        }
+
+        targets[b] = bridgeTotal;
+        total += bridgeTotal;
+    }
+
+    for (auto & device : devices)
+    {
+        device.join();
+    }
+
+    for (size_t b = 0; b < rig.bridges(); ++b)
+    {
+        result.missing += static_cast<uint64_t>(targets[b]) - std::min<uint64_t>(targets[b], received[b]);
+    }
+
+    const double megabytes = static_cast<double>(total) / 1e6;
+
+    result.networkToSerial = megabytes / std::max(1e-9, seconds(*std::max_element(finished.begin(), finished.end()) - start));
+    result.cpuNetworkToSerial = megabytes > 0.0 ? (rig.cpuSeconds() - cpu) * 1e3 / megabytes : 0.0;
+    result.syscallsNetworkToSerial = total > 0 ? static_cast<double>(rig.syscalls() - syscalls) * 1e3 / static_cast<double>(total) : 0.0;
+}
+
+
+/** the first client sends a chunk, the device echoes it and the bridge fans it out to all clients; the other bridges idle */
+static void measureRoundTrips(const Settings & settings, const Cell & cell, Rig & rig, Result & result)
+{
+    const std::vector<char> message(cell.chunk, 'r');
+    const int master = rig.master(0);
+    Clients & clients = rig.clients(0);
+    std::atomic<bool> stop{ false };
+
+    std::thread device([&]()
+    {
+        std::vector<char> buffer(64 * 1024);
+
+        while (!stop)
+        {
+            const ssize_t length = BridgeHarness::readSome(master, buffer.data(), buffer.size(), Clock::now() + std::chrono::milliseconds(100));
+
+            if (length < 0 || (length > 0 && !BridgeHarness::writeAll(master, buffer.data(), static_cast<size_t>(length), Clock::now() + std::chrono::seconds(5))))
+            {
+                break;
+            }
+        }
+    });
+
+    std::vector<std::thread> drains;
+
+    for (size_t i = 1; i < clients.size(); ++i)
+    {
+        drains.emplace_back([&, i]()
+        {
+            std::vector<char> buffer(64 * 1024);
+
+            while (!stop && clients[i]->readSome(buffer.data(), buffer.size(), Clock::now() + std::chrono::milliseconds(100)) >= 0)
+            {
+            }
+        });
+    }
+
+    std::vector<char> buffer(message.size());
+    const Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(settings.rttDuration));
+
+    for (unsigned sample = 0; sample < settings.samples && Clock::now() < end; ++sample)
+    {
+        const Clock::time_point sent = Clock::now();
+        const Clock::time_point deadline = sent + std::chrono::seconds(5);
+
+        if (!clients[0]->writeAll(message.data(), message.size(), deadline))
+        {
+            break;
+        }
+
+        if (!clients[0]->readExactly(buffer.data(), buffer.size(), deadline))
+        {
+            result.error = "round trip timed out";
+            break;
+        }
+
+        result.rtt.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - sent).count()));
+    }
+
+    stop = true;
+    device.join();
+
+    for (auto & drain : drains)
+    {
+        drain.join();
+    }
+
+    std::sort(result.rtt.begin(), result.rtt.end());
+}
+
+
+static Result measure(const Settings & settings, const Cell & cell)
+{
+    Result result;
+
+    try
+    {
+        Rig rig(settings, cell);
+
+        measureSerialToNetwork(settings, cell, rig, result);
+        measureNetworkToSerial(settings, cell, rig, result);
+        measureRoundTrips(settings, cell, rig, result);
+
+        result.peakRss = rig.peakRss();
+        result.session = rig.session();
+
+        if (result.error.empty() && !rig.alive())
+        {
+            result.error = "bridge exited";
+        }
+    }
+    catch (const char* const text)
+    {
+        result.error = text;
+    }
+
+    return result;
+}
+
+
+#ifdef SERIALBRIDGE_WITH_TLS
+/** a throwaway self-signed P-256 certificate with its key in one PEM file, and the client context trusting anything */
+static SSL_CTX* createTls(const std::string & file)
+{
+    EVP_PKEY* key = nullptr;
+    EVP_PKEY_CTX* generator = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+    X509* certificate = X509_new();
+    bool written = false;
+
+    if (nullptr != generator && nullptr != certificate &&
+        1 == EVP_PKEY_keygen_init(generator) &&
+        1 == EVP_PKEY_CTX_set_ec_paramgen_curve_nid(generator, NID_X9_62_prime256v1) &&
+        1 == EVP_PKEY_keygen(generator, &key))
+    {
+        X509_NAME* name = X509_get_subject_name(certificate);
+
+        X509_set_version(certificate, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+        X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+        X509_gmtime_adj(X509_getm_notAfter(certificate), 24 * 3600);
+        X509_set_pubkey(certificate, key);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+        X509_set_issuer_name(certificate, name);
+
+        FILE* pem = std::fopen(file.c_str(), "w");
+
+        written = nullptr != pem && 0 != X509_sign(certificate, key, EVP_sha256()) &&
+                  1 == PEM_write_X509(pem, certificate) && 1 == PEM_write_PrivateKey(pem, key, nullptr, nullptr, 0, nullptr, nullptr);
+
+        if (nullptr != pem)
+        {
+            std::fclose(pem);
+        }
+    }
+
+    X509_free(certificate);
+    EVP_PKEY_free(key);
+    EVP_PKEY_CTX_free(generator);
+
+    SSL_CTX* context = written ? SSL_CTX_new(TLS_client_method()) : nullptr;
+
+    if (nullptr == context)
+    {
+        throw "Failed to create the TLS certificate!";
+    }
+
+    SSL_CTX_set_verify(context, SSL_VERIFY_NONE, nullptr);
+    return context;
+}
+#endif
+
+
+/** "64,512,4096" */
+static std::vector<unsigned> parseList(const std::string & text)
+{
+    std::vector<unsigned> values;
+    std::istringstream stream(text);
+
+    for (std::string value; std::getline(stream, value, ','); )
+    {
+        const unsigned long number = std::stoul(value);
+
+        if (0 == number)
+        {
+            throw std::invalid_argument("list entries have to be positive: " + text);
+        }
+
+        values.push_back(static_cast<unsigned>(number));
+    }
+
+    return values;
+}
+
+/** the bridge next to this executable */
+static std::string defaultBridge()
+{
+    char path[4096];
+    const ssize_t length = ::readlink("/proc/self/exe", path, sizeof(path) - 1);
+
+    if (length <= 0)
+    {
+        return "SerialBridge";
+    }
+
+    const std::string self(path, static_cast<size_t>(length));
+    return self.substr(0, self.rfind('/') + 1) + "SerialBridge";
+}
+
+
+static std::string escapeJson(const std::string & text)
+{
+    std::string escaped;
+
+    for (const char c : text)
+    {
+        if ('"' == c || '\\' == c)
+        {
+            escaped += '\\';
+        }
+
+        escaped += c;
+    }
+
+    return escaped;
+}
+
+static void print(FILE* output, const std::string & format, const std::string & arguments, const Cell & cell, const Result & result)
+{
+    const unsigned long long p50 = percentile(result.rtt, 0.5);
+    const unsigned long long p99 = percentile(result.rtt, 0.99);
+    const unsigned long long p999 = percentile(result.rtt, 0.999);
+    const unsigned long long max = result.rtt.empty() ? 0 : result.rtt.back();
+
+    if ("json" == format)
+    {
+        std::fprintf(output, "{\"bridges\":%u,\"chunk\":%u,\"clients\":%u,\"serial_to_net_mb_s\":%.3f,\"net_to_serial_mb_s\":%.3f,"
+                             "\"rtt_p50_us\":%llu,\"rtt_p99_us\":%llu,\"rtt_p999_us\":%llu,\"rtt_max_us\":%llu,\"rtt_samples\":%zu,"
+                             "\"cpu_ms_per_mb_serial_to_net\":%.3f,\"cpu_ms_per_mb_net_to_serial\":%.3f,"
+                             "\"syscalls_per_kb_serial_to_net\":%.3f,\"syscalls_per_kb_net_to_serial\":%.3f,\"peak_rss_kib\":%llu,"
+                             "\"corrupted_bytes\":%llu,\"missing_bytes\":%llu,\"tls\":\"%s\",\"bridge_args\":\"%s\",\"error\":\"%s\"}\n",
+                     cell.bridges, cell.chunk, cell.clients, result.serialToNetwork, result.networkToSerial, p50, p99, p999, max, result.rtt.size(),
+                     result.cpuSerialToNetwork, result.cpuNetworkToSerial, result.syscallsSerialToNetwork, result.syscallsNetworkToSerial,
+                     static_cast<unsigned long long>(result.peakRss),
+                     static_cast<unsigned long long>(result.corrupted), static_cast<unsigned long long>(result.missing),
+                     escapeJson(result.session).c_str(), escapeJson(arguments).c_str(), escapeJson(result.error).c_str());
+    }
+    else if ("csv" == format)
+    {
+        std::fprintf(output, "%u,%u,%u,%.3f,%.3f,%llu,%llu,%llu,%llu,%zu,%.3f,%.3f,%.3f,%.3f,%llu,%llu,%llu,\"%s\",\"%s\",\"%s\"\n",
+                     cell.bridges, cell.chunk, cell.clients, result.serialToNetwork, result.networkToSerial, p50, p99, p999, max, result.rtt.size(),
+                     result.cpuSerialToNetwork, result.cpuNetworkToSerial, result.syscallsSerialToNetwork, result.syscallsNetworkToSerial,
+                     static_cast<unsigned long long>(result.peakRss),
+                     static_cast<unsigned long long>(result.corrupted), static_cast<unsigned long long>(result.missing),
+                     result.session.c_str(), arguments.c_str(), result.error.c_str());
+    }
+    else
+    {
+        std::fprintf(output, "%7u %7u %7u %10.2f %10.2f %8llu %8llu %8llu %8llu %9.1f %9.1f %8.2f %8.2f %9llu  %s\n",
+                     cell.bridges, cell.chunk, cell.clients, result.serialToNetwork, result.networkToSerial, p50, p99, p999, max,
+                     result.cpuSerialToNetwork, result.cpuNetworkToSerial, result.syscallsSerialToNetwork, result.syscallsNetworkToSerial,
+                     static_cast<unsigned long long>(result.peakRss),
+                     !result.error.empty() ? result.error.c_str() : ((result.corrupted + result.missing) > 0 ? "DATA LOST" : result.session.c_str()));
+    }
+
+    std::fflush(output);
+}
+
+static void printHeader(FILE* output, const std::string & format, const std::string & arguments)
+{
+    if ("csv" == format)
+    {
+        std::fprintf(output, "bridges,chunk,clients,serial_to_net_mb_s,net_to_serial_mb_s,rtt_p50_us,rtt_p99_us,rtt_p999_us,rtt_max_us,rtt_samples,"
+                             "cpu_ms_per_mb_serial_to_net,cpu_ms_per_mb_net_to_serial,syscalls_per_kb_serial_to_net,syscalls_per_kb_net_to_serial,"
+                             "peak_rss_kib,corrupted_bytes,missing_bytes,tls,bridge_args,error\n");
+    }
+    else if ("json" != format)
+    {
+        std::fprintf(output, "bridge arguments: %s\n", arguments.empty() ? "(none)" : arguments.c_str());
+        std::fprintf(output, "                          ser->net   net->ser      rtt us (p50/p99/p999/max)    cpu ms/MB         syscalls/KB      peak\n");
+        std::fprintf(output, "bridges   chunk clients       MB/s       MB/s      p50      p99     p999      max   ser->net  net->ser ser->net net->ser  rss KiB\n");
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    // everything after -- goes to the bridges
+    int ownArguments = argc;
+    Settings settings;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (0 == std::strcmp(argv[i], "--"))
+        {
+            ownArguments = i;
+            settings.bridgeArguments.assign(argv + i + 1, argv + argc);
+            break;
+        }
+    }
+
+    options_description options("serialbridge_bench [options] [-- bridge arguments]");
+    options.add_options()
+            ("help,h", "this description")
+            ("bridge", value< std::string >()->default_value( defaultBridge() ), "the SerialBridge executable under test")
+            ("bridges", value< std::string >()->default_value( "1" ), "bridges loaded at once, comma separated; several share one process (-c)")
+            ("processes", "runs each bridge of a cell in its own process instead of one process for all")
+            ("chunks", value< std::string >()->default_value( "64,512,4096" ), "bytes per write of the device and the clients, comma separated")
+            ("clients", value< std::string >()->default_value( "1,4,16" ), "TCP clients per bridge, comma separated")
+#ifdef SERIALBRIDGE_WITH_TLS
+            ("tls", "the clients talk TLS, the bridges get a throwaway self-signed certificate")
+#endif
+            ("duration", value<double>()->default_value( 2.0 ), "seconds each direction is loaded per cell")
+            ("samples", value<unsigned int>()->default_value( 2000U ), "round trips per cell")
+            ("rtt-duration", value<double>()->default_value( 5.0 ), "seconds the round trips may take per cell")
+            ("format,f", value< std::string >()->default_value( "text" ), "text (table), csv or json (one object per line)")
+            ("output,o", value< std::string >(), "writes the results to this file instead of stdout")
+            ;
+
+    variables_map vm;
+    std::vector<Cell> cells;
+
+    try
+    {
+        store(parse_command_line(ownArguments, argv, options), vm);
+        notify(vm);
+
+        for (const unsigned bridges : parseList(vm["bridges"].as< std::string >()))
+        {
+            for (const unsigned clients : parseList(vm["clients"].as< std::string >()))
+            {
+                for (const unsigned chunk : parseList(vm["chunks"].as< std::string >()))
+                {
+                    cells.push_back(Cell{ bridges, chunk, clients });
+                }
+            }
+        }
+    }
+    catch (const std::exception & e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (vm.count("help"))
+    {
+        std::cout << options << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    settings.bridge = vm["bridge"].as< std::string >();
+    settings.duration = std::max(0.1, vm["duration"].as<double>());
+    settings.samples = vm["samples"].as<unsigned int>();
+    settings.rttDuration = std::max(0.1, vm["rtt-duration"].as<double>());
+    settings.processes = vm.count("processes") > 0;
+
+    const std::string format = vm["format"].as< std::string >();
+    FILE* output = vm.count("output") ? std::fopen(vm["output"].as< std::string >().c_str(), "w") : stdout;
+
+    if (nullptr == output || 0 != ::access(settings.bridge.c_str(), X_OK))
+    {
+        std::cerr << ">>> " << (nullptr == output ? "Failed to open the output file" : "Bridge not executable: " + settings.bridge) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::unique_ptr<ScratchDirectory> certificates;
+
+#ifdef SERIALBRIDGE_WITH_TLS
+    if (vm.count("tls"))
+    {
+        try
+        {
+            certificates.reset(new ScratchDirectory("serialbridge-bench-tls"));
+            settings.certificate = *certificates / "bridge.pem";
+            settings.tls = createTls(settings.certificate);
+        }
+        catch (const char* const text)
+        {
+            std::cerr << ">>> " << text << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+#endif
+
+    std::string arguments = settings.processes ? "(separate processes)" : "";
+
+    for (const auto & argument : settings.bridgeArguments)
+    {
+        arguments += (arguments.empty() ? "" : " ") + argument;
+    }
+
+    if (nullptr != settings.tls)
+    {
+        arguments += arguments.empty() ? "(tls)" : " (tls)";
+    }
+
+    printHeader(output, format, arguments);
+
+    bool failed = false;
+
+    for (const Cell & cell : cells)
+    {
+        const Result result = measure(settings, cell);
+
+        print(output, format, arguments, cell, result);
+        failed = failed || !result.error.empty() || result.corrupted > 0 || result.missing > 0;
+    }
+
+#ifdef SERIALBRIDGE_WITH_TLS
+    SSL_CTX_free(settings.tls);
+#endif
+
+    if (stdout != output)
+    {
+        std::fclose(output);
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
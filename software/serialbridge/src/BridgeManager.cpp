@@ -0,0 +1,184 @@
+/**
+ * @file		BridgeManager.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include "BridgeManager.h"
+#include "SerialBridge.h"
+#include "System.h"
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <iostream>
+
+
+BridgeManager::BridgeManager(const std::string & configFile, int argc, char* argv[])
+    : m_configFile(configFile),
+      m_argc(argc),
+      m_argv(argv),
+      m_strand(System::makeStrand()),
+      m_signals(m_strand, SIGHUP)
+{
+}
+
+
+BridgeManager::~BridgeManager()
+{
+    boost::system::error_code ignored;
+    m_signals.cancel(ignored);
+}
+
+
+bool BridgeManager::start()
+{
+    if (!reload())
+    {
+        return false;
+    }
+
+    awaitReload();
+    return true;
+}
+
+
+void BridgeManager::awaitReload()
+{
+    m_signals.async_wait([this](const boost::system::error_code& error, int)
+                         {
+                             if (!error)
+                             {
+                                 std::cout << "Reloading " << m_configFile << std::endl;
+                                 reload();
+                                 awaitReload();
+                             }
+                         });
+}
+
+
+bool BridgeManager::reload()
+{
+    std::vector<BridgeConfig> configs;
+
+    if (!parseBridgeConfig(m_configFile, m_argc, m_argv, configs))
+    {
+        return false;
+    }
+
+    // stop removed or changed bridges first, so their ports and devices are free again
+    std::vector<std::shared_ptr<SerialBridge>> stopped;
+
+    for (auto running = m_bridges.begin(); running != m_bridges.end(); )
+    {
+        auto config = std::find_if(configs.begin(), configs.end(),
+                                   [&running](const BridgeConfig & candidate) { return candidate.name == running->first; });
+
+        if (config == configs.end() || config->settings != running->second.settings)
+        {
+            std::cout << "Bridge [" << running->first << "] stopped" << std::endl;
+
+            // one still being created is released by started() once it finds its entry gone
+            if (running->second.bridge)
+            {
+                stopped.push_back(std::move(running->second.bridge));
+            }
+
+            running = m_bridges.erase(running);
+        }
+        else
+        {
+            ++running;
+        }
+    }
+
+    if (stopped.empty())
+    {
+        boost::asio::post(m_strand, [this, configs]() { startBridges(configs); });
+        return true;
+    }
+
+    // each bridge is released on its own strand, where it closes its device and sockets at once;
+    // the last one to go starts the new bridges
+    auto remaining = std::make_shared<std::atomic<size_t>>(stopped.size());
+
+    for (std::shared_ptr<SerialBridge> & bridge : stopped)
+    {
+        const boost::asio::any_io_executor executor = bridge->executor();
+
+        boost::asio::post(executor, [this, configs, remaining, bridge = std::move(bridge)]() mutable
+                          {
+                              bridge.reset();
+
+                              if (0 == --*remaining)
+                              {
+                                  boost::asio::post(m_strand, [this, configs]() { startBridges(configs); });
+                              }
+                          });
+    }
+
+    return true;
+}
+
+
+void BridgeManager::startBridges(const std::vector<BridgeConfig> & configs)
+{
+    for (const BridgeConfig & config : configs)
+    {
+        if (m_bridges.count(config.name) > 0)
+        {
+            continue;
+        }
+
+        // reserved now, so a reload meanwhile neither starts it twice nor misses stopping it
+        m_bridges.emplace(config.name, Bridge{ config.settings, nullptr });
+
+        // the bridge is created and started on its own strand, the manager strand never touches its state
+        const boost::asio::any_io_executor strand = System::makeStrand();
+
+        boost::asio::post(strand, [this, config, strand]()
+                          {
+                              std::shared_ptr<SerialBridge> bridge;
+
+                              try
+                              {
+                                  bridge = std::make_shared<SerialBridge>(config.options, strand);
+                                  bridge->run();
+                              }
+                              catch (const char* const text)
+                              {
+                                  std::cerr << "Bridge [" << config.name << "] failed: " << text << std::endl;
+                                  bridge.reset();
+                              }
+
+                              boost::asio::post(m_strand, [this, config, bridge = std::move(bridge)]() mutable { started(config, std::move(bridge)); });
+                          });
+    }
+}
+
+
+void BridgeManager::started(const BridgeConfig & config, std::shared_ptr<SerialBridge> bridge)
+{
+    auto entry = m_bridges.find(config.name);
+    const bool current = entry != m_bridges.end() && nullptr == entry->second.bridge && entry->second.settings == config.settings;
+
+    if (current && bridge)
+    {
+        entry->second.bridge = std::move(bridge);
+
+        std::cout << "Bridge [" << config.name << "] " << config.options.strDevice
+                  << " <-> port " << config.options.port << std::endl;
+    }
+    else if (current)
+    {
+        m_bridges.erase(entry);
+    }
+    else if (bridge)
+    {
+        // stopped or replaced while being created, released on its own strand like any stopped bridge
+        const boost::asio::any_io_executor executor = bridge->executor();
+
+        boost::asio::post(executor, [bridge = std::move(bridge)]() mutable { bridge.reset(); });
+    }
+}
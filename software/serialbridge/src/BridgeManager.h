@@ -0,0 +1,61 @@
+#ifndef BRIDGEMANAGER_H_4C1E9B37_62A8_4F0D_9E75_D83A2B6F1C58
+#define BRIDGEMANAGER_H_4C1E9B37_62A8_4F0D_9E75_D83A2B6F1C58
+
+/**
+ * @file		BridgeManager.h
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <boost/asio/signal_set.hpp>
+
+#include "Arguments.h"
+
+class SerialBridge;
+
+
+/** runs the bridges of a config file side by side on the shared io service
+ *
+ *  Every bridge keeps its own serial port, server and state. SIGHUP re-reads the file:
+ *  bridges whose section disappeared or changed are stopped, new or changed ones started,
+ *  untouched ones keep running with their clients connected.
+ */
+class BridgeManager
+{
+    struct Bridge
+    {
+        std::string                   settings;
+        std::shared_ptr<SerialBridge> bridge;   /**< nullptr while it is being created on its strand */
+    };
+
+    std::string                   m_configFile;
+    int                           m_argc;
+    char**                        m_argv;      /**< command line defaults of every bridge */
+    std::map<std::string, Bridge> m_bridges;   /**< by section name */
+    boost::asio::any_io_executor  m_strand;    /**< reloads and bridge creation */
+    boost::asio::signal_set       m_signals;
+
+    void awaitReload();
+    void startBridges(const std::vector<BridgeConfig> & configs);
+    void started(const BridgeConfig & config, std::shared_ptr<SerialBridge> bridge);
+
+public:
+    BridgeManager(const std::string & configFile, int argc, char* argv[]);
+    ~BridgeManager();
+
+    /** starts the configured bridges and listens for SIGHUP, false if the file is unusable */
+    bool start();
+
+    /** applies the current content of the config file, false (and nothing changed) if it is unusable */
+    bool reload();
+
+    /** number of running bridges, including those still being created */
+    size_t size() const { return m_bridges.size(); }
+};
+
+#endif /* BRIDGEMANAGER_H_4C1E9B37_62A8_4F0D_9E75_D83A2B6F1C58 */
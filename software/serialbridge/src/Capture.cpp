@@ -0,0 +1,372 @@
+/**
+ * @file		Capture.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include "Capture.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+/** the file grows by this much at a time, one fallocate and mmap per window */
+static constexpr uint64_t WINDOW_SIZE = 4 * 1024 * 1024;
+
+
+template <typename Clock>
+static uint64_t nanoseconds()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+}
+
+
+CaptureWriter::CaptureWriter(const std::string & path)
+{
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (m_fd < 0)
+    {
+        throw "Failed to create the capture file!";
+    }
+
+    void* header = MAP_FAILED;
+
+    try
+    {
+        mapWindow(0);
+        header = ::mmap(nullptr, sizeof(Capture::FileHeader), PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    }
+    catch (const char* const)
+    {
+        close();
+        throw;
+    }
+
+    if (MAP_FAILED == header)
+    {
+        close();
+        throw "Failed to map the capture file header!";
+    }
+
+    m_header = static_cast<Capture::FileHeader*>(header);
+    std::memcpy(m_header->magic, Capture::MAGIC, sizeof(Capture::MAGIC));
+    m_header->version = Capture::VERSION;
+    m_header->headerSize = sizeof(Capture::FileHeader);
+    m_header->startMonotonic = nanoseconds<std::chrono::steady_clock>();
+    m_header->startRealtime = nanoseconds<std::chrono::system_clock>();
+    m_header->end = sizeof(Capture::FileHeader);
+    m_header->lastIndex = 0;
+
+    m_end = sizeof(Capture::FileHeader);
+    m_nextIndexEntry = m_end;
+}
+
+
+CaptureWriter::~CaptureWriter()
+{
+    close();
+}
+
+
+void CaptureWriter::close()
+{
+    try
+    {
+        writeIndex();
+    }
+    catch (const char* const)
+    {
+        // the file ends with the last complete record, readers scan the rest without an index
+    }
+
+    if (nullptr != m_window)
+    {
+        ::munmap(m_window, WINDOW_SIZE);
+        m_window = nullptr;
+    }
+
+    if (nullptr != m_header)
+    {
+        // the reserved rest of the last window goes
+        if (0 != ::ftruncate(m_fd, static_cast<off_t>(m_header->end)))
+        {
+            // stays reserved, readers stop at the end noted in the header anyway
+        }
+
+        ::munmap(m_header, sizeof(Capture::FileHeader));
+        m_header = nullptr;
+    }
+
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+
+void CaptureWriter::record(Capture::eDirection direction, ClientId client, const char* data, size_t length)
+{
+    const uint64_t now = nanoseconds<std::chrono::steady_clock>();
+
+    while (length > 0)
+    {
+        const uint32_t chunk = static_cast<uint32_t>(std::min<size_t>(length, Capture::MAX_LENGTH));
+
+        if (m_end >= m_nextIndexEntry)
+        {
+            m_index.push_back(Capture::IndexEntry{ now, m_end });
+            m_nextIndexEntry = m_end + Capture::INDEX_STRIDE;
+        }
+
+        const Capture::RecordHeader header{ now, client, Capture::RecordHeader::makeInfo(Capture::eRecord::Data, direction, chunk) };
+
+        append(&header, sizeof(header));
+        append(data, chunk);
+
+        // readers see complete records only
+        m_header->end = m_end;
+        ++m_records;
+
+        data += chunk;
+        length -= chunk;
+
+        if (m_index.size() >= Capture::INDEX_ENTRIES)
+        {
+            writeIndex();
+        }
+    }
+}
+
+
+void CaptureWriter::append(const void* data, size_t length)
+{
+    const char* bytes = static_cast<const char*>(data);
+
+    while (length > 0)
+    {
+        if (m_end == m_windowOffset + WINDOW_SIZE)
+        {
+            mapWindow(m_end);
+        }
+
+        const size_t chunk = std::min<uint64_t>(length, m_windowOffset + WINDOW_SIZE - m_end);
+
+        std::memcpy(m_window + (m_end - m_windowOffset), bytes, chunk);
+        m_end += chunk;
+        bytes += chunk;
+        length -= chunk;
+    }
+}
+
+
+/** blocks are reserved before the window is mapped: a full disk throws here instead of raising SIGBUS on a write */
+void CaptureWriter::mapWindow(uint64_t offset)
+{
+    const int result = ::posix_fallocate(m_fd, static_cast<off_t>(offset), static_cast<off_t>(WINDOW_SIZE));
+
+    if (0 != result)
+    {
+        errno = result;
+        throw "Failed to grow the capture file!";
+    }
+
+    void* window = ::mmap(nullptr, WINDOW_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, static_cast<off_t>(offset));
+
+    if (MAP_FAILED == window)
+    {
+        throw "Failed to map the capture file!";
+    }
+
+    if (nullptr != m_window)
+    {
+        ::munmap(m_window, WINDOW_SIZE);
+    }
+
+    m_window = static_cast<char*>(window);
+    m_windowOffset = offset;
+}
+
+
+void CaptureWriter::writeIndex()
+{
+    if (m_index.empty())
+    {
+        return;
+    }
+
+    const uint64_t offset = m_end;
+    const uint32_t length = static_cast<uint32_t>(sizeof(Capture::IndexHeader) + m_index.size() * sizeof(Capture::IndexEntry));
+    const Capture::RecordHeader header{ m_index.back().timestamp, 0, Capture::RecordHeader::makeInfo(Capture::eRecord::Index, Capture::eDirection::SerialToNetwork, length) };
+    const Capture::IndexHeader index{ m_header->lastIndex, static_cast<uint32_t>(m_index.size()), 0 };
+
+    append(&header, sizeof(header));
+    append(&index, sizeof(index));
+    append(m_index.data(), m_index.size() * sizeof(Capture::IndexEntry));
+
+    m_header->end = m_end;
+    m_header->lastIndex = offset;
+    m_index.clear();
+}
+
+
+///////////////////////////
+
+CaptureReader::CaptureReader(const std::string & path)
+{
+    try
+    {
+        open(path);
+    }
+    catch (const char* const)
+    {
+        close();
+        throw;
+    }
+}
+
+
+void CaptureReader::open(const std::string & path)
+{
+    struct stat status{};
+
+    m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (m_fd < 0 || 0 != ::fstat(m_fd, &status))
+    {
+        throw "Failed to open the capture file!";
+    }
+
+    m_size = static_cast<size_t>(status.st_size);
+
+    if (m_size < sizeof(Capture::FileHeader))
+    {
+        throw "Not a capture file!";
+    }
+
+    void* map = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+
+    if (MAP_FAILED == map)
+    {
+        throw "Failed to map the capture file!";
+    }
+
+    m_map = static_cast<const char*>(map);
+
+    if (0 != std::memcmp(header().magic, Capture::MAGIC, sizeof(Capture::MAGIC)) || Capture::VERSION != header().version ||
+        header().headerSize < sizeof(Capture::FileHeader) || header().headerSize > m_size)
+    {
+        throw "Not a capture file!";
+    }
+
+    // a capture still being recorded has grown since, one left by a crash has reserved space behind its end
+    m_end = std::max<uint64_t>(header().headerSize, std::min<uint64_t>(header().end, m_size));
+    m_position = header().headerSize;
+}
+
+
+CaptureReader::~CaptureReader()
+{
+    close();
+}
+
+
+void CaptureReader::close()
+{
+    if (nullptr != m_map)
+    {
+        ::munmap(const_cast<char*>(m_map), m_size);
+        m_map = nullptr;
+    }
+
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+
+bool CaptureReader::next(CaptureRecord & record)
+{
+    while (m_position + sizeof(Capture::RecordHeader) <= m_end)
+    {
+        Capture::RecordHeader header;
+        std::memcpy(&header, m_map + m_position, sizeof(header));
+
+        const uint64_t payload = m_position + sizeof(header);
+
+        if (payload + header.length() > m_end)
+        {
+            break;
+        }
+
+        record.offset = m_position;
+        m_position = payload + header.length();
+
+        if (Capture::eRecord::Data == header.type())
+        {
+            record.timestamp = header.timestamp;
+            record.client = header.client;
+            record.direction = header.direction();
+            record.data = m_map + payload;
+            record.length = header.length();
+            return true;
+        }
+    }
+
+    m_position = m_end;
+    return false;
+}
+
+
+void CaptureReader::seek(uint64_t timestamp)
+{
+    uint64_t best = header().headerSize;
+
+    // newest index first, each one points to the one before
+    for (uint64_t offset = header().lastIndex; offset >= header().headerSize && offset + sizeof(Capture::RecordHeader) + sizeof(Capture::IndexHeader) <= m_end; )
+    {
+        Capture::RecordHeader record;
+        Capture::IndexHeader index;
+
+        std::memcpy(&record, m_map + offset, sizeof(record));
+        std::memcpy(&index, m_map + offset + sizeof(record), sizeof(index));
+
+        if (Capture::eRecord::Index != record.type() || offset + sizeof(record) + record.length() > m_end ||
+            sizeof(index) + uint64_t(index.count) * sizeof(Capture::IndexEntry) > record.length())
+        {
+            break;
+        }
+
+        for (uint32_t i = 0; i < index.count; ++i)
+        {
+            Capture::IndexEntry entry;
+            std::memcpy(&entry, m_map + offset + sizeof(record) + sizeof(index) + i * sizeof(entry), sizeof(entry));
+
+            if (entry.timestamp <= timestamp && entry.offset > best && entry.offset < m_end)
+            {
+                best = entry.offset;
+            }
+        }
+
+        // entries only get older along the chain
+        if (best > header().headerSize || index.previous >= offset)
+        {
+            break;
+        }
+
+        offset = index.previous;
+    }
+
+    m_position = best;
+}
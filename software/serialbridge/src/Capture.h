@@ -0,0 +1,184 @@
+#ifndef CAPTURE_H_1C6E93B7_52A0_4D8F_B3E4_80F2A7D95C16
+#define CAPTURE_H_1C6E93B7_52A0_4D8F_B3E4_80F2A7D95C16
+
+/**
+ * @file		Capture.h
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ *
+ * Capture file layout, all fields in host byte order:
+ *
+ *   FileHeader   64 bytes, kept up to date while recording (end, lastIndex)
+ *   records      RecordHeader (16 bytes, unaligned) followed by the payload
+ *
+ * Data records hold one chunk as the bridge saw it. Every INDEX_STRIDE bytes the recorder
+ * notes the timestamp and offset of the next record; an index record holding these entries
+ * and the offset of the previous index record is written every INDEX_ENTRIES entries and
+ * when the capture is closed, so readers seek by time walking the chain from lastIndex.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "INetworkHandler.h"
+
+
+/** capture file format, shared by the recorder of the bridge and the tools reading captures */
+struct Capture
+{
+    static constexpr char     MAGIC[8] = { 'S', 'B', 'C', 'A', 'P', 'T', '0', '1' };
+    static constexpr uint32_t VERSION = 1;
+
+    static constexpr uint64_t INDEX_STRIDE = 64 * 1024;
+    static constexpr size_t   INDEX_ENTRIES = 64;
+
+    /** payload bytes of one record, larger chunks are split */
+    static constexpr uint32_t MAX_LENGTH = (1U << 28) - 1;
+
+    enum class eDirection : uint8_t
+    {
+        SerialToNetwork = 0,
+        NetworkToSerial = 1
+    };
+
+    enum class eRecord : uint8_t
+    {
+        Data = 0,
+        Index = 1
+    };
+
+    struct FileHeader
+    {
+        char     magic[8];
+        uint32_t version;
+        uint32_t headerSize;       /**< offset of the first record */
+        uint64_t startMonotonic;   /**< ns of the steady clock when the capture started */
+        uint64_t startRealtime;    /**< ns since the epoch at the same moment, to show wall-clock times */
+        uint64_t end;              /**< offset behind the last complete record */
+        uint64_t lastIndex;        /**< offset of the newest index record, 0 if none yet */
+        uint8_t  reserved[16];
+    };
+
+    struct RecordHeader
+    {
+        uint64_t timestamp;   /**< ns of the steady clock */
+        uint32_t client;      /**< the sending client, 0 for data of the device */
+        uint32_t info;        /**< payload length in bits 0-27, direction in bits 28-29, record type in bits 30-31 */
+
+        uint32_t length() const { return info & MAX_LENGTH; }
+        eDirection direction() const { return static_cast<eDirection>((info >> 28) & 3U); }
+        eRecord type() const { return static_cast<eRecord>((info >> 30) & 3U); }
+
+        static uint32_t makeInfo(eRecord type, eDirection direction, uint32_t length)
+        {
+            return (static_cast<uint32_t>(type) << 30) | (static_cast<uint32_t>(direction) << 28) | (length & MAX_LENGTH);
+        }
+    };
+
+    /** payload of an index record, followed by count entries */
+    struct IndexHeader
+    {
+        uint64_t previous;   /**< offset of the index record before, 0 for the first */
+        uint32_t count;
+        uint32_t reserved;
+    };
+
+    struct IndexEntry
+    {
+        uint64_t timestamp;
+        uint64_t offset;     /**< of a record header */
+    };
+
+    static_assert(sizeof(FileHeader) == 64, "capture file header layout");
+    static_assert(sizeof(RecordHeader) == 16, "capture record header layout");
+    static_assert(sizeof(IndexHeader) == 16 && sizeof(IndexEntry) == 16, "capture index layout");
+};
+
+
+/** appends records to a memory-mapped file, growing it window by window
+ *
+ *  Blocks are reserved before a window is mapped, so a full disk throws instead of raising
+ *  SIGBUS. Not thread-safe, the bridge records from its strand.
+ */
+class CaptureWriter
+{
+public:
+    /** truncates an existing file, throws a string literal on failure */
+    explicit CaptureWriter(const std::string & path);
+
+    /** writes the last index and cuts the file to its content */
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /** throws a string literal if the file cannot grow */
+    void record(Capture::eDirection direction, ClientId client, const char* data, size_t length);
+
+    uint64_t size() const { return m_end; }
+    uint64_t records() const { return m_records; }
+
+private:
+    void close();
+    void append(const void* data, size_t length);
+    void mapWindow(uint64_t offset);
+    void writeIndex();
+
+    int                     m_fd = -1;
+    Capture::FileHeader*    m_header = nullptr;    /**< mapped on its own, the windows move on */
+    char*                   m_window = nullptr;
+    uint64_t                m_windowOffset = 0;
+    uint64_t                m_end = 0;
+    uint64_t                m_nextIndexEntry = 0;  /**< file offset from which the next record is indexed */
+    uint64_t                m_records = 0;
+    std::vector<Capture::IndexEntry> m_index;
+};
+
+
+/** one record of a capture, the data points into the mapped file */
+struct CaptureRecord
+{
+    uint64_t    offset = 0;
+    uint64_t    timestamp = 0;
+    ClientId    client = 0;
+    Capture::eDirection direction = Capture::eDirection::SerialToNetwork;
+    const char* data = nullptr;
+    size_t      length = 0;
+};
+
+/** reads a capture file, also one still being recorded or left by a crash */
+class CaptureReader
+{
+public:
+    /** throws a string literal if the file is missing or no capture */
+    explicit CaptureReader(const std::string & path);
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    const Capture::FileHeader & header() const { return *reinterpret_cast<const Capture::FileHeader*>(m_map); }
+
+    /** the next data record, false at the end */
+    bool next(CaptureRecord & record);
+
+    /** continues at the latest indexed record not after the timestamp, the records up to it still need skipping */
+    void seek(uint64_t timestamp);
+
+    void rewind() { m_position = header().headerSize; }
+
+private:
+    void open(const std::string & path);
+    void close();
+
+    int         m_fd = -1;
+    const char* m_map = nullptr;
+    size_t      m_size = 0;
+    uint64_t    m_end = 0;
+    uint64_t    m_position = 0;
+};
+
+#endif /* CAPTURE_H_1C6E93B7_52A0_4D8F_B3E4_80F2A7D95C16 */
@@ -0,0 +1,232 @@
+/**
+ * @file		CaptureDump.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ *
+ * serialbridge_dump: prints the records of a capture file written with --capture
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+
+#include <boost/program_options.hpp>
+
+#include "Capture.h"
+
+
+using namespace boost::program_options;
+
+
+/** how the payload of a record is shown */
+enum class eFormat : uint8_t
+{
+    Summary = 0,   /**< one line per record */
+    Hex = 1,       /**< hex dump below each line */
+    Text = 2,      /**< escaped text below each line */
+    Raw = 3        /**< the payload bytes only, e.g. to extract the serial stream */
+};
+
+
+static const char* toString(Capture::eDirection direction)
+{
+    return Capture::eDirection::SerialToNetwork == direction ? "serial->net" : "net->serial";
+}
+
+
+static void printHex(const char* data, size_t length)
+{
+    for (size_t line = 0; line < length; line += 16)
+    {
+        std::printf("    %06zx ", line);
+
+        for (size_t i = line; i < line + 16; ++i)
+        {
+            if (i < length)
+            {
+                std::printf(" %02x", static_cast<unsigned char>(data[i]));
+            }
+            else
+            {
+                std::printf("   ");
+            }
+        }
+
+        std::printf("  |");
+
+        for (size_t i = line; i < line + 16 && i < length; ++i)
+        {
+            std::putchar(std::isprint(static_cast<unsigned char>(data[i])) ? data[i] : '.');
+        }
+
+        std::printf("|\n");
+    }
+}
+
+
+static void printText(const char* data, size_t length)
+{
+    std::printf("    ");
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        const unsigned char c = static_cast<unsigned char>(data[i]);
+
+        switch (c)
+        {
+        case '\n': std::printf("\\n"); break;
+        case '\r': std::printf("\\r"); break;
+        case '\t': std::printf("\\t"); break;
+        case '\\': std::printf("\\\\"); break;
+        default:
+            if (std::isprint(c))
+            {
+                std::putchar(c);
+            }
+            else
+            {
+                std::printf("\\x%02x", c);
+            }
+        }
+    }
+
+    std::printf("\n");
+}
+
+
+int main(int argc, char** argv)
+{
+    options_description options("serialbridge_dump [options] FILE");
+    options.add_options()
+            ("help,h", "this description")
+            ("file", value< std::string >(), "capture file")
+            ("format,f", value< std::string >()->default_value( "summary" ), "summary (one line per record), hex, text or raw (payload bytes only)")
+            ("direction", value< std::string >()->default_value( "both" ), "serial (data of the device), network (data of the clients) or both")
+            ("client", value<unsigned int>(), "records of this client only")
+            ("from", value<double>(), "seconds into the capture to start at, seeking via the index")
+            ("to", value<double>(), "seconds into the capture to stop at")
+            ("stats", "prints totals per direction and client instead of the records")
+            ;
+
+    positional_options_description positional;
+    positional.add("file", 1);
+
+    variables_map vm;
+
+    try
+    {
+        store(command_line_parser(argc, argv).options(options).positional(positional).run(), vm);
+        notify(vm);
+    }
+    catch (const error & e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (vm.count("help") || !vm.count("file"))
+    {
+        std::cout << options << std::endl;
+        return vm.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    const std::string format = vm["format"].as< std::string >();
+    const std::string direction = vm["direction"].as< std::string >();
+    const eFormat output = "hex" == format ? eFormat::Hex : ("text" == format ? eFormat::Text : ("raw" == format ? eFormat::Raw : eFormat::Summary));
+    const bool withSerial = "network" != direction;
+    const bool withNetwork = "serial" != direction;
+
+    try
+    {
+        CaptureReader reader(vm["file"].as< std::string >());
+
+        const uint64_t start = reader.header().startMonotonic;
+        const uint64_t from = vm.count("from") ? start + static_cast<uint64_t>(vm["from"].as<double>() * 1e9) : 0;
+        const uint64_t to = vm.count("to") ? start + static_cast<uint64_t>(vm["to"].as<double>() * 1e9) : UINT64_MAX;
+
+        if (eFormat::Raw != output && !vm.count("stats"))
+        {
+            const std::time_t started = static_cast<std::time_t>(reader.header().startRealtime / 1000000000ULL);
+            char date[32];
+
+            std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", std::localtime(&started));
+            std::printf("Capture started %s, %llu bytes\n", date, static_cast<unsigned long long>(reader.header().end));
+        }
+
+        if (from > 0)
+        {
+            reader.seek(from);
+        }
+
+        // bytes and records per direction and client
+        std::map<std::pair<Capture::eDirection, ClientId>, std::pair<uint64_t, uint64_t>> totals;
+        CaptureRecord record;
+
+        while (reader.next(record))
+        {
+            if (record.timestamp < from)
+            {
+                continue;
+            }
+
+            if (record.timestamp > to)
+            {
+                break;
+            }
+
+            const bool fromSerial = Capture::eDirection::SerialToNetwork == record.direction;
+
+            if ((fromSerial ? !withSerial : !withNetwork) || (vm.count("client") && record.client != vm["client"].as<unsigned int>()))
+            {
+                continue;
+            }
+
+            if (vm.count("stats"))
+            {
+                auto & total = totals[std::make_pair(record.direction, record.client)];
+                total.first += record.length;
+                ++total.second;
+                continue;
+            }
+
+            if (eFormat::Raw == output)
+            {
+                std::fwrite(record.data, 1, record.length, stdout);
+                continue;
+            }
+
+            const uint64_t elapsed = record.timestamp - start;
+
+            std::printf("%6llu.%09llu  %s  client %-5u %6zu B\n", static_cast<unsigned long long>(elapsed / 1000000000ULL),
+                        static_cast<unsigned long long>(elapsed % 1000000000ULL), toString(record.direction), record.client, record.length);
+
+            if (eFormat::Hex == output)
+            {
+                printHex(record.data, record.length);
+            }
+            else if (eFormat::Text == output)
+            {
+                printText(record.data, record.length);
+            }
+        }
+
+        for (const auto & total : totals)
+        {
+            std::printf("%s  client %-5u %12llu B in %llu records\n", toString(total.first.first), total.first.second,
+                        static_cast<unsigned long long>(total.second.first), static_cast<unsigned long long>(total.second.second));
+        }
+    }
+    catch (const char* const text)
+    {
+        std::cerr << ">>> " << text << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
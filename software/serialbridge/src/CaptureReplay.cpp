@@ -0,0 +1,329 @@
+/**
+ * @file		CaptureReplay.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ *
+ * serialbridge_replay: plays the device side of a capture into a pseudo-terminal,
+ * so a bridge opened on it sees the recorded device without the hardware
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <boost/program_options.hpp>
+
+#include "Capture.h"
+#include "Histogram.h"
+
+
+using namespace boost::program_options;
+using Clock = std::chrono::steady_clock;
+
+
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void onSignal(int)
+{
+    stopRequested = 1;
+}
+
+
+/** the master of a new pty; the slave is opened once to make it raw, and closed again so the master reports
+ *  POLLHUP until the bridge opens it */
+static int openTerminal(std::string & slave)
+{
+    const int master = ::posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (master < 0 || 0 != ::grantpt(master) || 0 != ::unlockpt(master) || nullptr == ::ptsname(master))
+    {
+        throw "Failed to create a pseudo-terminal!";
+    }
+
+    slave = ::ptsname(master);
+
+    const int fd = ::open(slave.c_str(), O_RDWR | O_NOCTTY);
+    termios settings{};
+
+    if (fd < 0 || 0 != ::tcgetattr(fd, &settings))
+    {
+        throw "Failed to open the pseudo-terminal!";
+    }
+
+    ::cfmakeraw(&settings);
+    ::tcsetattr(fd, TCSANOW, &settings);
+    ::close(fd);
+
+    ::fcntl(master, F_SETFL, ::fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    return master;
+}
+
+
+/** waits for the master to become writable until the deadline, discarding what the bridge sends to the device;
+ *  returns POLLHUP while the slave is closed, POLLOUT once writable, 0 on timeout or signal */
+static short waitTerminal(int master, Clock::time_point deadline, bool writing, uint64_t & discarded)
+{
+    char buffer[4096];
+
+    for (;;)
+    {
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+        pollfd terminal{ master, static_cast<short>(POLLIN | (writing ? POLLOUT : 0)), 0 };
+
+        if (stopRequested || ::poll(&terminal, 1, static_cast<int>(std::max<int64_t>(0, remaining.count()))) < 0)
+        {
+            return 0;
+        }
+
+        if (0 != (terminal.revents & POLLHUP))
+        {
+            return POLLHUP;
+        }
+
+        if (0 != (terminal.revents & POLLIN))
+        {
+            const ssize_t length = ::read(master, buffer, sizeof(buffer));
+            discarded += length > 0 ? static_cast<uint64_t>(length) : 0;
+        }
+
+        if (0 != (terminal.revents & POLLOUT))
+        {
+            return POLLOUT;
+        }
+
+        if (Clock::now() >= deadline)
+        {
+            return 0;
+        }
+
+        // poll sleeps whole milliseconds, the rest of the wait is slept precisely
+        if (0 == terminal.revents && deadline - Clock::now() < std::chrono::milliseconds(1))
+        {
+            std::this_thread::sleep_until(deadline);
+            return 0;
+        }
+    }
+}
+
+
+/** waits up to a few seconds until the bridge has read everything written to the terminal */
+static void drainTerminal(int master, const std::string & slave, uint64_t & discarded)
+{
+    const int fd = ::open(slave.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK);
+    const Clock::time_point deadline = Clock::now() + std::chrono::seconds(5);
+    int pending = 0;
+
+    while (fd >= 0 && Clock::now() < deadline && 0 == ::ioctl(fd, FIONREAD, &pending) && pending > 0)
+    {
+        waitTerminal(master, Clock::now() + std::chrono::milliseconds(10), false, discarded);
+    }
+
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    options_description options("serialbridge_replay [options] FILE");
+    options.add_options()
+            ("help,h", "this description")
+            ("file", value< std::string >(), "capture file written with --capture")
+            ("link", value< std::string >(), "symlink to the pseudo-terminal, e.g. /tmp/ttyREPLAY (removed on exit)")
+            ("speed", value<double>()->default_value( 1.0 ), "timing multiplier, 2 plays twice as fast, 0 as fast as the bridge reads")
+            ("loop", value<unsigned int>()->default_value( 1U ), "plays the capture this many times, 0 endlessly")
+            ("delay", value<double>()->default_value( 0.0 ), "seconds to wait after the device was opened, e.g. for clients to connect")
+            ;
+
+    positional_options_description positional;
+    positional.add("file", 1);
+
+    variables_map vm;
+
+    try
+    {
+        store(command_line_parser(argc, argv).options(options).positional(positional).run(), vm);
+        notify(vm);
+    }
+    catch (const error & e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (vm.count("help") || !vm.count("file"))
+    {
+        std::cout << options << std::endl;
+        return vm.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    const double speed = std::max(0.0, vm["speed"].as<double>());
+    const unsigned loops = vm["loop"].as<unsigned int>();
+    const auto delay = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::max(0.0, vm["delay"].as<double>())));
+    const std::string link = vm.count("link") ? vm["link"].as< std::string >() : std::string();
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    try
+    {
+        CaptureReader reader(vm["file"].as< std::string >());
+        std::string slave;
+        const int master = openTerminal(slave);
+
+        if (!link.empty())
+        {
+            ::unlink(link.c_str());
+
+            if (0 != ::symlink(slave.c_str(), link.c_str()))
+            {
+                throw "Failed to create the link to the pseudo-terminal!";
+            }
+        }
+
+        std::cout << "Replaying on " << (link.empty() ? slave : link + " -> " + slave) << ", waiting for the device to be opened" << std::endl;
+
+        uint64_t discarded = 0;
+
+        while (!stopRequested && POLLOUT != waitTerminal(master, Clock::now() + std::chrono::milliseconds(10), true, discarded))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        for (const Clock::time_point opened = Clock::now(); !stopRequested && Clock::now() < opened + delay; )
+        {
+            waitTerminal(master, opened + delay, false, discarded);
+        }
+
+        if (!stopRequested)
+        {
+            std::cout << "Device opened, replay started" << std::endl;
+        }
+
+        uint64_t bytes = 0;
+        uint64_t records = 0;
+        Histogram lateness;   // us a chunk went out after its due time
+        const Clock::time_point started = Clock::now();
+
+        for (unsigned loop = 0; !stopRequested && (0 == loops || loop < loops); ++loop)
+        {
+            CaptureRecord record;
+            uint64_t first = 0;
+            Clock::time_point begin;
+
+            reader.rewind();
+
+            while (!stopRequested && reader.next(record))
+            {
+                if (Capture::eDirection::SerialToNetwork != record.direction)
+                {
+                    continue;
+                }
+
+                if (0 == first)
+                {
+                    first = record.timestamp;
+                    begin = Clock::now();
+                }
+
+                const Clock::time_point due = begin + std::chrono::nanoseconds(speed > 0.0 ? static_cast<int64_t>((record.timestamp - first) / speed) : 0);
+
+                // the wait for the due time keeps the output of the bridge drained
+                while (!stopRequested && Clock::now() < due)
+                {
+                    waitTerminal(master, due, false, discarded);
+                }
+
+                for (size_t written = 0; !stopRequested && written < record.length; )
+                {
+                    const short ready = waitTerminal(master, Clock::now() + std::chrono::milliseconds(100), true, discarded);
+
+                    if (POLLHUP == ready)
+                    {
+                        // nobody has the device open (not yet, or the bridge reconnects): the timeline waits as well
+                        const Clock::time_point paused = Clock::now();
+
+                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                        begin += Clock::now() - paused;
+                        continue;
+                    }
+
+                    if (POLLOUT != ready)
+                    {
+                        continue;
+                    }
+
+                    const ssize_t length = ::write(master, record.data + written, record.length - written);
+
+                    if (length > 0)
+                    {
+                        written += static_cast<size_t>(length);
+                    }
+                }
+
+                if (speed > 0.0)
+                {
+                    lateness.add(static_cast<uint64_t>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - due).count())));
+                }
+
+                bytes += record.length;
+                ++records;
+            }
+        }
+
+        const double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+
+        std::printf("Replayed %llu B in %llu chunks, %.3f s, %.0f B/s, %llu B from the bridge discarded\n",
+                    static_cast<unsigned long long>(bytes), static_cast<unsigned long long>(records), seconds,
+                    seconds > 0.0 ? static_cast<double>(bytes) / seconds : 0.0, static_cast<unsigned long long>(discarded));
+
+        if (lateness.count() > 0)
+        {
+            std::printf("Lateness p50/p99/max %llu/%llu/%llu us\n", static_cast<unsigned long long>(lateness.percentile(0.5)),
+                        static_cast<unsigned long long>(lateness.percentile(0.99)), static_cast<unsigned long long>(lateness.max()));
+        }
+
+        // the bridge reads what is still in the terminal before it sees the hangup
+        if (!stopRequested)
+        {
+            drainTerminal(master, slave, discarded);
+        }
+
+        if (!link.empty())
+        {
+            ::unlink(link.c_str());
+        }
+
+        ::close(master);
+    }
+    catch (const char* const text)
+    {
+        std::cerr << ">>> " << text << " (" << std::strerror(errno) << ")" << std::endl;
+
+        if (!link.empty())
+        {
+            ::unlink(link.c_str());
+        }
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
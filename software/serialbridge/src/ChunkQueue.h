@@ -0,0 +1,162 @@
+#ifndef CHUNKQUEUE_H_8E2B4D71_0C93_4A5F_B6E8_71A9D3F2C045
+#define CHUNKQUEUE_H_8E2B4D71_0C93_4A5F_B6E8_71A9D3F2C045
+
+/**
+ * @file		ChunkQueue.h
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <boost/asio/buffer.hpp>
+
+
+/** immutable block of data, shared by reference between all clients it is queued on */
+using SharedChunk = std::shared_ptr<const std::vector<char>>;
+
+/** stores the given data once for being queued on any number of clients */
+inline SharedChunk makeChunk(const char* data, size_t length)
+{
+    return std::make_shared<const std::vector<char>>(data, data + length);
+}
+
+
+/** fixed-capacity single-producer/single-consumer queue of shared chunks
+ *
+ *  Same contract as RingBuffer, but holding references instead of bytes: the producer
+ *  push()es, the consumer gathers a scatter list from the front and pop()s it once sent.
+ */
+class ChunkQueue
+{
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    /** creates a queue holding at least the given number of chunks (rounded up to a power of two) */
+    explicit ChunkQueue(size_t capacity)
+        : m_capacity(roundUp(capacity)),
+          m_mask(m_capacity - 1),
+          m_slots(m_capacity)
+    {
+    }
+
+    ChunkQueue(const ChunkQueue&) = delete;
+    ChunkQueue& operator=(const ChunkQueue&) = delete;
+
+    size_t capacity() const noexcept { return m_capacity; }
+
+    /** number of queued chunks */
+    size_t size() const noexcept
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const noexcept { return 0 == size(); }
+
+
+    //// producer side
+
+    /** queues a reference to the chunk, false if the queue is full */
+    bool push(const SharedChunk & chunk) noexcept
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+
+        if (head - m_tail.load(std::memory_order_acquire) >= m_capacity)
+        {
+            return false;
+        }
+
+        m_slots[head & m_mask] = chunk;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+
+    //// consumer side
+
+    /** the oldest queued chunk, the queue must not be empty */
+    const SharedChunk & front() const noexcept
+    {
+        return m_slots[m_tail.load(std::memory_order_relaxed) & m_mask];
+    }
+
+    /** the queued chunk at the given position from the front, which has to exist */
+    const SharedChunk & at(size_t index) const noexcept
+    {
+        return m_slots[(m_tail.load(std::memory_order_relaxed) + index) & m_mask];
+    }
+
+    /** appends up to maxChunks queued chunks to the scatter list, returns the number of chunks added */
+    size_t gather(std::vector<boost::asio::const_buffer> & buffers, size_t maxChunks) const
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t count = std::min(maxChunks, m_head.load(std::memory_order_acquire) - tail);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const SharedChunk & chunk = m_slots[(tail + i) & m_mask];
+            buffers.push_back(boost::asio::buffer(chunk->data(), chunk->size()));
+        }
+
+        return count;
+    }
+
+    /** releases the given number of chunks at the front */
+    void pop(size_t count) noexcept
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            m_slots[(tail + i) & m_mask].reset();
+        }
+
+        m_tail.store(tail + count, std::memory_order_release);
+    }
+
+    /** releases count chunks behind the first skip ones, which move up and stay queued in order
+     *  (a pending write gathered them; it references their data, which does not move) */
+    void erase(size_t skip, size_t count) noexcept
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        for (size_t i = skip; i-- > 0; )
+        {
+            m_slots[(tail + count + i) & m_mask] = std::move(m_slots[(tail + i) & m_mask]);
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            m_slots[(tail + i) & m_mask].reset();
+        }
+
+        m_tail.store(tail + count, std::memory_order_release);
+    }
+
+private:
+    static size_t roundUp(size_t capacity) noexcept
+    {
+        size_t result = 1;
+
+        while (result < capacity)
+        {
+            result <<= 1;
+        }
+
+        return result;
+    }
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_head{ 0 }; /**< total chunks pushed, owned by the producer */
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail{ 0 }; /**< total chunks popped, owned by the consumer */
+
+    alignas(CACHE_LINE_SIZE) const size_t m_capacity;
+    const size_t              m_mask;
+    std::vector<SharedChunk>  m_slots;
+};
+
+#endif /* CHUNKQUEUE_H_8E2B4D71_0C93_4A5F_B6E8_71A9D3F2C045 */
@@ -0,0 +1,150 @@
+/**
+ * @file		Coalescer.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include "Coalescer.h"
+
+#include <algorithm>
+#include <iterator>
+
+
+Coalescer::Coalescer(const boost::asio::any_io_executor & executor, const Settings & settings, FlushHandler onFlush)
+    : m_settings(settings),
+      m_onFlush(std::move(onFlush)),
+      m_timer(executor)
+{
+    m_buffer.reserve(m_settings.maxBytes);
+}
+
+
+void Coalescer::append(const char* data, size_t length)
+{
+    if (!isEnabled())
+    {
+        if (m_onFlush)
+        {
+            m_onFlush(data, length);
+        }
+
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+
+    // everything up to the last delimiter goes out now, only the tail after it waits
+    if (m_settings.delimiter >= 0)
+    {
+        const auto begin = std::make_reverse_iterator(data);
+        const auto last = std::find(std::make_reverse_iterator(data + length), begin, static_cast<char>(m_settings.delimiter));
+
+        if (last != begin)
+        {
+            const size_t head = static_cast<size_t>(last.base() - data);
+
+            if (m_buffer.empty())
+            {
+                emit(data, head, eFlush::Delimiter, now);
+            }
+            else
+            {
+                m_buffer.insert(m_buffer.end(), data, data + head);
+                emitBuffer(eFlush::Delimiter);
+            }
+
+            data += head;
+            length -= head;
+        }
+    }
+
+    if (0 == length)
+    {
+        return;
+    }
+
+    if (m_buffer.empty())
+    {
+        // a read filling a segment on its own is passed on without copying
+        if (length >= m_settings.maxBytes)
+        {
+            emit(data, length, eFlush::Size, now);
+            return;
+        }
+
+        m_firstByte = now;
+        startTimer();
+    }
+
+    m_buffer.insert(m_buffer.end(), data, data + length);
+
+    if (m_buffer.size() >= m_settings.maxBytes)
+    {
+        emitBuffer(eFlush::Size);
+    }
+}
+
+
+void Coalescer::flush()
+{
+    if (!m_buffer.empty())
+    {
+        emitBuffer(eFlush::Explicit);
+    }
+}
+
+
+void Coalescer::stop()
+{
+    m_onFlush = nullptr;
+    m_buffer.clear();
+    ++m_generation;
+    m_timer.cancel();
+}
+
+
+void Coalescer::emit(const char* data, size_t length, eFlush reason, std::chrono::steady_clock::time_point since)
+{
+    const auto delay = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - since);
+
+    ++m_statistics.flushes[static_cast<size_t>(reason)];
+    m_statistics.sizeBytes.add(length);
+    m_statistics.delayMicros.add(static_cast<uint64_t>(delay.count()));
+
+    if (m_onFlush)
+    {
+        m_onFlush(data, length);
+    }
+}
+
+
+void Coalescer::emitBuffer(eFlush reason)
+{
+    ++m_generation;
+    m_timer.cancel();
+
+    // the handler copies the data into the client queues, so the buffer is reused right away
+    emit(m_buffer.data(), m_buffer.size(), reason, m_firstByte);
+    m_buffer.clear();
+}
+
+
+void Coalescer::startTimer()
+{
+    std::weak_ptr<Coalescer> weak(shared_from_this());
+    const uint64_t generation = m_generation;
+
+    m_timer.expires_after(std::chrono::microseconds(m_settings.maxDelayMicros));
+    m_timer.async_wait([weak, generation](const boost::system::error_code & error)
+                       {
+                           auto self = weak.lock();
+
+                           // a completion already queued when the buffer went out is not cancelled anymore,
+                           // it must not cut the next buffer short
+                           if (!error && self && generation == self->m_generation && !self->m_buffer.empty())
+                           {
+                               self->emitBuffer(eFlush::Timer);
+                           }
+                       });
+}
@@ -0,0 +1,90 @@
+#ifndef COALESCER_H_E3B07F25_61C4_4A8E_9D12_7F0A5C83B6D9
+#define COALESCER_H_E3B07F25_61C4_4A8E_9D12_7F0A5C83B6D9
+
+/**
+ * @file		Coalescer.h
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include "Histogram.h"
+
+
+/** collects small serial reads into larger network writes with a bounded delay
+ *
+ *  Data is held back until the size threshold is reached, a delimiter arrives or the first
+ *  byte waited for the maximum delay, whichever comes first. Runs on a single executor
+ *  (the strand of the bridge), the flush handler is called there as well.
+ */
+class Coalescer : public std::enable_shared_from_this<Coalescer>
+{
+public:
+    /** what made the data go out */
+    enum class eFlush : uint8_t
+    {
+        Size = 0,
+        Timer = 1,
+        Delimiter = 2,
+        Explicit = 3     /**< flush() by the owner */
+    };
+
+    struct Settings
+    {
+        uint32_t maxDelayMicros = 0;   /**< bound of the delay added to the first byte, 0 disables coalescing */
+        size_t   maxBytes = 1448;      /**< flush once this much is collected (one TCP segment on ethernet) */
+        int      delimiter = -1;       /**< flush up to and including this byte, -1 for none */
+    };
+
+    struct Statistics
+    {
+        std::array<uint64_t, 4> flushes{};   /**< per eFlush */
+        Histogram sizeBytes;
+        Histogram delayMicros;               /**< time the first byte of a flush waited */
+    };
+
+    using FlushHandler = std::function<void(const char* data, size_t length)>;
+
+    Coalescer(const boost::asio::any_io_executor & executor, const Settings & settings, FlushHandler onFlush);
+
+    Coalescer(const Coalescer&) = delete;
+    Coalescer& operator=(const Coalescer&) = delete;
+
+    /** hands the data on right away if coalescing is disabled */
+    void append(const char* data, size_t length);
+
+    /** sends whatever is collected */
+    void flush();
+
+    /** drops collected data and stops calling the handler */
+    void stop();
+
+    bool isEnabled() const { return m_settings.maxDelayMicros > 0; }
+
+    const Statistics & statistics() const { return m_statistics; }
+
+private:
+    void emit(const char* data, size_t length, eFlush reason, std::chrono::steady_clock::time_point since);
+    void emitBuffer(eFlush reason);
+    void startTimer();
+
+    const Settings            m_settings;
+    FlushHandler              m_onFlush;
+    boost::asio::steady_timer m_timer;        /**< nanosecond resolution on linux, unaffected by clock changes */
+    std::vector<char>         m_buffer;
+    std::chrono::steady_clock::time_point m_firstByte;   /**< arrival of the oldest byte in the buffer */
+    uint64_t                  m_generation = 0;   /**< buffers emitted, a timer armed for an earlier one is stale */
+    Statistics                m_statistics;
+};
+
+#endif /* COALESCER_H_E3B07F25_61C4_4A8E_9D12_7F0A5C83B6D9 */
@@ -0,0 +1,280 @@
+/**
+ * @file		DeviceWatcher.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include "DeviceWatcher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+
+static const std::string USB_PREFIX = "usb:";
+
+/** node creation and removal, renames (udev moves its links into place) and permission changes (udev chowns new nodes) */
+static constexpr uint32_t WATCH_EVENTS = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB;
+
+
+std::shared_ptr<DeviceWatcher> DeviceWatcher::create(const boost::asio::any_io_executor & executor, const std::string & device)
+{
+    try
+    {
+        return std::make_shared<DeviceWatcher>(executor, device);
+    }
+    catch (const char* const text)
+    {
+        std::cerr << "Device watcher: " << text << " (" << std::strerror(errno) << "), polling for " << device << std::endl;
+    }
+
+    return nullptr;
+}
+
+
+DeviceWatcher::DeviceWatcher(const boost::asio::any_io_executor & executor, const std::string & device)
+    : m_inotify(executor)
+{
+    const int fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (fd < 0)
+    {
+        throw "Failed to create inotify instance!";
+    }
+
+    m_inotify.assign(fd);
+
+    if (!isUsbDeviceSpec(device))
+    {
+        m_device = boost::filesystem::absolute(device).lexically_normal().string();
+    }
+
+    addWatches();
+
+    if (m_watches.empty())
+    {
+        throw "Failed to watch the device directory!";
+    }
+}
+
+
+void DeviceWatcher::start(ChangeHandler onChange)
+{
+    m_onChange = std::move(onChange);
+    m_running = true;
+
+    waitReadable();
+}
+
+
+void DeviceWatcher::stop()
+{
+    m_running = false;
+    m_onChange = nullptr;
+
+    boost::system::error_code ignored;
+    m_inotify.cancel(ignored);
+}
+
+
+/** watches every existing directory on the way to the device, so parents created later (e.g. /dev/serial/by-id) are seen too;
+ *  adding a watch twice returns the same descriptor, so this runs again after each batch */
+void DeviceWatcher::addWatches()
+{
+    if (m_device.empty())
+    {
+        const int wd = ::inotify_add_watch(m_inotify.native_handle(), "/dev", WATCH_EVENTS);
+
+        if (wd >= 0)
+        {
+            m_watches[wd] = std::string();
+        }
+
+        return;
+    }
+
+    boost::filesystem::path node(m_device);
+
+    for (boost::filesystem::path directory = node.parent_path(); !directory.empty() && directory != node; directory = directory.parent_path())
+    {
+        const int wd = ::inotify_add_watch(m_inotify.native_handle(), directory.c_str(), WATCH_EVENTS | IN_ONLYDIR);
+
+        if (wd >= 0)
+        {
+            m_watches[wd] = node.filename().string();
+        }
+
+        node = directory;
+    }
+}
+
+
+void DeviceWatcher::waitReadable()
+{
+    std::weak_ptr<DeviceWatcher> weak(shared_from_this());
+
+    m_inotify.async_wait(boost::asio::posix::stream_descriptor::wait_read,
+                         [weak](const boost::system::error_code & error)
+                         {
+                             auto self = weak.lock();
+
+                             if (error || !self || !self->m_running)
+                             {
+                                 return;
+                             }
+
+                             const bool changed = self->readEvents();
+
+                             if (changed)
+                             {
+                                 self->addWatches();
+                             }
+
+                             self->waitReadable();
+
+                             if (changed && self->m_onChange)
+                             {
+                                 self->m_onChange();
+                             }
+                         });
+}
+
+
+/** consumes all queued events, true if one of them concerns a name on the way to the device */
+bool DeviceWatcher::readEvents()
+{
+    alignas(inotify_event) char buffer[4096];
+    bool changed = false;
+
+    for (;;)
+    {
+        const ssize_t length = ::read(m_inotify.native_handle(), buffer, sizeof(buffer));
+
+        if (length <= 0)
+        {
+            // EAGAIN once the queue is empty
+            return changed;
+        }
+
+        for (ssize_t offset = 0; offset < length; )
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(&buffer[offset]);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            const auto watch = m_watches.find(event->wd);
+
+            if (0 != (event->mask & IN_Q_OVERFLOW))
+            {
+                // events were lost, the device may have come or gone
+                changed = true;
+            }
+            else if (m_watches.end() == watch)
+            {
+                continue;
+            }
+            else if (0 != (event->mask & IN_IGNORED))
+            {
+                // the directory itself is gone, watched again once it reappears
+                m_watches.erase(watch);
+                changed = true;
+            }
+            else if (watch->second.empty() || (event->len > 0 && watch->second == event->name))
+            {
+                changed = true;
+            }
+        }
+    }
+}
+
+
+///////////////////////////
+
+bool isUsbDeviceSpec(const std::string & device)
+{
+    return boost::algorithm::starts_with(device, USB_PREFIX);
+}
+
+
+/** first line of a sysfs attribute, empty if missing */
+static std::string readAttribute(const boost::filesystem::path & path)
+{
+    std::ifstream attribute(path.string());
+    std::string value;
+
+    std::getline(attribute, value);
+    boost::algorithm::trim(value);
+
+    return value;
+}
+
+
+/** the usb device (the directory with idVendor/idProduct) above the port of a tty, empty for other ttys */
+static boost::filesystem::path usbDeviceOf(const boost::filesystem::path & tty)
+{
+    boost::system::error_code error;
+    boost::filesystem::path device = boost::filesystem::canonical(tty / "device", error);
+
+    // usb-serial ports sit below the interface, cdc-acm ttys at it; either way the device is a few levels up
+    for (; !error && !device.empty() && device != device.root_path(); device = device.parent_path())
+    {
+        if (boost::filesystem::exists(device / "idVendor", error) && boost::filesystem::exists(device / "idProduct", error))
+        {
+            return device;
+        }
+    }
+
+    return boost::filesystem::path();
+}
+
+
+std::string findUsbDevice(const std::string & spec)
+{
+    // vendor:product[:serial], the serial number may contain colons itself
+    std::vector<std::string> fields;
+    boost::algorithm::split(fields, spec.substr(USB_PREFIX.size()), boost::algorithm::is_any_of(":"));
+
+    if (fields.size() < 2)
+    {
+        return std::string();
+    }
+
+    const std::string vendor = boost::algorithm::to_lower_copy(fields[0]);
+    const std::string product = boost::algorithm::to_lower_copy(fields[1]);
+    const std::string serial = fields.size() > 2 ? spec.substr(USB_PREFIX.size() + fields[0].size() + fields[1].size() + 2) : std::string();
+
+    boost::system::error_code error;
+    std::vector<boost::filesystem::path> ttys;
+
+    for (boost::filesystem::directory_iterator entry("/sys/class/tty", error), end; !error && entry != end; entry.increment(error))
+    {
+        ttys.push_back(entry->path());
+    }
+
+    // ttyACM0 before ttyACM1, so the choice among identical adapters is stable
+    std::sort(ttys.begin(), ttys.end());
+
+    for (const boost::filesystem::path & tty : ttys)
+    {
+        const boost::filesystem::path usb = usbDeviceOf(tty);
+
+        if (!usb.empty() &&
+            vendor == boost::algorithm::to_lower_copy(readAttribute(usb / "idVendor")) &&
+            product == boost::algorithm::to_lower_copy(readAttribute(usb / "idProduct")) &&
+            (serial.empty() || serial == readAttribute(usb / "serial")))
+        {
+            return "/dev/" + tty.filename().string();
+        }
+    }
+
+    return std::string();
+}
@@ -0,0 +1,64 @@
+#ifndef DEVICEWATCHER_H_7C3E91D4_2B58_4F0A_9D6E_A41F85C0B273
+#define DEVICEWATCHER_H_7C3E91D4_2B58_4F0A_9D6E_A41F85C0B273
+
+/**
+ * @file		DeviceWatcher.h
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+#include <boost/asio.hpp>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+
+
+/** reports the arrival and removal of a serial device inside the event loop
+ *
+ *  Watches the directories along the device path with inotify, so a replugged device is
+ *  seen as soon as udev created its node (or link) and set its permissions. The handler
+ *  only learns that something changed, the owner checks for the device itself.
+ */
+class DeviceWatcher : public std::enable_shared_from_this<DeviceWatcher>
+{
+public:
+    /** called on the executor after a batch of events that may concern the device */
+    using ChangeHandler = std::function<void()>;
+
+    /** watches the given device path or, for a usb spec, every node in /dev; nullptr if inotify is not available */
+    static std::shared_ptr<DeviceWatcher> create(const boost::asio::any_io_executor & executor, const std::string & device);
+
+    DeviceWatcher(const boost::asio::any_io_executor & executor, const std::string & device);
+
+    DeviceWatcher(const DeviceWatcher&) = delete;
+    DeviceWatcher& operator=(const DeviceWatcher&) = delete;
+
+    void start(ChangeHandler onChange);
+    void stop();
+
+private:
+    void addWatches();
+    void waitReadable();
+    bool readEvents();
+
+    boost::asio::posix::stream_descriptor m_inotify;
+    std::string   m_device;                       /**< absolute path, empty for a usb spec */
+    std::map<int, std::string> m_watches;         /**< watch descriptor -> name leading to the device, empty for any */
+    bool          m_running = false;
+    ChangeHandler m_onChange;
+};
+
+
+/** true for "usb:VID:PID[:SERIAL]", which selects a usb-serial device by its descriptor instead of its node */
+bool isUsbDeviceSpec(const std::string & device);
+
+/** the tty node of the first plugged usb device matching the spec (e.g. "usb:0403:6001:A50285BI" -> /dev/ttyUSB0),
+ *  empty if there is none; vendor and product ids are hex, the serial number is optional */
+std::string findUsbDevice(const std::string & spec);
+
+#endif /* DEVICEWATCHER_H_7C3E91D4_2B58_4F0A_9D6E_A41F85C0B273 */
@@ -0,0 +1,88 @@
+#ifndef HISTOGRAM_H_5A8D2C61_E04B_4F93_B71A_93C6F0D82E45
+#define HISTOGRAM_H_5A8D2C61_E04B_4F93_B71A_93C6F0D82E45
+
+/**
+ * @file		Histogram.h
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+/** power-of-two histogram: bucket 0 counts zeros, bucket k the values in [2^(k-1), 2^k)
+ *
+ *  Constant size and no allocation, so it can be fed from the data path; percentiles are
+ *  reported as the upper bound of their bucket, precise to a factor of two.
+ */
+class Histogram
+{
+public:
+    static constexpr size_t BUCKETS = 65;
+
+    void add(uint64_t value) noexcept
+    {
+        ++m_counts[bucketOf(value)];
+        ++m_count;
+
+        if (value > m_max)
+        {
+            m_max = value;
+        }
+    }
+
+    uint64_t count() const noexcept { return m_count; }
+    uint64_t max() const noexcept { return m_max; }
+
+    /** upper bound of the bucket holding the given fraction (0..1) of all values, 0 if empty */
+    uint64_t percentile(double fraction) const noexcept
+    {
+        const uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(m_count) + 0.5);
+        uint64_t seen = 0;
+
+        for (size_t bucket = 0; bucket < BUCKETS; ++bucket)
+        {
+            seen += m_counts[bucket];
+
+            if (seen > 0 && seen >= rank)
+            {
+                return upperBound(bucket);
+            }
+        }
+
+        return 0;
+    }
+
+    const std::array<uint64_t, BUCKETS> & buckets() const noexcept { return m_counts; }
+
+    /** largest value counted into the bucket, limited to the largest value seen */
+    uint64_t upperBound(size_t bucket) const noexcept
+    {
+        const uint64_t bound = 0 == bucket ? 0 : (bucket >= 64 ? UINT64_MAX : (uint64_t(1) << bucket) - 1);
+
+        return bound < m_max ? bound : m_max;
+    }
+
+    /** number of significant bits */
+    static size_t bucketOf(uint64_t value) noexcept
+    {
+        size_t bucket = 0;
+
+        for (; value > 0; value >>= 1)
+        {
+            ++bucket;
+        }
+
+        return bucket;
+    }
+
+private:
+    std::array<uint64_t, BUCKETS> m_counts{};
+    uint64_t m_count = 0;
+    uint64_t m_max = 0;
+};
+
+#endif /* HISTOGRAM_H_5A8D2C61_E04B_4F93_B71A_93C6F0D82E45 */
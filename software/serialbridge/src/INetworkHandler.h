@@ -2,6 +2,10 @@
 #define INETWORKHANDLER_H_
 
 #include <cstddef>
+#include <cstdint>
+
+/** identifies a connected client for the lifetime of the server */
+using ClientId = uint32_t;
 
 /** implementers may get notified about network events */
 class INetworkHandler
@@ -9,9 +13,12 @@ class INetworkHandler
 public:
     virtual ~INetworkHandler() {}
 
-    virtual void onNetworkReadComplete(const char* msg, std::size_t length) = 0;
-    virtual void onNetworkClientAccept() = 0;
-    virtual void onNetworkClientDisconnect() = 0;
+    virtual void onNetworkReadComplete(ClientId client, const char* msg, std::size_t length) = 0;
+    virtual void onNetworkClientAccept(ClientId client) = 0;
+    virtual void onNetworkClientDisconnect(ClientId client) = 0;
+
+    /** a client tx queue crossed the high watermark (true) or all queues drained to the low watermark (false) */
+    virtual void onNetworkCongestion(bool congested) = 0;
 };
 
 
@@ -0,0 +1,533 @@
+/**
+ * @file		IoUring.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include "IoUring.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+// liburing is not required, the three system calls are all there is to it
+static int setup(unsigned entries, io_uring_params * params)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int enter(int fd, unsigned submit, unsigned complete, unsigned flags, const void * arg = nullptr, size_t argSize = 0)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, submit, complete, flags, arg, argSize));
+}
+
+static int registerRing(int fd, unsigned opcode, const void * arg, unsigned count)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+template <class T>
+static T* at(void * base, uint32_t offset)
+{
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+
+IoUring::BufferGroup::BufferGroup(IoUring & ring, uint16_t id, size_t bufferSize, size_t bufferCount)
+    : m_ring(ring),
+      m_id(id),
+      m_bufferSize(bufferSize),
+      m_bufferCount(bufferCount),
+      m_memory(bufferSize * bufferCount)
+{
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    m_entriesSize = (bufferCount * sizeof(io_uring_buf) + page - 1) / page * page;
+
+    void * entries = ::mmap(nullptr, m_entriesSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (MAP_FAILED == entries)
+    {
+        throw "Failed to allocate io_uring buffer ring!";
+    }
+
+    m_entries = static_cast<io_uring_buf_ring*>(entries);
+
+    io_uring_buf_reg registration;
+    std::memset(&registration, 0, sizeof(registration));
+    registration.ring_addr = reinterpret_cast<uint64_t>(m_entries);
+    registration.ring_entries = static_cast<uint32_t>(bufferCount);
+    registration.bgid = id;
+
+    if (registerRing(m_ring.m_fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+    {
+        ::munmap(m_entries, m_entriesSize);
+        throw "Failed to register io_uring buffer ring!";
+    }
+
+    for (size_t buffer = 0; buffer < bufferCount; ++buffer)
+    {
+        recycle(static_cast<uint16_t>(buffer));
+    }
+}
+
+
+IoUring::BufferGroup::~BufferGroup()
+{
+    io_uring_buf_reg registration;
+    std::memset(&registration, 0, sizeof(registration));
+    registration.bgid = m_id;
+
+    registerRing(m_ring.m_fd, IORING_UNREGISTER_PBUF_RING, &registration, 1);
+    ::munmap(m_entries, m_entriesSize);
+
+    m_ring.m_freeGroups.push_back(m_id);
+}
+
+
+void IoUring::BufferGroup::recycle(uint16_t buffer)
+{
+    // not m_entries->bufs: the flex array macro of the uapi header puts an empty struct in front of it in C++
+    io_uring_buf & entry = reinterpret_cast<io_uring_buf*>(m_entries)[m_tail & (m_bufferCount - 1)];
+
+    entry.addr = reinterpret_cast<uint64_t>(&m_memory[buffer * m_bufferSize]);
+    entry.len = static_cast<uint32_t>(m_bufferSize);
+    entry.bid = buffer;
+
+    __atomic_store_n(&m_entries->tail, ++m_tail, __ATOMIC_RELEASE);
+}
+
+
+///////////////////////////
+
+
+std::shared_ptr<IoUring> IoUring::create(const boost::asio::any_io_executor & executor, unsigned entries)
+{
+    try
+    {
+        auto ring = std::make_shared<IoUring>(executor, entries);
+
+        // provided buffer rings (5.19) are the oldest feature needed, probe them once
+        if (nullptr == ring->createBufferGroup(64, 2))
+        {
+            throw "Provided buffer rings are not supported!";
+        }
+
+        ring->arm();
+        return ring;
+    }
+    catch (const char* const text)
+    {
+        std::cerr << "io_uring: " << text << " (" << std::strerror(errno) << "), falling back to asio" << std::endl;
+    }
+
+    return nullptr;
+}
+
+
+IoUring::IoUring(const boost::asio::any_io_executor & executor, unsigned entries)
+    : m_executor(executor),
+      m_wakeup(executor)
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+
+    // multishot receives post many completions per submission, so the cq gets more room than the sq
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = 4 * entries;
+
+    m_fd = setup(entries, &params);
+
+    if (m_fd < 0)
+    {
+        throw "io_uring is not available!";
+    }
+
+    try
+    {
+        if (0 == (params.features & IORING_FEAT_SINGLE_MMAP))
+        {
+            throw "Kernel too old for io_uring!";
+        }
+
+        m_ringsSize = std::max<size_t>(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                                       params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        m_rings = ::mmap(nullptr, m_ringsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+
+        if (MAP_FAILED == m_rings)
+        {
+            m_rings = nullptr;
+            throw "Failed to map the io_uring!";
+        }
+
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void * sqes = ::mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+
+        if (MAP_FAILED == sqes)
+        {
+            throw "Failed to map the io_uring!";
+        }
+
+        m_sqes = static_cast<io_uring_sqe*>(sqes);
+        m_sqHead = at<unsigned>(m_rings, params.sq_off.head);
+        m_sqTail = at<unsigned>(m_rings, params.sq_off.tail);
+        m_sqArray = at<unsigned>(m_rings, params.sq_off.array);
+        m_sqMask = *at<unsigned>(m_rings, params.sq_off.ring_mask);
+        m_sqEntries = params.sq_entries;
+        m_cqHead = at<unsigned>(m_rings, params.cq_off.head);
+        m_cqTail = at<unsigned>(m_rings, params.cq_off.tail);
+        m_cqMask = *at<unsigned>(m_rings, params.cq_off.ring_mask);
+        m_cqes = at<io_uring_cqe>(m_rings, params.cq_off.cqes);
+        m_localTail = *m_sqTail;
+
+        const int event = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        if (event < 0)
+        {
+            throw "Failed to create the io_uring eventfd!";
+        }
+
+        m_wakeup.assign(event);
+
+        if (registerRing(m_fd, IORING_REGISTER_EVENTFD, &event, 1) < 0)
+        {
+            throw "Failed to register the io_uring eventfd!";
+        }
+    }
+    catch (...)
+    {
+        release();
+        throw;
+    }
+}
+
+
+IoUring::~IoUring()
+{
+    shutdown();
+    release();
+}
+
+
+void IoUring::release()
+{
+    boost::system::error_code ignored;
+    m_wakeup.close(ignored);
+
+    if (nullptr != m_sqes)
+    {
+        ::munmap(m_sqes, m_sqesSize);
+        m_sqes = nullptr;
+    }
+
+    if (nullptr != m_rings)
+    {
+        ::munmap(m_rings, m_ringsSize);
+        m_rings = nullptr;
+    }
+
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+
+std::shared_ptr<IoUring::BufferGroup> IoUring::createBufferGroup(size_t bufferSize, size_t bufferCount)
+{
+    size_t entries = 1;
+
+    while (entries < bufferCount && entries < 32768)
+    {
+        entries <<= 1;
+    }
+
+    uint16_t id = m_nextGroup;
+
+    if (!m_freeGroups.empty())
+    {
+        id = m_freeGroups.back();
+        m_freeGroups.pop_back();
+    }
+    else
+    {
+        ++m_nextGroup;
+    }
+
+    try
+    {
+        return std::make_shared<BufferGroup>(*this, id, std::max<size_t>(1, bufferSize), entries);
+    }
+    catch (const char* const text)
+    {
+        std::cerr << "io_uring: " << text << std::endl;
+        m_freeGroups.push_back(id);
+    }
+
+    return nullptr;
+}
+
+
+io_uring_sqe* IoUring::acquire()
+{
+    if (m_localTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) >= m_sqEntries)
+    {
+        // the sq is full, hand it to the kernel right away
+        flush();
+
+        if (m_localTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) >= m_sqEntries)
+        {
+            return nullptr;
+        }
+    }
+
+    const unsigned index = m_localTail & m_sqMask;
+    io_uring_sqe * sqe = &m_sqes[index];
+
+    std::memset(sqe, 0, sizeof(io_uring_sqe));
+    m_sqArray[index] = index;
+
+    return sqe;
+}
+
+
+uint64_t IoUring::submit(const Prepare & prepare, Completion completion)
+{
+    if (m_closed)
+    {
+        return 0;
+    }
+
+    io_uring_sqe * sqe = acquire();
+
+    if (nullptr == sqe)
+    {
+        return 0;
+    }
+
+    const uint64_t id = m_nextId++;
+
+    prepare(*sqe);
+    sqe->user_data = id;
+
+    __atomic_store_n(m_sqTail, ++m_localTail, __ATOMIC_RELEASE);
+    ++m_queued;
+
+    m_completions.emplace(id, std::move(completion));
+    scheduleFlush();
+
+    return id;
+}
+
+
+void IoUring::cancel(uint64_t operation)
+{
+    if (m_closed || 0 == operation || 0 == m_completions.count(operation))
+    {
+        return;
+    }
+
+    io_uring_sqe * sqe = acquire();
+
+    if (nullptr != sqe)
+    {
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = operation;
+        sqe->user_data = 0;   // the cancel request itself is not tracked
+
+        __atomic_store_n(m_sqTail, ++m_localTail, __ATOMIC_RELEASE);
+        ++m_queued;
+    }
+
+    // at once, the caller is about to close the descriptor
+    flush();
+}
+
+
+void IoUring::flush()
+{
+    while (m_queued > 0 && m_fd >= 0)
+    {
+        const int submitted = enter(m_fd, m_queued, 0, 0);
+
+        if (submitted < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            // EAGAIN/EBUSY: the kernel is short on resources, try again with the next batch
+            scheduleFlush();
+            return;
+        }
+
+        m_queued -= std::min<unsigned>(m_queued, static_cast<unsigned>(submitted));
+    }
+}
+
+
+void IoUring::scheduleFlush()
+{
+    if (m_draining || m_flushPosted)
+    {
+        return;
+    }
+
+    m_flushPosted = true;
+
+    boost::asio::post(m_executor, [self = shared_from_this()]()
+                      {
+                          self->m_flushPosted = false;
+                          self->flush();
+                      });
+}
+
+
+void IoUring::arm()
+{
+    if (m_armed || m_closed)
+    {
+        return;
+    }
+
+    m_armed = true;
+
+    m_wakeup.async_wait(boost::asio::posix::stream_descriptor::wait_read,
+                        [self = shared_from_this()](const boost::system::error_code & error)
+                        {
+                            self->m_armed = false;
+
+                            if (!error && !self->m_closed)
+                            {
+                                self->drain();
+                            }
+                        });
+
+    // completions posted before the wait was armed raised no edge the reactor could see
+    if (*m_cqHead != __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE))
+    {
+        boost::asio::post(m_executor, [self = shared_from_this()]()
+                          {
+                              if (!self->m_closed)
+                              {
+                                  self->drain();
+                              }
+                          });
+    }
+}
+
+
+void IoUring::drain()
+{
+    uint64_t signalled = 0;
+
+    if (::read(m_wakeup.native_handle(), &signalled, sizeof(signalled)) < 0)
+    {
+        // EAGAIN: nothing signalled since the last drain, the cq is checked anyway
+    }
+
+    m_draining = true;
+    reap();
+    m_draining = false;
+
+    flush();
+    arm();
+}
+
+
+void IoUring::reap()
+{
+    unsigned head = *m_cqHead;
+
+    while (head != __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE))
+    {
+        const io_uring_cqe & cqe = m_cqes[head & m_cqMask];
+        const uint64_t id = cqe.user_data;
+        const int result = cqe.res;
+        const uint32_t flags = cqe.flags;
+
+        __atomic_store_n(m_cqHead, ++head, __ATOMIC_RELEASE);
+
+        auto operation = m_completions.find(id);
+
+        if (operation == m_completions.end())
+        {
+            continue;
+        }
+
+        if (flags & IORING_CQE_F_MORE)
+        {
+            // multishot: the entry stays, the handler may still drop it by shutting the ring down
+            Completion completion = operation->second;
+            completion(result, flags);
+        }
+        else
+        {
+            Completion completion = std::move(operation->second);
+            m_completions.erase(operation);
+            completion(result, flags);
+        }
+
+        if (m_closed)
+        {
+            return;
+        }
+    }
+}
+
+
+void IoUring::shutdown()
+{
+    if (m_closed || m_fd < 0)
+    {
+        return;
+    }
+
+    for (const auto & operation : m_completions)
+    {
+        cancel(operation.first);
+    }
+
+    m_closed = true;
+
+    // the kernel must be done with the buffers of the cancelled operations before they are freed
+    for (int attempt = 0; attempt < 10 && !m_completions.empty(); ++attempt)
+    {
+        __kernel_timespec timeout = { 0, 10 * 1000 * 1000 };
+        io_uring_getevents_arg arg;
+        std::memset(&arg, 0, sizeof(arg));
+        arg.ts = reinterpret_cast<uint64_t>(&timeout);
+
+        enter(m_fd, 0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+
+        unsigned head = *m_cqHead;
+
+        while (head != __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE))
+        {
+            const io_uring_cqe & cqe = m_cqes[head & m_cqMask];
+
+            if (0 == (cqe.flags & IORING_CQE_F_MORE))
+            {
+                m_completions.erase(cqe.user_data);
+            }
+
+            __atomic_store_n(m_cqHead, ++head, __ATOMIC_RELEASE);
+        }
+    }
+
+    // handlers hold the operations' buffers and their owners, dropping them frees both
+    std::map<uint64_t, Completion> dropped;
+    dropped.swap(m_completions);
+    dropped.clear();
+
+    boost::system::error_code ignored;
+    m_wakeup.cancel(ignored);
+}
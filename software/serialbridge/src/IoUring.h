@@ -0,0 +1,132 @@
+#ifndef IOURING_H_6C2E91D4_58A7_4F03_B1E6_D03A7F4C92B8
+#define IOURING_H_6C2E91D4_58A7_4F03_B1E6_D03A7F4C92B8
+
+/**
+ * @file		IoUring.h
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+
+#include <linux/io_uring.h>
+
+
+/** submission and completion ring of one bridge, driven by the asio event loop
+ *
+ *  Completions signal an eventfd the asio reactor waits on, so one wake-up reaps every
+ *  completion that arrived meanwhile, and the submissions queued by their handlers go
+ *  to the kernel within a single io_uring_enter. All calls have to be made on the
+ *  executor the ring was created on (the strand of the bridge).
+ */
+class IoUring : public std::enable_shared_from_this<IoUring>
+{
+public:
+    /** result (bytes or -errno) and cqe flags (buffer id, more completions to come) */
+    using Completion = std::function<void(int result, uint32_t flags)>;
+
+    /** fills the prepared submission entry */
+    using Prepare = std::function<void(io_uring_sqe & sqe)>;
+
+    /** kernel registered pool of receive buffers the kernel picks from (provided buffer ring) */
+    class BufferGroup
+    {
+    public:
+        BufferGroup(IoUring & ring, uint16_t id, size_t bufferSize, size_t bufferCount);
+        ~BufferGroup();
+
+        BufferGroup(const BufferGroup&) = delete;
+        BufferGroup& operator=(const BufferGroup&) = delete;
+
+        uint16_t id() const { return m_id; }
+        size_t bufferSize() const { return m_bufferSize; }
+        const char* data(uint16_t buffer) const { return &m_memory[buffer * m_bufferSize]; }
+
+        /** hands a consumed buffer back to the kernel */
+        void recycle(uint16_t buffer);
+
+    private:
+        IoUring &               m_ring;
+        const uint16_t          m_id;
+        const size_t            m_bufferSize;
+        const size_t            m_bufferCount;   /**< power of two */
+        std::vector<char>       m_memory;
+        struct io_uring_buf_ring* m_entries = nullptr;
+        size_t                  m_entriesSize = 0;
+        uint16_t                m_tail = 0;
+    };
+
+    /** sets up the ring, nullptr if the kernel lacks io_uring or provided buffer rings */
+    static std::shared_ptr<IoUring> create(const boost::asio::any_io_executor & executor, unsigned entries = 256);
+
+    IoUring(const boost::asio::any_io_executor & executor, unsigned entries);
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    const boost::asio::any_io_executor & executor() const { return m_executor; }
+
+    /** queues an operation, submitted with the next batch; returns its id or 0 if the ring is gone */
+    uint64_t submit(const Prepare & prepare, Completion completion);
+
+    /** asks the kernel to stop an operation, it completes with -ECANCELED */
+    void cancel(uint64_t operation);
+
+    /** registers a buffer pool, nullptr if the kernel refuses */
+    std::shared_ptr<BufferGroup> createBufferGroup(size_t bufferSize, size_t bufferCount);
+
+    /** cancels everything and stops waiting for completions, pending handlers are dropped */
+    void shutdown();
+
+private:
+    io_uring_sqe* acquire();
+    void flush();
+    void scheduleFlush();
+    void arm();
+    void drain();
+    void reap();
+    void release();
+
+    boost::asio::any_io_executor           m_executor;
+    int                                    m_fd = -1;
+    boost::asio::posix::stream_descriptor  m_wakeup;      /**< eventfd signalled by the kernel on completions */
+    bool                                   m_armed = false;
+    bool                                   m_flushPosted = false;
+    bool                                   m_draining = false;   /**< submissions are flushed at the end of the drain */
+    bool                                   m_closed = false;
+
+    // rings shared with the kernel
+    void*          m_rings = nullptr;       /**< sq and cq share one mapping */
+    size_t         m_ringsSize = 0;
+    io_uring_sqe*  m_sqes = nullptr;
+    size_t         m_sqesSize = 0;
+    unsigned*      m_sqHead = nullptr;
+    unsigned*      m_sqTail = nullptr;
+    unsigned*      m_sqArray = nullptr;
+    unsigned       m_sqMask = 0;
+    unsigned       m_sqEntries = 0;
+    unsigned*      m_cqHead = nullptr;
+    unsigned*      m_cqTail = nullptr;
+    unsigned       m_cqMask = 0;
+    io_uring_cqe*  m_cqes = nullptr;
+
+    unsigned       m_localTail = 0;     /**< sq tail including entries not yet published */
+    unsigned       m_queued = 0;        /**< entries published to the sq, not yet handed to the kernel */
+    uint64_t       m_nextId = 1;
+    uint16_t       m_nextGroup = 0;
+    std::vector<uint16_t> m_freeGroups;
+
+    std::map<uint64_t, Completion> m_completions;   /**< operations in flight, multishot ones until their last cqe */
+};
+
+#endif /* IOURING_H_6C2E91D4_58A7_4F03_B1E6_D03A7F4C92B8 */
@@ -2,13 +2,17 @@
 #define NETWORK_CONNECTION_H_
 
 #include "INetworkHandler.h"
+#include "ChunkQueue.h"
+#include "NetworkServer.h"
 
 #include <iostream>
 
 #include <string>
 #include <memory>
 
-#include <deque>
+#include <atomic>
+#include <functional>
+#include <utility>
 #include <vector>
 
 #include <boost/bind/bind.hpp>
@@ -18,40 +22,125 @@ using namespace boost::placeholders;
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
 using namespace boost::asio;
 using namespace boost::asio::ip;
 
 
 template <class T> class NetworkConnection;
 template <class T> static bool StartWriting(class NetworkConnection<T> & connection) noexcept;
-template <class T> static void WriteOperationComplete(class NetworkConnection<T> & connection, const boost::system::error_code& oError);
+template <class T> static void WriteOperationComplete(std::shared_ptr<class NetworkConnection<T>> connection, const boost::system::error_code& oError, size_t nBytesSent);
 
 //template <class T> static void ReadOperationComplete(class Connection<T> & connection, const boost::system::error_code& oError, size_t nBytesReceived);
 
 
+/** plain sockets have no handshake, the connection is usable right after the accept */
+template <class Handler>
+void startHandshake(tcp::socket &, Handler handler)
+{
+    handler(boost::system::error_code());
+}
+
+/** the kernel leaves quickack mode on its own, so it has to be requested again after each read */
+inline void rearmQuickAck(tcp::socket::lowest_layer_type & socket)
+{
+#ifdef TCP_QUICKACK
+    const int enable = 1;
+    ::setsockopt(socket.native_handle(), IPPROTO_TCP, TCP_QUICKACK, &enable, sizeof(enable));
+#else
+    (void) socket;
+#endif
+}
+
+inline void closeStream(tcp::socket & socket)
+{
+    boost::system::error_code ignored;
+    socket.shutdown(tcp::socket::shutdown_both, ignored);
+    socket.close(ignored);
+}
+
+/** descriptor a splice pump may take over; only plain sockets carry the raw byte stream */
+inline int spliceHandle(tcp::socket & socket)
+{
+    return socket.native_handle();
+}
+
+template <class Stream>
+int spliceHandle(Stream &)
+{
+    return -1;
+}
+
+
 /** an established network connection between the server and a connected client */
 template <typename SocketType>
 class NetworkConnection : public std::enable_shared_from_this<NetworkConnection<SocketType>>
 {
 public:
-    static constexpr size_t RX_BUF_SIZE = 512;
-
-    std::vector<char>      m_rxBuffer; /**< received data from network */
-    std::deque<char>       m_txBuffer; /**< data for being transmitted via network */
+    static constexpr size_t TX_QUEUE_SIZE = 1024;  /**< chunks queued per client */
+    static constexpr size_t TX_QUEUE_HIGH = TX_QUEUE_SIZE * 3 / 4;  /**< chunks at which the overflow policy applies, like the high watermark */
+    static constexpr size_t TX_QUEUE_LOW = TX_QUEUE_SIZE / 4;       /**< chunks below which a congestion ends, like the low watermark */
+    static constexpr size_t TX_MAX_SEGMENTS = 64;  /**< chunks sent per scatter write */
+
+    /** notifies the owning server that the connection is gone */
+    using CloseHandler = std::function<void(ClientId)>;
+
+    /** notifies the owning server that the tx queue crossed a watermark */
+    using CongestionHandler = std::function<void(ClientId, bool)>;
+
+    using QueueLimits = NetworkServer::QueueLimits;
+    using eOverflowPolicy = NetworkServer::eOverflowPolicy;
+
+    const ClientId         m_id;       /**< identifies the client towards the network handler */
+    std::vector<char>      m_rxBuffer; /**< received data from network, m_rxBufferCount slices of m_rxBufferSize bytes */
+    size_t                 m_rxBufferSize;
+    size_t                 m_rxBufferCount;
+    size_t                 m_rxIndex = 0; /**< slice the pending read fills */
+    ChunkQueue             m_txQueue;  /**< references to the shared chunks being transmitted via network */
     SocketType             m_socket;   /**< network communication socket */
     INetworkHandler* &     m_handler;  /**< network event handler */
-
-    NetworkConnection(SocketType socket, INetworkHandler* & handler)
-        : m_socket(std::move(socket)), m_handler(handler)
+    CloseHandler           m_onClose;
+    CongestionHandler      m_onCongestion;
+    const QueueLimits      m_limits;
+    const std::atomic<bool> & m_rxPaused; /**< reads are not re-armed while the server pauses the network side */
+    bool                   m_rxPending = false;
+    bool                   m_rxSuspended = false; /**< the socket is handed over to a splice pump, reads stay off */
+    bool                   m_rxCancelled = false; /**< the pending read was cancelled for the hand-over */
+    bool                   m_quickAck = false;  /**< acks every received segment immediately (interactive sockets) */
+
+    std::atomic<size_t>    m_txQueuedBytes{ 0 };  /**< bytes referenced by the tx queue, including the pending write */
+    std::atomic<uint64_t>  m_txSentBytes{ 0 };
+    std::atomic<uint64_t>  m_txDroppedBytes{ 0 };
+    std::atomic<bool>      m_txCongested{ false };
+    std::atomic<size_t>    m_txDeferred{ 0 };     /**< chunks waiting for a trim on the executor (DropOldest) */
+    std::atomic<bool>      m_closing{ false };
+
+    std::vector<const_buffer> m_txSegments;           /**< scatter list of the chunks owned by the pending write */
+    size_t                    m_txChunks = 0;         /**< number of chunks at the queue front owned by the pending write */
+    std::atomic<bool>         m_txScheduled{ false }; /**< true while a write is pending or posted */
+
+    NetworkConnection(ClientId id, SocketType socket, INetworkHandler* & handler,
+                      CloseHandler onClose, CongestionHandler onCongestion,
+                      const QueueLimits & limits, const std::atomic<bool> & rxPaused,
+                      size_t rxBufferSize = 512, size_t rxBufferCount = 2)
+        : m_id(id), m_rxBufferSize(rxBufferSize), m_rxBufferCount(rxBufferCount),
+          m_txQueue(TX_QUEUE_SIZE), m_socket(std::move(socket)), m_handler(handler),
+          m_onClose(std::move(onClose)), m_onCongestion(std::move(onCongestion)),
+          m_limits(limits), m_rxPaused(rxPaused)
     {
-        m_rxBuffer.resize(RX_BUF_SIZE);
+        m_rxBuffer.resize(m_rxBufferSize * m_rxBufferCount);
+        m_txSegments.reserve(TX_MAX_SEGMENTS);
     }
 
     void start()
     {
         if (nullptr != m_handler)
         {
-            m_handler->onNetworkClientAccept();
+            m_handler->onNetworkClientAccept(m_id);
         }
 
         read();
@@ -59,35 +148,126 @@ public:
 
     void read()
     {
+        if (m_rxPaused || m_rxSuspended || m_rxPending)
+        {
+            return;
+        }
+
+        m_rxPending = true;
+
         auto self(std::enable_shared_from_this<NetworkConnection<SocketType>>::shared_from_this());
 
-        m_socket.async_read_some(boost::asio::buffer(m_rxBuffer.data(), m_rxBuffer.size()),
+        m_socket.async_read_some(boost::asio::buffer(&m_rxBuffer[m_rxIndex * m_rxBufferSize], m_rxBufferSize),
                                  [this, self](boost::system::error_code error, std::size_t length)
                                  {
+                                     m_rxPending = false;
+
+                                     // cancelled for a splice hand-over: not a disconnect, re-armed unless still suspended
+                                     if (std::exchange(m_rxCancelled, false) && boost::asio::error::operation_aborted == error)
+                                     {
+                                         read();
+                                         return;
+                                     }
+
                                      if (error)
                                      {
-                                         if (boost::asio::error::eof == error ||
-                                             boost::asio::error::connection_reset)
+                                         if (m_txCongested.exchange(false) && m_onCongestion)
+                                         {
+                                             m_onCongestion(m_id, false);
+                                         }
+
+                                         // eof, reset or a socket closed after a failed write: the client is gone
+                                         if (nullptr != m_handler)
                                          {
-                                             if (nullptr != m_handler)
-                                             {
-                                                 m_handler->onNetworkClientDisconnect();
-                                             }
+                                             m_handler->onNetworkClientDisconnect(m_id);
+                                         }
+
+                                         if (m_onClose)
+                                         {
+                                             m_onClose(m_id);
                                          }
                                      }
                                      else
                                      {
-                                         if (nullptr != m_handler)
+                                         const char* received = &m_rxBuffer[m_rxIndex * m_rxBufferSize];
+
+                                         if (m_quickAck)
                                          {
-                                             m_handler->onNetworkReadComplete(m_rxBuffer.data(), length);
+                                             rearmQuickAck(m_socket.lowest_layer());
                                          }
 
+                                         // the next read is pending on a spare slice while this one is handled
+                                         m_rxIndex = (m_rxIndex + 1) % m_rxBufferCount;
                                          read();
+
+                                         if (nullptr != m_handler)
+                                         {
+                                             m_handler->onNetworkReadComplete(m_id, received, length);
+                                         }
                                      }
                                  });
     }
 
 
+    /** re-arms the read after the server stopped pausing the network side */
+    void resume()
+    {
+        read();
+    }
+
+
+    /** stops reading for a hand-over of the socket; returns its descriptor once no read or write
+     *  is in flight anymore, -1 until then or if the stream does not carry the raw bytes */
+    int suspend()
+    {
+        const int handle = spliceHandle(m_socket);
+
+        if (handle < 0)
+        {
+            return -1;
+        }
+
+        m_rxSuspended = true;
+
+        // a pending write would be cut short by the cancel, so its completion is awaited first
+        if (m_rxPending && !m_rxCancelled && !m_txScheduled)
+        {
+            boost::system::error_code ignored;
+            m_rxCancelled = true;
+            m_socket.lowest_layer().cancel(ignored);
+        }
+
+        return (m_rxPending || m_txScheduled || !m_txQueue.empty()) ? -1 : handle;
+    }
+
+
+    /** takes the socket back from a splice pump */
+    void unsuspend()
+    {
+        m_rxSuspended = false;
+        read();
+    }
+
+
+    /** discards the oldest chunks not owned by a pending write down to both low watermarks, runs on the executor */
+    void trim()
+    {
+        size_t count = 0;
+        size_t length = 0;
+
+        while (m_txChunks + count < m_txQueue.size() &&
+               (m_txQueuedBytes - length > m_limits.lowWatermark || m_txQueue.size() - count > TX_QUEUE_LOW))
+        {
+            length += m_txQueue.at(m_txChunks + count)->size();
+            ++count;
+        }
+
+        m_txQueue.erase(m_txChunks, count);
+        m_txQueuedBytes -= length;
+        m_txDroppedBytes += length;
+    }
+
+
     void close(const boost::system::error_code& oError)
     {
         if (oError == boost::asio::error::operation_aborted)
@@ -96,57 +276,124 @@ public:
         }
         else
         {
-            m_socket.shutdown(tcp::socket::shutdown_both);
-            m_socket.close();
+            closeStream(m_socket);
         }
     }
 
 
 
-    void sendChar(const char msg)
+    /** queues a reference to the chunk from the producer thread and kicks the write engine if idle;
+     *  the queued bytes and the occupied chunk slots are both bounded by watermarks */
+    bool send(const SharedChunk & chunk)
     {
-        bool bWriteInProgress = !m_txBuffer.empty();
+        const size_t length = chunk->size();
+        const bool overflow = m_txQueuedBytes.load() + length > m_limits.highWatermark || m_txQueue.size() >= TX_QUEUE_HIGH;
 
-        m_txBuffer.push_back(msg);
-
-        if (!bWriteInProgress)
+        if (overflow || m_txDeferred > 0)
         {
-            StartWriting<SocketType>(*this);
+            switch (m_limits.policy)
+            {
+            case eOverflowPolicy::Disconnect:
+                m_txDroppedBytes += length;
+
+                if (!m_closing.exchange(true))
+                {
+                    auto self(std::enable_shared_from_this<NetworkConnection<SocketType>>::shared_from_this());
+
+                    std::cerr << "Client " << m_id << " too slow, disconnecting" << std::endl;
+                    boost::asio::post(m_socket.get_executor(), [self]() { self->close(boost::system::error_code()); });
+                }
+                return false;
+
+            case eOverflowPolicy::DropOldest:
+            {
+                // the front belongs to the consumer, so the trim runs on the executor: inline on the bridge's strand,
+                // otherwise later chunks queue behind this one to keep the order
+                auto self(std::enable_shared_from_this<NetworkConnection<SocketType>>::shared_from_this());
+
+                ++m_txDeferred;
+                boost::asio::dispatch(m_socket.get_executor(), [self, chunk, overflow]()
+                                      {
+                                          if (overflow)
+                                          {
+                                              self->trim();
+                                          }
+
+                                          self->queue(chunk);
+                                          --self->m_txDeferred;
+                                      });
+                return true;
+            }
+
+            case eOverflowPolicy::PauseSource:
+                if (!m_txCongested.exchange(true) && m_onCongestion)
+                {
+                    m_onCongestion(m_id, true);
+                }
+                break;
+            }
         }
+
+        return queue(chunk);
     }
 
 
-    void sendText(const std::string& msg)
+    /** pushes the chunk, only the producer or a deferred send on the executor calls it */
+    bool queue(const SharedChunk & chunk)
     {
-        if (!msg.empty())
+        const size_t length = chunk->size();
+
+        if (!m_txQueue.push(chunk))
         {
-            bool bWriteInProgress = !m_txBuffer.empty();
+            m_txDroppedBytes += length;
+            return false;
+        }
 
-            std::copy(msg.begin(), msg.end(), std::back_inserter(m_txBuffer));
+        m_txQueuedBytes += length;
 
-            if (!bWriteInProgress)
-            {
-                StartWriting<SocketType>(*this);
-            }
+        if (!m_txScheduled.exchange(true))
+        {
+            auto self(std::enable_shared_from_this<NetworkConnection<SocketType>>::shared_from_this());
+
+            boost::asio::post(m_socket.get_executor(), [self]() { StartWriting<SocketType>(*self); });
         }
+
+        return true;
     }
 };
 
 
 
-/** starts network transmission for a chunk of data to be sent */
+/** starts network transmission of the queued chunks within one scatter write */
 template <class T>
 bool StartWriting(NetworkConnection<T> & connection) noexcept
 {
     try
     {
+        connection.m_txSegments.clear();
+        connection.m_txChunks = connection.m_txQueue.gather(connection.m_txSegments, NetworkConnection<T>::TX_MAX_SEGMENTS);
+
+        if (0 == connection.m_txChunks)
+        {
+            connection.m_txScheduled = false;
+
+            // a producer may have pushed a chunk right before the flag was released
+            if (connection.m_txQueue.empty() || connection.m_txScheduled.exchange(true))
+            {
+                return true;
+            }
+
+            connection.m_txChunks = connection.m_txQueue.gather(connection.m_txSegments, NetworkConnection<T>::TX_MAX_SEGMENTS);
+        }
+
         boost::asio::async_write(connection.m_socket,
-                                 boost::asio::buffer(&connection.m_txBuffer.front(), 1),
-                                 boost::bind(WriteOperationComplete<T>, boost::ref(connection), placeholders::error)
+                                 connection.m_txSegments,
+                                 boost::bind(WriteOperationComplete<T>, connection.shared_from_this(), placeholders::error, placeholders::bytes_transferred)
                                  );
     }
     catch (...)
     {
+        connection.m_txScheduled = false;
         return false;
     }
 
@@ -156,30 +403,33 @@ bool StartWriting(NetworkConnection<T> & connection) noexcept
 
 /** event handler for transmitted data */
 template <class T>
-void WriteOperationComplete(NetworkConnection<T> & connection, const boost::system::error_code& oError)
+void WriteOperationComplete(std::shared_ptr<NetworkConnection<T>> connection, const boost::system::error_code& oError, size_t nBytesSent)
 {
     if (oError)
     {
-        connection.close(oError);
+        connection->m_txScheduled = false;
+        connection->close(oError);
     }
     else
     {
-#if 0 // just for debugging of tx
-        if (m_fnWriteComplete)
-        {
-            m_fnWriteComplete(m_txBuffer.front());
-        }
-#endif
-
-        connection.m_txBuffer.pop_front();
+        connection->m_txQueue.pop(connection->m_txChunks);
+        connection->m_txChunks = 0;
+        connection->m_txQueuedBytes -= nBytesSent;
+        connection->m_txSentBytes += nBytesSent;
 
-        if (!connection.m_txBuffer.empty())
+        if (connection->m_txQueuedBytes <= connection->m_limits.lowWatermark &&
+            connection->m_txQueue.size() <= NetworkConnection<T>::TX_QUEUE_LOW && connection->m_txCongested.exchange(false))
         {
-            if (!StartWriting(connection)) // as soon if smthg was being sent, recheck the tx queue for new data
+            if (connection->m_onCongestion)
             {
-                //ExecuteCloseOperation(oError); //< todo: not sure if still necessary
+                connection->m_onCongestion(connection->m_id, false);
             }
         }
+
+        if (!StartWriting(*connection)) // as soon if smthg was being sent, recheck the tx queue for new data
+        {
+            //ExecuteCloseOperation(oError); //< todo: not sure if still necessary
+        }
     }
 }
 
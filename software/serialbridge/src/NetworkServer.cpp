@@ -10,143 +10,1312 @@
 #include "System.h"
 #include "NetworkServer.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
 #include <deque>
 #include <map>
 #include <iostream>
+#include <random>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
 
 #include "NetworkConnection.h"
+#include "RingBuffer.h"
+#include "ReliableSession.h"
+
+#ifdef SERIALBRIDGE_WITH_TLS
+#include "TlsStream.h"
+#else
+class TlsContext;
+#endif
+
+#ifdef SERIALBRIDGE_WITH_IO_URING
+#include "UringStream.h"
+#endif
+
+template<class Endpoint> Endpoint getDefaultEndpoint(uint16_t port);
+template<> tcp::endpoint getDefaultEndpoint<tcp::endpoint>(uint16_t port) { return tcp::endpoint(tcp::v4(), port); }
+template<> udp::endpoint getDefaultEndpoint<udp::endpoint>(uint16_t port) { return udp::endpoint(udp::v4(), port); }
+
+template <class Endpoint>
+static Endpoint createEndpoint(const std::string & address, uint16_t port)
+{
+    if (address != System::ALL_INTERFACES)
+    {
+        return Endpoint(address::from_string(address), port);
+    }
+    else
+    {
+        return getDefaultEndpoint<Endpoint>(port);
+    }
+}
+
+
+/** turns an accepted tcp socket into the stream type the connections talk through */
+template <class Socket>
+struct SocketFactory
+{
+    static Socket create(tcp::socket socket, TlsContext *, const std::shared_ptr<IoUring> &) { return socket; }
+    static std::string describe(const Socket &) { return std::string(); }
+};
+
+#ifdef SERIALBRIDGE_WITH_TLS
+template <>
+struct SocketFactory<TlsStream>
+{
+    static TlsStream create(tcp::socket socket, TlsContext * context, const std::shared_ptr<IoUring> &) { return TlsStream(std::move(socket), *context); }
+
+    static std::string describe(const TlsStream & stream)
+    {
+        return stream.version() + (stream.isResumed() ? " (resumed)" : "") +
+               ", kTLS tx " + (stream.isKernelSend() ? "on" : "off") +
+               ", rx " + (stream.isKernelReceive() ? "on" : "off");
+    }
+};
+#endif
+
+#ifdef SERIALBRIDGE_WITH_IO_URING
+template <>
+struct SocketFactory<UringSocket>
+{
+    static UringSocket create(tcp::socket socket, TlsContext *, const std::shared_ptr<IoUring> & uring) { return UringSocket(std::move(socket), uring); }
+    static std::string describe(const UringSocket &) { return std::string(); }
+};
+#endif
+
+
+#ifdef __linux__
+/** sets an integer socket option, failures are reported but not fatal */
+static void setOption(tcp::socket & socket, int level, int name, int value, const char* what)
+{
+    if (0 != ::setsockopt(socket.native_handle(), level, name, &value, sizeof(value)))
+    {
+        std::cerr << "Setting " << what << " failed: " << std::strerror(errno) << std::endl;
+    }
+}
+#endif
+
+
+/** configures a freshly accepted tcp socket */
+static void applySocketOptions(tcp::socket & socket, const NetworkServer::SocketOptions & options)
+{
+    boost::system::error_code ignored;
+
+    if (options.noDelay)
+    {
+        socket.set_option(tcp::no_delay(true), ignored);
+    }
+
+    if (options.sendBuffer > 0)
+    {
+        socket.set_option(socket_base::send_buffer_size(options.sendBuffer), ignored);
+    }
+
+    if (options.receiveBuffer > 0)
+    {
+        socket.set_option(socket_base::receive_buffer_size(options.receiveBuffer), ignored);
+    }
+
+    if (options.keepAliveIdle > 0)
+    {
+        socket.set_option(socket_base::keep_alive(true), ignored);
+    }
+
+#ifdef __linux__
+    if (options.quickAck)
+    {
+        setOption(socket, IPPROTO_TCP, TCP_QUICKACK, 1, "TCP_QUICKACK");
+    }
+
+    if (options.keepAliveIdle > 0)
+    {
+        setOption(socket, IPPROTO_TCP, TCP_KEEPIDLE, static_cast<int>(options.keepAliveIdle), "TCP_KEEPIDLE");
+
+        if (options.keepAliveInterval > 0)
+        {
+            setOption(socket, IPPROTO_TCP, TCP_KEEPINTVL, static_cast<int>(options.keepAliveInterval), "TCP_KEEPINTVL");
+        }
+
+        if (options.keepAliveCount > 0)
+        {
+            setOption(socket, IPPROTO_TCP, TCP_KEEPCNT, static_cast<int>(options.keepAliveCount), "TCP_KEEPCNT");
+        }
+    }
+
+    if (options.userTimeoutMillis > 0)
+    {
+        setOption(socket, IPPROTO_TCP, TCP_USER_TIMEOUT, static_cast<int>(options.userTimeoutMillis), "TCP_USER_TIMEOUT");
+    }
+#endif
+}
+
+
+/** strategy pattern for network server type abstraction, pending operations hold a reference to their server */
+struct AbstractServer : std::enable_shared_from_this<AbstractServer>
+{
+    any_io_executor m_executor;  /**< sockets, timers and completions, usually the strand of the bridge */
+    INetworkHandler* m_handler = nullptr;
+    size_t m_rxBufferSize = 512;
+    size_t m_rxBufferCount = 2;
+    NetworkServer::QueueLimits m_limits;
+    NetworkServer::DatagramOptions m_datagram;
+    NetworkServer::SocketOptions m_socketOptions;
+    std::atomic<bool> m_rxPaused{ false };
+    std::atomic<size_t> m_congestedClients{ 0 };
+    bool m_started = false;
+    std::atomic<size_t> m_handles{ 0 }; /**< NetworkServer instances sharing this server */
+
+    explicit AbstractServer(const any_io_executor& executor)
+        : m_executor(executor)
+    {
+    }
+
+    virtual ~AbstractServer() {}
+
+    /** starts accepting or receiving, called once the server is owned by a shared pointer */
+    virtual void start() = 0;
+
+    /** stops listening and closes all clients, so the pending operations release the server */
+    virtual void shutdown() = 0;
+
+    /** queues data for all connected clients, may be called from another thread than the io service */
+    virtual bool send(const char* msg, size_t length) = 0;
+
+    /** queues data for a single client */
+    virtual bool sendTo(ClientId client, const char* msg, size_t length) = 0;
+
+    virtual void close(boost::system::error_code ec) = 0;
+
+    virtual bool isActive() const = 0;
+
+    virtual size_t clientCount() const = 0;
+
+    virtual std::vector<NetworkServer::ClientStatistics> statistics() const = 0;
+
+    /** restarts reading on the clients after pausing ended */
+    virtual void resumeReading() = 0;
+
+    /** hands a client's socket over to a splice pump, see NetworkServer::suspendClient */
+    virtual int suspendClient(ClientId) { return -1; }
+
+    virtual void resumeClient(ClientId) {}
+
+    /** applies changed limits or options, called before the io service runs */
+    virtual void configure() {}
+
+
+    /** aggregates the client watermarks, the handler learns about the first congested and the last drained client */
+    void onClientCongestion(ClientId, bool congested)
+    {
+        const bool changed = congested ? (0 == m_congestedClients++) : (1 == m_congestedClients--);
+
+        if (changed)
+        {
+            boost::asio::post(m_executor, [this, self = shared_from_this(), congested]()
+                             {
+                                 if (nullptr != m_handler)
+                                 {
+                                     m_handler->onNetworkCongestion(congested);
+                                 }
+                             });
+        }
+    }
+
+    void pauseReading(bool pause)
+    {
+        m_rxPaused = pause;
+
+        if (!pause)
+        {
+            resumeReading();
+        }
+    }
+};
+
+
+
+/** connection oriented network server implementation */
+template <class Endpoint, class Socket, class Acceptor>
+struct ConnectionOriented : AbstractServer
+{
+    using Connection = NetworkConnection<Socket>;
+    using Clients = std::vector<std::shared_ptr<Connection>>;
+
+    static constexpr std::chrono::seconds HANDSHAKE_TIMEOUT{ 10 }; /**< a client still negotiating after this is dropped */
+
+    Endpoint               m_endPoint;
+    Acceptor               m_acceptor;
+
+    /** immutable snapshot of the connected clients, replaced on accept or disconnect so senders never lock */
+    std::shared_ptr<const Clients> m_clients;
+    ClientId                       m_nextId = 1;
+    Clients                        m_handshakes; /**< accepted, not yet usable connections, io service only */
+    std::shared_ptr<TlsContext>    m_tls;     /**< only set for tls servers */
+    std::shared_ptr<IoUring>       m_uring;   /**< only set for io_uring servers */
+
+    ConnectionOriented(const any_io_executor & executor, const std::string & address, uint16_t port,
+                       std::shared_ptr<TlsContext> tls = nullptr, std::shared_ptr<IoUring> uring = nullptr)
+        :   AbstractServer(executor),
+            m_endPoint(createEndpoint<Endpoint>(address, port)),
+            m_acceptor(m_executor, m_endPoint),
+            m_clients(std::make_shared<const Clients>()),
+            m_tls(std::move(tls)),
+            m_uring(std::move(uring))
+    {        
+        m_acceptor.listen();
+    }
+
+
+    void start() final
+    {
+        m_started = true;
+        startAccepting();
+    }
+
+
+    void shutdown() final
+    {
+        boost::system::error_code ignored;
+        m_acceptor.close(ignored);
+        close(boost::system::error_code());
+    }
+
+
+    void startAccepting()
+    {
+        m_acceptor.async_accept(
+            [this, self = shared_from_this()](boost::system::error_code ec, tcp::socket socket)
+            {
+                if (ec == boost::asio::error::operation_aborted)
+                {
+                    return;
+                }
+
+                try
+                {
+                    if (!ec)
+                    {
+                        applySocketOptions(socket, m_socketOptions);
+
+                        auto connection = std::make_shared<Connection>(m_nextId++, SocketFactory<Socket>::create(std::move(socket), m_tls.get(), m_uring), m_handler,
+                                                                       [this, self](ClientId id) { this->removeClient(id); },
+                                                                       [this, self](ClientId id, bool congested) { this->onClientCongestion(id, congested); },
+                                                                       m_limits, m_rxPaused,
+                                                                       m_rxBufferSize, m_rxBufferCount);
+                        connection->m_quickAck = m_socketOptions.quickAck;
+
+                        // a client that never completes the handshake would hold its socket forever
+                        auto deadline = std::make_shared<boost::asio::steady_timer>(m_executor, HANDSHAKE_TIMEOUT);
+
+                        deadline->async_wait([connection, deadline](const boost::system::error_code & error)
+                                             {
+                                                 if (!error)
+                                                 {
+                                                     std::cerr << "Client " << connection->m_id << " handshake timed out" << std::endl;
+                                                     connection->close(boost::system::error_code());
+                                                 }
+                                             });
+
+                        m_handshakes.push_back(connection);
+
+                        // the client only becomes visible to senders once the stream is usable
+                        startHandshake(connection->m_socket,
+                                       [this, self, connection, deadline](const boost::system::error_code & error)
+                                       {
+                                           deadline->cancel();
+                                           m_handshakes.erase(std::remove(m_handshakes.begin(), m_handshakes.end(), connection), m_handshakes.end());
+
+                                           if (error)
+                                           {
+                                               std::cerr << "Client " << connection->m_id << " handshake failed: " << error.message() << std::endl;
+                                               connection->close(boost::system::error_code());
+                                               return;
+                                           }
+
+                                           const std::string session = SocketFactory<Socket>::describe(connection->m_socket);
+
+                                           if (!session.empty())
+                                           {
+                                               std::cout << "Client " << connection->m_id << ": " << session << std::endl;
+                                           }
+
+                                           addClient(connection);
+                                           connection->start();
+                                       });
+                    }
+                }
+                catch (const char* const text)
+                {
+                    // the stream could not be set up (e.g. no io_uring buffers left), the socket closes with it
+                    std::cerr << "Client rejected: " << text << std::endl;
+                }
+
+                this->startAccepting();
+            });
+    }
+
+
+    /** accept and disconnect both run on the io service, so the copy-on-write needs no further locking */
+    void addClient(const std::shared_ptr<Connection> & connection)
+    {
+        auto clients = std::make_shared<Clients>(*std::atomic_load(&m_clients));
+        clients->push_back(connection);
+        std::atomic_store(&m_clients, std::shared_ptr<const Clients>(std::move(clients)));
+    }
+
+    void removeClient(ClientId id)
+    {
+        auto clients = std::make_shared<Clients>(*std::atomic_load(&m_clients));
+        clients->erase(std::remove_if(clients->begin(), clients->end(),
+                                      [id](const std::shared_ptr<Connection> & client) { return client->m_id == id; }),
+                       clients->end());
+        std::atomic_store(&m_clients, std::shared_ptr<const Clients>(std::move(clients)));
+    }
+
+
+    bool send(const char* msg, size_t length) final
+    {
+        auto clients = std::atomic_load(&m_clients);
+
+        if (clients->empty())
+        {
+            return false;
+        }
+
+        // one copy per chunk, every client only queues a reference
+        const SharedChunk chunk = makeChunk(msg, length);
+        bool queued = true;
+
+        for (const auto & client : *clients)
+        {
+            queued = client->send(chunk) && queued;
+        }
+
+        return queued;
+    }
+
+
+    bool sendTo(ClientId id, const char* msg, size_t length) final
+    {
+        for (const auto & client : *std::atomic_load(&m_clients))
+        {
+            if (client->m_id == id)
+            {
+                return client->send(makeChunk(msg, length));
+            }
+        }
+
+        return false;
+    }
+
+
+    void close(boost::system::error_code ec) final
+    {
+        for (const auto & client : *std::atomic_load(&m_clients))
+        {
+            client->close(ec);
+        }
+
+        // their handshakes fail with the closed stream and release them
+        for (const auto & client : m_handshakes)
+        {
+            client->close(ec);
+        }
+    }
+
+
+    bool isActive() const final
+    {
+        return !std::atomic_load(&m_clients)->empty();
+    }
+
+
+    size_t clientCount() const final
+    {
+        return std::atomic_load(&m_clients)->size();
+    }
+
+
+    std::vector<NetworkServer::ClientStatistics> statistics() const final
+    {
+        std::vector<NetworkServer::ClientStatistics> result;
+
+        for (const auto & client : *std::atomic_load(&m_clients))
+        {
+            NetworkServer::ClientStatistics stats;
+            stats.client = client->m_id;
+            stats.queuedBytes = client->m_txQueuedBytes;
+            stats.sentBytes = client->m_txSentBytes;
+            stats.droppedBytes = client->m_txDroppedBytes;
+            stats.congested = client->m_txCongested;
+            result.push_back(stats);
+        }
+
+        return result;
+    }
+
+
+    void resumeReading() final
+    {
+        for (const auto & client : *std::atomic_load(&m_clients))
+        {
+            client->resume();
+        }
+    }
+
+
+    int suspendClient(ClientId id) final
+    {
+        for (const auto & client : *std::atomic_load(&m_clients))
+        {
+            if (client->m_id == id)
+            {
+                return client->suspend();
+            }
+        }
+
+        return -1;
+    }
+
+
+    void resumeClient(ClientId id) final
+    {
+        for (const auto & client : *std::atomic_load(&m_clients))
+        {
+            if (client->m_id == id)
+            {
+                client->unsuspend();
+            }
+        }
+    }
+
+};
+
+
+
+/** datagram network server implementation, clients are the peers that sent datagrams recently */
+struct Datagram : AbstractServer
+{
+    static constexpr size_t BATCH_SIZE = 32; /**< datagrams per recvmmsg/sendmmsg call */
+
+    struct Peer
+    {
+        ClientId id = 0;
+        std::chrono::steady_clock::time_point lastSeen;
+        uint64_t sentBytes = 0;
+        uint64_t droppedBytes = 0;
+        std::unique_ptr<ReliableSession> session; /**< sequencing and retransmission in reliable mode */
+        bool congested = false;                   /**< unacknowledged bytes crossed the high watermark */
+        bool closing = false;                     /**< too slow under the Disconnect policy, removed after the flush */
+    };
+
+    udp::endpoint                      m_endPoint;
+    udp::socket                        m_socket;
+    std::map<udp::endpoint, Peer>      m_peers;          /**< io service only */
+    std::atomic<size_t>                m_peerCount{ 0 };
+    ClientId                           m_nextId = 1;
+
+    std::vector<char>                  m_rxBuffer;       /**< BATCH_SIZE slices of the maximum datagram size */
+    std::vector<udp::endpoint>         m_rxPeers;
+    bool                               m_rxPending = false;
+
+    std::unique_ptr<RingBuffer>        m_txBuffer;       /**< coalesced outgoing data, filled by the producer */
+    std::atomic<bool>                  m_txScheduled{ false }; /**< a flush is posted or the coalescing timer runs */
+    std::atomic<bool>                  m_txUrgent{ false };    /**< a full datagram is waiting */
+    std::atomic<size_t>                m_txDeferred{ 0 };      /**< sends waiting for ring space on the io service */
+    boost::asio::steady_timer          m_coalesceTimer;
+    boost::asio::steady_timer          m_expiryTimer;
+    boost::asio::steady_timer          m_retransmitTimer;
+
+    // lossy link simulation for exercising the reliable mode locally
+    std::mt19937                       m_random{ std::random_device()() };
+    std::vector<char>                  m_heldFrame;     /**< datagram delayed behind the next one */
+    udp::endpoint                      m_heldPeer;
+
+    Datagram(const any_io_executor & executor, const std::string & address, uint16_t port)
+        :   AbstractServer(executor),
+            m_endPoint(createEndpoint<udp::endpoint>(address, port)),
+            m_socket(m_executor, m_endPoint),
+            m_coalesceTimer(m_executor),
+            m_expiryTimer(m_executor),
+            m_retransmitTimer(m_executor)
+    {
+        m_socket.non_blocking(true);
+        configure();
+    }
+
+
+    void start() final
+    {
+        m_started = true;
+
+        startReceiving();
+        scheduleExpiry();
+        scheduleRetransmits();
+    }
+
+
+    void shutdown() final
+    {
+        close(boost::system::error_code());
+    }
+
+
+    //// receive path
+
+    void startReceiving()
+    {
+        if (m_rxPaused || m_rxPending)
+        {
+            return;
+        }
+
+        m_rxPending = true;
+
+        m_socket.async_wait(udp::socket::wait_read,
+                            [this, self = shared_from_this()](const boost::system::error_code& error)
+                            {
+                                m_rxPending = false;
+
+                                if (!error)
+                                {
+                                    receiveBatch();
+                                    startReceiving();
+                                }
+                                else if (error != boost::asio::error::operation_aborted)
+                                {
+                                    std::cerr << "UDPServer Error: " << error.message() << std::endl;
+                                }
+                            });
+    }
+
+
+    /** drains all datagrams that are ready, BATCH_SIZE at a time */
+    void receiveBatch()
+    {
+        const size_t maxDatagram = m_datagram.maxDatagramSize;
+
+        if (m_rxBuffer.size() != BATCH_SIZE * maxDatagram)
+        {
+            m_rxBuffer.assign(BATCH_SIZE * maxDatagram, 0);
+            m_rxPeers.resize(BATCH_SIZE);
+        }
+
+        for (;;)
+        {
+            const int received = receiveDatagrams(maxDatagram);
+
+            for (int i = 0; i < received; ++i)
+            {
+                onDatagram(m_rxPeers[i], &m_rxBuffer[i * maxDatagram], m_rxLengths[i]);
+            }
+
+            if (received < static_cast<int>(BATCH_SIZE))
+            {
+                break;
+            }
+        }
+    }
+
+#ifdef __linux__
+    std::array<mmsghdr, BATCH_SIZE>    m_rxMessages;
+    std::array<iovec, BATCH_SIZE>      m_rxVectors;
+    std::array<size_t, BATCH_SIZE>     m_rxLengths;
+
+    /** one recvmmsg call for up to BATCH_SIZE datagrams, returns the number received */
+    int receiveDatagrams(size_t maxDatagram)
+    {
+        for (size_t i = 0; i < BATCH_SIZE; ++i)
+        {
+            m_rxVectors[i] = iovec{ &m_rxBuffer[i * maxDatagram], maxDatagram };
+            m_rxMessages[i] = mmsghdr{};
+            m_rxMessages[i].msg_hdr.msg_name = m_rxPeers[i].data();
+            m_rxMessages[i].msg_hdr.msg_namelen = static_cast<socklen_t>(m_rxPeers[i].capacity());
+            m_rxMessages[i].msg_hdr.msg_iov = &m_rxVectors[i];
+            m_rxMessages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        const int received = ::recvmmsg(m_socket.native_handle(), m_rxMessages.data(), BATCH_SIZE, MSG_DONTWAIT, nullptr);
+
+        for (int i = 0; i < received; ++i)
+        {
+            m_rxPeers[i].resize(m_rxMessages[i].msg_hdr.msg_namelen);
+            m_rxLengths[i] = m_rxMessages[i].msg_len;
+        }
+
+        return std::max(received, 0);
+    }
+#else
+    std::array<size_t, BATCH_SIZE>     m_rxLengths;
+
+    int receiveDatagrams(size_t maxDatagram)
+    {
+        int received = 0;
+        boost::system::error_code error;
+
+        while (received < static_cast<int>(BATCH_SIZE))
+        {
+            m_rxLengths[received] = m_socket.receive_from(boost::asio::buffer(&m_rxBuffer[received * maxDatagram], maxDatagram),
+                                                          m_rxPeers[received], 0, error);
+            if (error)
+            {
+                break;
+            }
+
+            ++received;
+        }
+
+        return received;
+    }
+#endif
+
+
+    void onDatagram(const udp::endpoint & sender, const char* data, size_t length)
+    {
+        if (m_datagram.reliable && (!ReliableSession::isFrame(data, length) || simulateLoss()))
+        {
+            return;
+        }
+
+        auto peer = m_peers.find(sender);
+
+        if (peer == m_peers.end())
+        {
+            peer = m_peers.emplace(sender, Peer()).first;
+            peer->second.id = m_nextId++;
+            m_peerCount = m_peers.size();
+
+            if (m_datagram.reliable)
+            {
+                const ClientId id = peer->second.id;
+
+                peer->second.session.reset(new ReliableSession(
+                    [this, id](const char* payload, size_t size)
+                    {
+                        if (size > 0 && nullptr != m_handler)
+                        {
+                            m_handler->onNetworkReadComplete(id, payload, size);
+                        }
+                    },
+                    [this, sender](const uint8_t* header, size_t headerLength, const SharedChunk & payload)
+                    {
+                        transmitFrame(sender, header, headerLength, payload);
+                    }));
+            }
+
+            if (nullptr != m_handler)
+            {
+                m_handler->onNetworkClientAccept(peer->second.id);
+            }
+        }
+
+        peer->second.lastSeen = std::chrono::steady_clock::now();
+
+        if (peer->second.session)
+        {
+            peer->second.session->receive(data, length, peer->second.lastSeen);
+
+            // acknowledgements shrink the pending bytes, the source may run again below the low watermark
+            if (peer->second.congested && peer->second.session->pendingBytes() <= m_limits.lowWatermark)
+            {
+                peer->second.congested = false;
+                onClientCongestion(peer->second.id, false);
+            }
+        }
+        else if (length > 0 && nullptr != m_handler)
+        {
+            m_handler->onNetworkReadComplete(peer->second.id, data, length);
+        }
+    }
+
+
+    //// reliable mode
+
+    /** retransmission timeouts are checked every 10ms while reliable mode is active */
+    void scheduleRetransmits()
+    {
+        if (!m_datagram.reliable)
+        {
+            return;
+        }
+
+        m_retransmitTimer.expires_after(std::chrono::milliseconds(10));
+        m_retransmitTimer.async_wait([this, self = shared_from_this()](const boost::system::error_code& error)
+                                     {
+                                         if (!error)
+                                         {
+                                             const auto now = std::chrono::steady_clock::now();
+
+                                             for (auto & peer : m_peers)
+                                             {
+                                                 if (peer.second.session)
+                                                 {
+                                                     peer.second.session->poll(now);
+                                                 }
+                                             }
+
+                                             releaseHeldFrame();
+                                             scheduleRetransmits();
+                                         }
+                                     });
+    }
+
+
+    /** payload bytes of a reliable frame, so header and payload fit into one datagram */
+    size_t framePayloadSize() const
+    {
+        return std::max<size_t>(1, m_datagram.maxDatagramSize - std::min(m_datagram.maxDatagramSize, ReliableSession::HEADER_SIZE));
+    }
+
+
+    /** sends the coalesced data to every peer session, one frame per datagram, stored once;
+     *  a session never skips a frame, its pending bytes beyond the high watermark apply the overflow policy */
+    void sendFrames(const RingBuffer::ConstBuffers & regions, size_t length)
+    {
+        const size_t payloadSize = framePayloadSize();
+        const auto now = std::chrono::steady_clock::now();
+
+        for (size_t offset = 0; offset < length; offset += payloadSize)
+        {
+            const size_t size = std::min(payloadSize, length - offset);
+            auto payload = std::make_shared<std::vector<char>>(size);
+            size_t position = 0;
+
+            for (const const_buffer & region : regions)
+            {
+                const size_t begin = std::max(offset, position);
+                const size_t end = std::min(offset + size, position + region.size());
+
+                if (begin < end)
+                {
+                    std::memcpy(payload->data() + (begin - offset), static_cast<const char*>(region.data()) + (begin - position), end - begin);
+                }
+
+                position += region.size();
+            }
+
+            const SharedChunk chunk(std::move(payload));
+
+            for (auto & peer : m_peers)
+            {
+                Peer & client = peer.second;
+
+                if (client.closing)
+                {
+                    continue;
+                }
+
+                if (client.session->pendingBytes() + size > m_limits.highWatermark)
+                {
+                    switch (m_limits.policy)
+                    {
+                    case NetworkServer::eOverflowPolicy::Disconnect:
+                        std::cerr << "Client " << client.id << " too slow, disconnecting" << std::endl;
+                        client.closing = true;
+                        continue;
+
+                    case NetworkServer::eOverflowPolicy::DropOldest:
+                        client.droppedBytes += client.session->discardBacklog(m_limits.lowWatermark);
+                        break;
+
+                    case NetworkServer::eOverflowPolicy::PauseSource:
+                        if (!client.congested)
+                        {
+                            client.congested = true;
+                            onClientCongestion(client.id, true);
+                        }
+                        break;
+                    }
+                }
+
+                client.session->send(chunk, now);
+                client.sentBytes += size;
+            }
+        }
+
+        for (auto peer = m_peers.begin(); peer != m_peers.end(); )
+        {
+            peer = peer->second.closing ? removePeer(peer) : std::next(peer);
+        }
+    }
+
+
+    void transmitFrame(const udp::endpoint & peer, const uint8_t* header, size_t headerLength, const SharedChunk & payload)
+    {
+        const std::array<const_buffer, 2> frame{ boost::asio::buffer(header, headerLength),
+                                                 payload ? boost::asio::buffer(*payload) : const_buffer() };
 
-template<class Endpoint> Endpoint getDefaultEndpoint(uint16_t port);
-template<> tcp::endpoint getDefaultEndpoint<tcp::endpoint>(uint16_t port) { return tcp::endpoint(tcp::v4(), port); }
-template<> udp::endpoint getDefaultEndpoint<udp::endpoint>(uint16_t port) { return udp::endpoint(udp::v4(), port); }
+        if (simulateLoss())
+        {
+            return;
+        }
 
-template <class Endpoint>
-static Endpoint createEndpoint(const std::string & address, uint16_t port)
-{
-    if (address != System::ALL_INTERFACES)
+        if (m_heldFrame.empty() && m_datagram.simReorderPercent > 0 &&
+            std::uniform_int_distribution<uint32_t>(0, 99)(m_random) < m_datagram.simReorderPercent)
+        {
+            // held back until the next datagram went out, so the peer sees both swapped
+            m_heldFrame.resize(boost::asio::buffer_size(frame));
+            boost::asio::buffer_copy(boost::asio::buffer(m_heldFrame), frame);
+            m_heldPeer = peer;
+            return;
+        }
+
+        boost::system::error_code ignored;
+        m_socket.send_to(frame, peer, 0, ignored);
+
+        releaseHeldFrame();
+    }
+
+
+    void releaseHeldFrame()
     {
-        return Endpoint(address::from_string(address), port);
+        if (!m_heldFrame.empty())
+        {
+            boost::system::error_code ignored;
+            m_socket.send_to(boost::asio::buffer(m_heldFrame), m_heldPeer, 0, ignored);
+            m_heldFrame.clear();
+        }
     }
-    else
+
+
+    bool simulateLoss()
     {
-        return getDefaultEndpoint<Endpoint>(port);
+        return m_datagram.simLossPercent > 0 &&
+               std::uniform_int_distribution<uint32_t>(0, 99)(m_random) < m_datagram.simLossPercent;
     }
-}
 
 
-/** strategy pattern for network server type abstraction */
-struct AbstractServer
-{
-    io_service& m_ioService;
-    INetworkHandler* m_handler = nullptr;
+    /** peers are forgotten when they stayed silent for the configured timeout */
+    void scheduleExpiry()
+    {
+        m_expiryTimer.expires_after(std::chrono::seconds(1));
+        m_expiryTimer.async_wait([this, self = shared_from_this()](const boost::system::error_code& error)
+                                 {
+                                     if (!error)
+                                     {
+                                         expirePeers();
+                                         scheduleExpiry();
+                                     }
+                                 });
+    }
 
-    AbstractServer()
-        : m_ioService(System::IOService())
+    void expirePeers()
     {
+        const auto deadline = std::chrono::steady_clock::now() - std::chrono::seconds(m_datagram.peerTimeoutSeconds);
+
+        for (auto peer = m_peers.begin(); peer != m_peers.end(); )
+        {
+            peer = (peer->second.lastSeen < deadline) ? removePeer(peer) : std::next(peer);
+        }
     }
 
-    virtual ~AbstractServer() {}
+    /** forgets the peer and its session, a congestion it caused ends with it */
+    std::map<udp::endpoint, Peer>::iterator removePeer(std::map<udp::endpoint, Peer>::iterator peer)
+    {
+        const ClientId id = peer->second.id;
 
-    virtual void sendChar(const char msg) = 0;
+        if (peer->second.congested)
+        {
+            onClientCongestion(id, false);
+        }
 
-    virtual void sendText(const std::string& msg) = 0;
+        peer = m_peers.erase(peer);
+        m_peerCount = m_peers.size();
 
-    virtual void close(boost::system::error_code ec) = 0;
+        if (nullptr != m_handler)
+        {
+            m_handler->onNetworkClientDisconnect(id);
+        }
 
-    virtual bool isActive() const = 0;
-};
+        return peer;
+    }
 
 
+    //// transmit path
 
-/** connection oriented network server implementation */
-template <class Endpoint, class Socket, class Acceptor>
-struct ConnectionOriented : AbstractServer
-{
-    Endpoint               m_endPoint;
-    Acceptor               m_acceptor;
+    bool send(const char* msg, size_t length) final
+    {
+        if (0 == m_peerCount)
+        {
+            return false;
+        }
 
-    std::shared_ptr<NetworkConnection<Socket>> m_connection;
+        if (nullptr == m_txBuffer)
+        {
+            return false;
+        }
 
-    ConnectionOriented(const std::string & address, uint16_t port, const std::string & sslCert)
-        :   m_endPoint(createEndpoint<Endpoint>(address, port)),
-            m_acceptor(m_ioService, m_endPoint)
-    {        
-        m_acceptor.listen();
+        // what does not fit into the ring is queued behind a flush on the io service, inline when called there;
+        // later data waits behind it, so nothing is truncated or reordered
+        if (m_txDeferred > 0 || m_txBuffer->space() < length)
+        {
+            ++m_txDeferred;
+            boost::asio::dispatch(m_executor, [this, self = shared_from_this(), data = std::string(msg, length)]()
+                                  {
+                                      for (size_t queued = 0; queued < data.size(); )
+                                      {
+                                          queued += m_txBuffer->write(data.data() + queued, data.size() - queued);
 
-        this->startAccepting();
+                                          if (queued < data.size())
+                                          {
+                                              flush();
+                                          }
+                                      }
+
+                                      --m_txDeferred;
+                                      scheduleFlush();
+                                  });
+            return true;
+        }
+
+        m_txBuffer->write(msg, length);
+        scheduleFlush();
+
+        return true;
     }
 
 
-    void startAccepting()
+    /** a full datagram goes out right away, a partial one after the coalescing window */
+    void scheduleFlush()
     {
-        m_acceptor.async_accept(
-            [this](boost::system::error_code ec, Socket socket)
+        if (m_txBuffer->size() >= m_datagram.maxDatagramSize && !m_txUrgent.exchange(true))
+        {
+            boost::asio::post(m_executor, [this, self = shared_from_this()]() { flush(); });
+        }
+        else if (!m_txScheduled.exchange(true))
+        {
+            boost::asio::post(m_executor, [this, self = shared_from_this()]() { startCoalescing(); });
+        }
+    }
+
+
+    /** waits for the coalescing window before sending a partial datagram */
+    void startCoalescing()
+    {
+        if (0 == m_datagram.coalesceMicros)
+        {
+            flush();
+            return;
+        }
+
+        m_coalesceTimer.expires_after(std::chrono::microseconds(m_datagram.coalesceMicros));
+        m_coalesceTimer.async_wait([this, self = shared_from_this()](const boost::system::error_code& error)
+                                   {
+                                       if (!error)
+                                       {
+                                           flush();
+                                       }
+                                   });
+    }
+
+
+    /** sends everything coalesced so far to all peers, split into datagrams */
+    void flush()
+    {
+        m_txUrgent = false;
+        m_txScheduled = false;
+        m_coalesceTimer.cancel();
+
+        const RingBuffer::ConstBuffers regions = m_txBuffer->data();
+        const size_t length = boost::asio::buffer_size(regions);
+
+        if (length > 0)
+        {
+            if (m_datagram.reliable)
+            {
+                sendFrames(regions, length);
+            }
+            else
+            {
+                sendDatagrams(regions, length);
+            }
+
+            m_txBuffer->consume(length);
+        }
+
+        // data committed while flushing is picked up by another round
+        if (!m_txBuffer->empty() && !m_txScheduled.exchange(true))
+        {
+            startCoalescing();
+        }
+    }
+
+#ifdef __linux__
+    std::array<mmsghdr, BATCH_SIZE>    m_txMessages;
+    std::array<iovec, 2 * BATCH_SIZE>  m_txVectors;
+
+    void sendDatagrams(const RingBuffer::ConstBuffers & regions, size_t length)
+    {
+        size_t count = 0;
+
+        for (auto & peer : m_peers)
+        {
+            for (size_t offset = 0; offset < length; offset += m_datagram.maxDatagramSize)
+            {
+                const size_t size = std::min(m_datagram.maxDatagramSize, length - offset);
+
+                // a datagram may span the wrap-around of the ring, so it gets up to two vectors
+                size_t vectors = 0;
+                size_t position = 0;
+
+                for (const const_buffer & region : regions)
+                {
+                    const size_t begin = std::max(offset, position);
+                    const size_t end = std::min(offset + size, position + region.size());
+
+                    if (begin < end)
+                    {
+                        m_txVectors[2 * count + vectors++] = iovec{ const_cast<char*>(static_cast<const char*>(region.data())) + (begin - position), end - begin };
+                    }
+
+                    position += region.size();
+                }
+
+                m_txMessages[count] = mmsghdr{};
+                m_txMessages[count].msg_hdr.msg_name = const_cast<sockaddr*>(peer.first.data());
+                m_txMessages[count].msg_hdr.msg_namelen = static_cast<socklen_t>(peer.first.size());
+                m_txMessages[count].msg_hdr.msg_iov = &m_txVectors[2 * count];
+                m_txMessages[count].msg_hdr.msg_iovlen = vectors;
+                peer.second.sentBytes += size;
+
+                if (++count == BATCH_SIZE)
+                {
+                    sendBatch(count);
+                    count = 0;
+                }
+            }
+        }
+
+        sendBatch(count);
+    }
+
+    /** datagrams that do not fit into the socket buffer are dropped, the transport is unreliable anyway */
+    void sendBatch(size_t count)
+    {
+        size_t sent = 0;
+
+        while (sent < count)
+        {
+            const int result = ::sendmmsg(m_socket.native_handle(), &m_txMessages[sent], static_cast<unsigned int>(count - sent), MSG_DONTWAIT);
+
+            if (result <= 0)
             {
-                if (!ec)
+                break;
+            }
+
+            sent += static_cast<size_t>(result);
+        }
+
+        for (size_t i = sent; i < count; ++i)
+        {
+            countDropped(m_txMessages[i]);
+        }
+    }
+
+    void countDropped(const mmsghdr & message)
+    {
+        for (auto & peer : m_peers)
+        {
+            if (peer.first.data() == message.msg_hdr.msg_name)
+            {
+                for (size_t i = 0; i < message.msg_hdr.msg_iovlen; ++i)
                 {
-                    m_connection = std::make_shared<NetworkConnection<Socket>>(std::move(socket), m_handler);
-                    m_connection->start();
+                    peer.second.sentBytes -= message.msg_hdr.msg_iov[i].iov_len;
+                    peer.second.droppedBytes += message.msg_hdr.msg_iov[i].iov_len;
                 }
+            }
+        }
+    }
+#else
+    void sendDatagrams(const RingBuffer::ConstBuffers & regions, size_t length)
+    {
+        std::vector<char> datagram(length);
+        boost::asio::buffer_copy(boost::asio::buffer(datagram), regions);
 
-                this->startAccepting();
-            });
+        for (auto & peer : m_peers)
+        {
+            for (size_t offset = 0; offset < length; offset += m_datagram.maxDatagramSize)
+            {
+                const size_t size = std::min(m_datagram.maxDatagramSize, length - offset);
+                boost::system::error_code error;
+
+                m_socket.send_to(boost::asio::buffer(&datagram[offset], size), peer.first, 0, error);
+                (error ? peer.second.droppedBytes : peer.second.sentBytes) += size;
+            }
+        }
     }
+#endif
+
 
-    void sendChar(const char msg) final
+    bool sendTo(ClientId id, const char* msg, size_t length) final
     {
-        if (nullptr != m_connection)
+        for (auto & peer : m_peers)
         {
-            m_connection->sendChar(msg);
+            if (peer.second.id == id && peer.second.session)
+            {
+                const size_t payloadSize = framePayloadSize();
+                const auto now = std::chrono::steady_clock::now();
+
+                for (size_t offset = 0; offset < length; offset += payloadSize)
+                {
+                    const size_t size = std::min(payloadSize, length - offset);
+
+                    peer.second.session->send(makeChunk(msg + offset, size), now);
+                    peer.second.sentBytes += size;
+                }
+
+                return true;
+            }
+            else if (peer.second.id == id)
+            {
+                bool sent = true;
+
+                // e.g. a history replay, split like the live data since a datagram beyond the limit would be truncated
+                for (size_t offset = 0; offset < length; offset += m_datagram.maxDatagramSize)
+                {
+                    const size_t size = std::min(m_datagram.maxDatagramSize, length - offset);
+                    boost::system::error_code error;
+
+                    m_socket.send_to(boost::asio::buffer(msg + offset, size), peer.first, 0, error);
+                    (error ? peer.second.droppedBytes : peer.second.sentBytes) += size;
+                    sent = sent && !error;
+                }
+
+                return sent;
+            }
         }
 
+        return false;
     }
 
-    void sendText(const std::string& msg) final
+
+    void configure() final
     {
-        if (nullptr != m_connection)
+        // the coalescing ring is bounded by the high watermark, a send beyond its space flushes first
+        m_txBuffer.reset(new RingBuffer(std::max(m_limits.highWatermark, 2 * m_datagram.maxDatagramSize)));
+
+        m_retransmitTimer.cancel();
+
+        if (m_started)
         {
-            m_connection->sendText(msg);
+            scheduleRetransmits();
         }
     }
 
 
     void close(boost::system::error_code ec) final
     {
-        if (nullptr != m_connection)
+        if (ec != boost::asio::error::operation_aborted)
         {
-            m_connection->close(ec);
-            m_connection.reset();
+            boost::system::error_code ignored;
+            m_coalesceTimer.cancel(ignored);
+            m_expiryTimer.cancel(ignored);
+            m_retransmitTimer.cancel(ignored);
+            m_socket.close(ignored);
         }
     }
 
 
     bool isActive() const final
     {
-        return m_connection != nullptr;
+        return m_peerCount > 0;
+    }
+
+
+    size_t clientCount() const final
+    {
+        return m_peerCount;
+    }
+
+
+    /** reads the peer table, so only to be called on the io service */
+    std::vector<NetworkServer::ClientStatistics> statistics() const final
+    {
+        std::vector<NetworkServer::ClientStatistics> result;
+
+        for (const auto & peer : m_peers)
+        {
+            NetworkServer::ClientStatistics stats;
+            stats.client = peer.second.id;
+            stats.queuedBytes = m_txBuffer ? m_txBuffer->size() : 0;
+            stats.sentBytes = peer.second.sentBytes;
+            stats.droppedBytes = peer.second.droppedBytes;
+
+            stats.congested = peer.second.congested;
+
+            if (peer.second.session)
+            {
+                stats.queuedBytes = peer.second.session->pendingBytes();
+                stats.retransmissions = peer.second.session->retransmissions();
+                stats.duplicates = peer.second.session->duplicates();
+            }
+
+            result.push_back(stats);
+        }
+
+        return result;
     }
 
+
+    void resumeReading() final
+    {
+        startReceiving();
+    }
 };
 
 
 
 ///////////
 
-NetworkServer::NetworkServer(const std::string& address, uint16_t port, eTransport protocol, const std::string & sslCert)
+NetworkServer::NetworkServer(const std::string& address, uint16_t port, eTransport protocol, const std::string & sslCert, const std::string & sslKey)
+    : NetworkServer(System::IOService().get_executor(), address, port, protocol, sslCert, sslKey)
+{
+}
+
+
+NetworkServer::NetworkServer(const any_io_executor& executor, const std::string& address, uint16_t port, eTransport protocol,
+                             const std::string & sslCert, const std::string & sslKey, const std::shared_ptr<IoUring> & uring)
 {
     try
     {
         switch (protocol)
         {
         case eTransport::TcpV4:
-            m_private = std::shared_ptr<AbstractServer>(new ConnectionOriented<tcp::endpoint, tcp::socket, tcp::acceptor>(address, port, sslCert));
+            if (sslCert.empty())
+            {
+#ifdef SERIALBRIDGE_WITH_IO_URING
+                if (nullptr != uring)
+                {
+                    m_private = std::shared_ptr<AbstractServer>(new ConnectionOriented<tcp::endpoint, UringSocket, tcp::acceptor>(executor, address, port, nullptr, uring));
+                    break;
+                }
+#endif
+                m_private = std::shared_ptr<AbstractServer>(new ConnectionOriented<tcp::endpoint, tcp::socket, tcp::acceptor>(executor, address, port));
+            }
+            else
+            {
+#ifdef SERIALBRIDGE_WITH_TLS
+                auto tls = std::make_shared<TlsContext>(sslCert, sslKey);
+                m_private = std::shared_ptr<AbstractServer>(new ConnectionOriented<tcp::endpoint, TlsStream, tcp::acceptor>(executor, address, port, tls));
+#else
+                std::cerr << "TLS requested, but SerialBridge was built without OpenSSL" << std::endl;
+                throw std::runtime_error("tls not available");
+#endif
+            }
             break;
         case eTransport::UdpV4:
-            std::cerr << "UDP not implemented yet" << std::endl;
-            throw;
-            //m_private = std::shared_ptr<AbstractServer>(new NetworkServer_Impl<udp::endpoint, udp::socket, udp::acceptor>(address, port, sslCert));
+            m_private = std::shared_ptr<AbstractServer>(new Datagram(executor, address, port));
             break;
         }
-        
+
+        m_private->m_handles = 1;
+        m_private->start();
     }
     catch (...)
     {
@@ -158,6 +1327,18 @@ NetworkServer::NetworkServer(const std::string& address, uint16_t port, eTranspo
 NetworkServer::NetworkServer(const NetworkServer& rhs)
     : m_private(rhs.m_private)
 {
+    ++m_private->m_handles;
+}
+
+
+/** the last handle stops the server, which is released with its last pending operation */
+static void releaseHandle(const std::shared_ptr<AbstractServer> & server)
+{
+    if (nullptr != server && 0 == --server->m_handles)
+    {
+        // inline when released on the server's strand, so the port is free again right away
+        boost::asio::dispatch(server->m_executor, boost::bind(&AbstractServer::shutdown, server));
+    }
 }
 
 
@@ -166,7 +1347,7 @@ NetworkServer::~NetworkServer() noexcept
 {
     try
     {
-        this->close();
+        releaseHandle(m_private);
         m_private.reset();
     }
     catch (...)
@@ -178,6 +1359,8 @@ NetworkServer& NetworkServer::operator=(const NetworkServer& rhs)
 {
     if (this != &rhs)
     {
+        ++rhs.m_private->m_handles;
+        releaseHandle(this->m_private);
         this->m_private = rhs.m_private;
     }
     return *this;
@@ -190,18 +1373,88 @@ void NetworkServer::setHandler(INetworkHandler* const handler)
 }
 
 
+void NetworkServer::setReceiveBuffers(size_t bufferSize, size_t bufferCount)
+{
+    m_private->m_rxBufferSize = std::max<size_t>(1, bufferSize);
+    m_private->m_rxBufferCount = std::max<size_t>(2, bufferCount);
+}
+
+
+void NetworkServer::setQueueLimits(const QueueLimits& limits)
+{
+    m_private->m_limits = limits;
+    m_private->m_limits.highWatermark = std::max<size_t>(1, limits.highWatermark);
+    m_private->m_limits.lowWatermark = std::min(limits.lowWatermark, m_private->m_limits.highWatermark);
+    m_private->configure();
+}
+
+
+void NetworkServer::setDatagramOptions(const DatagramOptions& options)
+{
+    m_private->m_datagram = options;
+    m_private->m_datagram.maxDatagramSize = std::max<size_t>(1, std::min<size_t>(options.maxDatagramSize, 65507));
+    m_private->configure();
+}
+
+
+NetworkServer::SocketOptions NetworkServer::SocketOptions::forProfile(eSocketProfile profile)
+{
+    SocketOptions options;
+    options.profile = profile;
+
+    switch (profile)
+    {
+    case eSocketProfile::Interactive:
+        // keystrokes and prompts go out at once, a vanished peer is noticed within about 20s
+        options.noDelay = true;
+        options.quickAck = true;
+        options.keepAliveIdle = 10;
+        options.keepAliveInterval = 3;
+        options.keepAliveCount = 3;
+        options.userTimeoutMillis = 20000;
+        break;
+
+    case eSocketProfile::Bulk:
+        options.sendBuffer = 1024 * 1024;
+        options.receiveBuffer = 1024 * 1024;
+        options.keepAliveIdle = 60;
+        options.keepAliveInterval = 10;
+        options.keepAliveCount = 6;
+        options.userTimeoutMillis = 120000;
+        break;
+
+    case eSocketProfile::System:
+    case eSocketProfile::Custom:
+        break;
+    }
+
+    return options;
+}
+
+
+void NetworkServer::setSocketOptions(const SocketOptions& options)
+{
+    m_private->m_socketOptions = options;
+}
+
+
+void NetworkServer::pauseReading(bool pause)
+{
+    boost::asio::post(m_private->m_executor, boost::bind(&AbstractServer::pauseReading, m_private, pause));
+}
+
+
 bool NetworkServer::send(const char cMsg) noexcept
 {
 	try
     {
-        m_private->m_ioService.post(boost::bind(&AbstractServer::sendChar, m_private.get(), cMsg));
+        return m_private->send(&cMsg, 1);
 	}
 	catch (...)
 	{
-		return false;
 	}
 
-	return true;
+	return false;
 }
 
 
@@ -209,28 +1462,58 @@ bool NetworkServer::send(const std::string& text)
 {
     try
     {
-        m_private->m_ioService.post(boost::bind(&AbstractServer::sendText,
-            m_private.get(),
-            text));
+        return m_private->send(text.data(), text.size());
+    }
+    catch (...)
+    {
+    }
+
+    return false;
+}
+
+
+bool NetworkServer::send(const uint8_t* const data, size_t length)
+{
+    try
+    {
+        if (nullptr != data)
+        {
+            return m_private->send(reinterpret_cast<const char*>(data), length);
+        }
     }
     catch (...)
     {
-        return false;
     }
 
-    return true;
+    return false;
 }
 
 
 
+bool NetworkServer::sendTo(ClientId client, const uint8_t* const data, size_t length)
+{
+    try
+    {
+        if (nullptr != data)
+        {
+            return m_private->sendTo(client, reinterpret_cast<const char*>(data), length);
+        }
+    }
+    catch (...)
+    {
+    }
+
+    return false;
+}
+
 
 
 bool NetworkServer::close() noexcept
 {
 	try
     {
-        m_private->m_ioService.post(boost::bind(&AbstractServer::close,
-			m_private.get(),
+        boost::asio::post(m_private->m_executor, boost::bind(&AbstractServer::close,
+			m_private,
 			boost::system::error_code()));
 	}
 	catch (...)
@@ -248,5 +1531,29 @@ bool NetworkServer::isActive() const
 }
 
 
+size_t NetworkServer::clientCount() const
+{
+    return m_private->clientCount();
+}
+
+
+std::vector<NetworkServer::ClientStatistics> NetworkServer::statistics() const
+{
+    return m_private->statistics();
+}
+
+
+int NetworkServer::suspendClient(ClientId client)
+{
+    return m_private->suspendClient(client);
+}
+
+
+void NetworkServer::resumeClient(ClientId client)
+{
+    m_private->resumeClient(client);
+}
+
+
 
 
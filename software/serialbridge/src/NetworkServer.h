@@ -9,6 +9,11 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+
+#include <boost/asio/any_io_executor.hpp>
+
+#include "INetworkHandler.h"
 
 
 /** */
@@ -24,9 +29,80 @@ public:
 		UdpV4 = 2
 	};
 
+	/** reaction on a client whose tx queue exceeds the high watermark */
+	enum class eOverflowPolicy : uint8_t
+	{
+		PauseSource = 0, /**< report congestion until the queue fell below the low watermark (pauses the serial reader) */
+		DropOldest = 1,  /**< discard the oldest queued data down to the low watermark */
+		Disconnect = 2   /**< drop the slow client */
+	};
+
+	/** bounds of each client's tx queue */
+	struct QueueLimits
+	{
+		size_t highWatermark = 256 * 1024; /**< bytes */
+		size_t lowWatermark = 64 * 1024;   /**< bytes */
+		eOverflowPolicy policy = eOverflowPolicy::PauseSource;
+	};
+
+	/** datagram transport settings */
+	struct DatagramOptions
+	{
+		size_t   maxDatagramSize = 1472;    /**< payload bytes per datagram (ethernet MTU minus IPv4/UDP headers) */
+		uint32_t coalesceMicros = 1000;     /**< window for collecting data into a datagram, 0 sends immediately */
+		uint32_t peerTimeoutSeconds = 60;   /**< peers silent for this long are dropped */
+		bool     reliable = false;          /**< sequenced, acknowledged and retransmitted frames (ReliableSession) */
+		uint32_t simLossPercent = 0;        /**< simulated datagram loss in both directions, for testing */
+		uint32_t simReorderPercent = 0;     /**< simulated reordering of outgoing datagrams, for testing */
+	};
+
+	/** socket option presets for accepted tcp connections */
+	enum class eSocketProfile : uint8_t
+	{
+		System = 0,      /**< operating system defaults */
+		Interactive = 1, /**< no Nagle, no delayed acks, fast dead peer detection (consoles) */
+		Bulk = 2,        /**< 1 MiB socket buffers, patient dead peer detection (log streaming, firmware upload) */
+		Custom = 3       /**< system defaults plus the explicitly given options, the only profile taking them */
+	};
 
-    /** creates a tcp server listening on the given socket */
-    NetworkServer(const std::string& address, uint16_t port, eTransport protocol, const std::string & sslCert);
+	/** tcp socket options, applied at accept time; zero keeps the system default */
+	struct SocketOptions
+	{
+		eSocketProfile profile = eSocketProfile::System;
+		bool     noDelay = false;           /**< TCP_NODELAY */
+		bool     quickAck = false;          /**< TCP_QUICKACK, re-armed after every read since the kernel clears it (linux) */
+		int      sendBuffer = 0;            /**< SO_SNDBUF bytes, disables the kernel's autotuning */
+		int      receiveBuffer = 0;         /**< SO_RCVBUF bytes, disables the kernel's autotuning */
+		uint32_t keepAliveIdle = 0;         /**< seconds of silence before probing, 0 disables keepalive */
+		uint32_t keepAliveInterval = 0;     /**< seconds between probes */
+		uint32_t keepAliveCount = 0;        /**< unanswered probes until the peer is considered dead */
+		uint32_t userTimeoutMillis = 0;     /**< TCP_USER_TIMEOUT, aborts when sent data stays unacknowledged that long */
+
+		/** the preset of the given profile */
+		static SocketOptions forProfile(eSocketProfile profile);
+	};
+
+	/** snapshot of a client's tx queue */
+	struct ClientStatistics
+	{
+		ClientId client = 0;
+		size_t   queuedBytes = 0;
+		uint64_t sentBytes = 0;
+		uint64_t droppedBytes = 0;
+		uint64_t retransmissions = 0; /**< reliable datagram mode only */
+		uint64_t duplicates = 0;      /**< reliable datagram mode only */
+		bool     congested = false;
+	};
+
+
+    /** creates a server listening on the given socket, tcp connections use tls if a certificate is given
+     *  (sslKey may stay empty if the key is part of the certificate file) */
+    NetworkServer(const std::string& address, uint16_t port, eTransport protocol, const std::string & sslCert, const std::string & sslKey = "");
+
+    /** same, with sockets, timers and completions on the given executor (e.g. the strand of a bridge);
+     *  plain tcp clients transfer through the io_uring if one is given (it has to run on the same executor) */
+    NetworkServer(const boost::asio::any_io_executor& executor, const std::string& address, uint16_t port, eTransport protocol,
+                  const std::string & sslCert, const std::string & sslKey = "", const std::shared_ptr<class IoUring> & uring = nullptr);
 
     NetworkServer(const NetworkServer&);
     ~NetworkServer() noexcept;
@@ -36,21 +112,53 @@ public:
     /** defines asynchronous read or write completion handlers */
     void setHandler(class INetworkHandler* const handler);
 
-	/** transmit single character */
+    /** sets size and number of the receive buffers of each accepted connection */
+    void setReceiveBuffers(size_t bufferSize, size_t bufferCount);
+
+    /** sets watermarks and overflow policy of the client tx queues */
+    void setQueueLimits(const QueueLimits& limits);
+
+    /** sets the datagram size, coalescing window and peer timeout (UDP only) */
+    void setDatagramOptions(const DatagramOptions& options);
+
+    /** sets the options of subsequently accepted tcp connections */
+    void setSocketOptions(const SocketOptions& options);
+
+    /** stops or restarts receiving from all clients (backpressure towards the network) */
+    void pauseReading(bool pause);
+
+    /** stops reading from a plain tcp client so a splice pump can take over its socket; returns the
+     *  descriptor once nothing is in flight, -1 until then (call again) or if the client cannot be spliced.
+     *  Runs on the executor of the server. */
+    int suspendClient(ClientId client);
+
+    /** hands the socket of a suspended client back to its read and write engines */
+    void resumeClient(ClientId client);
+
+	/** transmit single character to all clients */
 	bool send(const char cMsg) noexcept;
 
-	/** transmit text */
+	/** transmit text to all clients */
 	bool send(const std::string& text);
 
-	/** transmit buffer */
+	/** transmit buffer to all clients; stored once and queued by reference on each, may be called from another thread than the io service */
 	bool send(const uint8_t* const data, size_t length);
 
-	/** closes device */
+	/** transmit buffer to a single client */
+	bool sendTo(ClientId client, const uint8_t* const data, size_t length);
+
+	/** closes all client connections */
 	bool close() noexcept;
 
-	/** true if still transceiving */
+	/** true if any client is connected */
 	bool isActive() const;
 
+	/** number of connected clients */
+	size_t clientCount() const;
+
+	/** tx queue state of all connected clients */
+	std::vector<ClientStatistics> statistics() const;
+
 };
 
 
@@ -0,0 +1,274 @@
+/**
+ * @file		ReliableSession.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include "ReliableSession.h"
+
+#include <algorithm>
+
+static const std::chrono::milliseconds MIN_RTO(20);
+static const std::chrono::milliseconds MAX_RTO(1000);
+static const std::chrono::milliseconds INITIAL_RTO(200);
+
+static void writeU32(uint8_t* target, uint32_t value)
+{
+    target[0] = static_cast<uint8_t>(value >> 24);
+    target[1] = static_cast<uint8_t>(value >> 16);
+    target[2] = static_cast<uint8_t>(value >> 8);
+    target[3] = static_cast<uint8_t>(value);
+}
+
+static uint32_t readU32(const char* source)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(source);
+    return (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 8) | uint32_t(bytes[3]);
+}
+
+/** serial arithmetic, so the sequence numbers may wrap */
+static int32_t distance(uint32_t from, uint32_t to)
+{
+    return static_cast<int32_t>(to - from);
+}
+
+
+ReliableSession::ReliableSession(DeliverHandler deliver, TransmitHandler transmit)
+    : m_deliver(std::move(deliver)),
+      m_transmit(std::move(transmit)),
+      m_rto(INITIAL_RTO)
+{
+}
+
+
+bool ReliableSession::isFrame(const char* frame, size_t length)
+{
+    return length >= HEADER_SIZE && MAGIC == static_cast<uint8_t>(frame[0]);
+}
+
+
+void ReliableSession::send(const SharedChunk& payload, Clock::time_point now)
+{
+    m_backlog.push_back(payload);
+    m_pendingBytes += payload->size();
+
+    fillWindow(now);
+}
+
+
+size_t ReliableSession::discardBacklog(size_t limit)
+{
+    size_t discarded = 0;
+
+    while (!m_backlog.empty() && m_pendingBytes > limit)
+    {
+        const size_t length = m_backlog.front()->size();
+
+        m_backlog.pop_front();
+        m_pendingBytes -= length;
+        discarded += length;
+    }
+
+    return discarded;
+}
+
+
+void ReliableSession::fillWindow(Clock::time_point now)
+{
+    while (!m_backlog.empty() && m_unacked.size() < WINDOW)
+    {
+        Frame frame;
+        frame.sequence = m_nextSequence++;
+        frame.payload = std::move(m_backlog.front());
+        m_backlog.pop_front();
+
+        m_unacked.push_back(std::move(frame));
+        transmit(m_unacked.back(), now);
+    }
+}
+
+
+void ReliableSession::transmit(Frame& frame, Clock::time_point now)
+{
+    uint8_t header[HEADER_SIZE] = { MAGIC, static_cast<uint8_t>(eFrameType::Data), 0, 0 };
+    writeU32(&header[4], frame.sequence);
+
+    frame.sentAt = now;
+    m_transmit(header, HEADER_SIZE, frame.payload);
+}
+
+
+void ReliableSession::sendAck()
+{
+    uint32_t sack = 0;
+
+    for (const auto & frame : m_outOfOrder)
+    {
+        const int32_t offset = distance(m_expected + 1, frame.first);
+
+        if (offset >= 0 && offset < 32)
+        {
+            sack |= 1U << offset;
+        }
+    }
+
+    uint8_t header[HEADER_SIZE] = { MAGIC, static_cast<uint8_t>(eFrameType::Ack), 0, 0 };
+    writeU32(&header[4], m_expected);
+    writeU32(&header[8], sack);
+
+    m_transmit(header, HEADER_SIZE, SharedChunk());
+}
+
+
+bool ReliableSession::receive(const char* frame, size_t length, Clock::time_point now)
+{
+    if (!isFrame(frame, length))
+    {
+        return false;
+    }
+
+    switch (static_cast<eFrameType>(frame[1]))
+    {
+    case eFrameType::Data:
+        onData(readU32(&frame[4]), frame + HEADER_SIZE, length - HEADER_SIZE);
+        return true;
+
+    case eFrameType::Ack:
+        onAck(readU32(&frame[4]), readU32(&frame[8]), now);
+        return true;
+    }
+
+    return false;
+}
+
+
+void ReliableSession::onData(uint32_t sequence, const char* payload, size_t length)
+{
+    const int32_t offset = distance(m_expected, sequence);
+
+    if (offset < 0 || m_outOfOrder.count(sequence) > 0)
+    {
+        ++m_duplicates;
+    }
+    else if (0 == offset)
+    {
+        m_deliver(payload, length);
+        ++m_expected;
+
+        // the hole is closed, hand out everything that queued up behind it
+        for (auto next = m_outOfOrder.find(m_expected); next != m_outOfOrder.end(); next = m_outOfOrder.find(m_expected))
+        {
+            m_deliver(next->second.data(), next->second.size());
+            m_outOfOrder.erase(next);
+            ++m_expected;
+        }
+    }
+    else if (offset <= static_cast<int32_t>(WINDOW))
+    {
+        m_outOfOrder.emplace(sequence, std::vector<char>(payload, payload + length));
+    }
+
+    // every data frame is acknowledged, duplicates included, since the previous ack may have been lost
+    sendAck();
+}
+
+
+void ReliableSession::onAck(uint32_t cumulative, uint32_t sack, Clock::time_point now)
+{
+    for (Frame & frame : m_unacked)
+    {
+        const int32_t offset = distance(cumulative, frame.sequence);
+
+        if (offset < 0 || (offset > 0 && offset <= 32 && (sack & (1U << (offset - 1)))))
+        {
+            if (!frame.acked && !frame.retransmitted)
+            {
+                sampleRtt(now - frame.sentAt);
+            }
+
+            frame.acked = true;
+        }
+    }
+
+    while (!m_unacked.empty() && m_unacked.front().acked)
+    {
+        m_pendingBytes -= m_unacked.front().payload->size();
+        m_unacked.pop_front();
+    }
+
+    // fast retransmit: frames before the highest selectively acked one are missing rather than late,
+    // they go out again once they had a round trip to arrive
+    if (0 != sack)
+    {
+        uint32_t highest = cumulative;
+
+        for (uint32_t bit = 0; bit < 32; ++bit)
+        {
+            if (sack & (1U << bit))
+            {
+                highest = cumulative + 1 + bit;
+            }
+        }
+
+        const Clock::duration grace = std::max<Clock::duration>(m_srtt, MIN_RTO);
+
+        for (Frame & frame : m_unacked)
+        {
+            if (distance(frame.sequence, highest) <= 0)
+            {
+                break;
+            }
+
+            if (!frame.acked && now - frame.sentAt >= grace)
+            {
+                frame.retransmitted = true;
+                ++m_retransmissions;
+                transmit(frame, now);
+            }
+        }
+    }
+
+    fillWindow(now);
+}
+
+
+void ReliableSession::poll(Clock::time_point now)
+{
+    bool expired = false;
+
+    for (Frame & frame : m_unacked)
+    {
+        if (!frame.acked && now - frame.sentAt >= m_rto)
+        {
+            frame.retransmitted = true;
+            ++m_retransmissions;
+            transmit(frame, now);
+            expired = true;
+        }
+    }
+
+    if (expired)
+    {
+        m_rto = std::min<Clock::duration>(2 * m_rto, MAX_RTO);
+    }
+}
+
+
+/** smoothed round trip estimation as of RFC 6298 */
+void ReliableSession::sampleRtt(Clock::duration rtt)
+{
+    if (m_srtt == Clock::duration::zero())
+    {
+        m_srtt = rtt;
+        m_rttvar = rtt / 2;
+    }
+    else
+    {
+        const Clock::duration delta = (m_srtt > rtt) ? (m_srtt - rtt) : (rtt - m_srtt);
+        m_rttvar = (3 * m_rttvar + delta) / 4;
+        m_srtt = (7 * m_srtt + rtt) / 8;
+    }
+
+    m_rto = std::max<Clock::duration>(MIN_RTO, std::min<Clock::duration>(MAX_RTO, m_srtt + 4 * m_rttvar));
+}
@@ -0,0 +1,109 @@
+#ifndef RELIABLESESSION_H_51F0C3A8_7D2E_4B96_A1C4_9E3B6D08F27A
+#define RELIABLESESSION_H_51F0C3A8_7D2E_4B96_A1C4_9E3B6D08F27A
+
+/**
+ * @file		ReliableSession.h
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "ChunkQueue.h"
+
+
+/** sequenced, selectively acknowledged framing of one datagram peer (lightweight ARQ)
+ *
+ *  Every frame starts with a 12 byte header: magic, type, reserved, a 32 bit sequence
+ *  (DATA) or cumulative ack (ACK) and a 32 bit SACK bitmap for the frames following the
+ *  cumulative ack. Data is delivered in order and exactly once; unacknowledged frames are
+ *  retransmitted after an adaptive timeout or as soon as a SACK reveals a hole.
+ */
+class ReliableSession
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t   HEADER_SIZE = 12;
+    static constexpr uint32_t WINDOW = 32;   /**< frames in flight, matches the SACK bitmap */
+    static constexpr uint8_t  MAGIC = 0xB5;
+
+    enum class eFrameType : uint8_t
+    {
+        Data = 1,
+        Ack = 2
+    };
+
+    /** in-order payload for the application */
+    using DeliverHandler = std::function<void(const char* data, size_t length)>;
+
+    /** frame for the wire, payload may be empty */
+    using TransmitHandler = std::function<void(const uint8_t* header, size_t headerLength, const SharedChunk& payload)>;
+
+    ReliableSession(DeliverHandler deliver, TransmitHandler transmit);
+
+    /** queues a payload of at most one datagram minus HEADER_SIZE, sent as soon as the window allows */
+    void send(const SharedChunk& payload, Clock::time_point now);
+
+    /** handles a received datagram, false if it is not a valid frame */
+    bool receive(const char* frame, size_t length, Clock::time_point now);
+
+    /** retransmits frames whose timeout expired */
+    void poll(Clock::time_point now);
+
+    /** bytes not yet acknowledged by the peer, including the backlog behind the window */
+    size_t pendingBytes() const { return m_pendingBytes; }
+
+    /** drops the oldest payloads behind the window until at most the given bytes are pending,
+     *  frames in flight keep their sequence numbers; returns the dropped bytes */
+    size_t discardBacklog(size_t limit);
+
+    uint64_t retransmissions() const { return m_retransmissions; }
+    uint64_t duplicates() const { return m_duplicates; }
+
+    /** checks the magic of a datagram before a session is created for its sender */
+    static bool isFrame(const char* frame, size_t length);
+
+private:
+    struct Frame
+    {
+        uint32_t          sequence = 0;
+        SharedChunk       payload;
+        Clock::time_point sentAt;
+        bool              acked = false;
+        bool              retransmitted = false;
+    };
+
+    void transmit(Frame& frame, Clock::time_point now);
+    void sendAck();
+    void onAck(uint32_t cumulative, uint32_t sack, Clock::time_point now);
+    void onData(uint32_t sequence, const char* payload, size_t length);
+    void fillWindow(Clock::time_point now);
+    void sampleRtt(Clock::duration rtt);
+
+    DeliverHandler  m_deliver;
+    TransmitHandler m_transmit;
+
+    // sender
+    uint32_t                 m_nextSequence = 0;
+    std::deque<Frame>        m_unacked;       /**< frames in flight, ordered by sequence */
+    std::deque<SharedChunk>  m_backlog;       /**< payloads waiting for the window */
+    size_t                   m_pendingBytes = 0;
+    Clock::duration          m_srtt{ 0 };
+    Clock::duration          m_rttvar{ 0 };
+    Clock::duration          m_rto;
+    uint64_t                 m_retransmissions = 0;
+
+    // receiver
+    uint32_t                              m_expected = 0;
+    std::map<uint32_t, std::vector<char>> m_outOfOrder;
+    uint64_t                              m_duplicates = 0;
+};
+
+#endif /* RELIABLESESSION_H_51F0C3A8_7D2E_4B96_A1C4_9E3B6D08F27A */
@@ -0,0 +1,140 @@
+#ifndef RINGBUFFER_H_3C0F6A2E_5B1D_4E8A_9F47_2D61C8B05A13
+#define RINGBUFFER_H_3C0F6A2E_5B1D_4E8A_9F47_2D61C8B05A13
+
+/**
+ * @file		RingBuffer.h
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+#include <boost/asio/buffer.hpp>
+
+
+/** fixed-capacity single-producer/single-consumer byte ring, exposing its contents as asio buffers
+ *
+ *  The producer fills the ring via write() or prepare()/commit(), the consumer drains it via
+ *  data()/consume(). Both sides may live on different threads; no allocation happens after
+ *  construction.
+ */
+class RingBuffer
+{
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    using ConstBuffers   = std::array<boost::asio::const_buffer, 2>;
+    using MutableBuffers = std::array<boost::asio::mutable_buffer, 2>;
+
+    /** creates a ring holding at least the given number of bytes (rounded up to a power of two) */
+    explicit RingBuffer(size_t capacity)
+        : m_capacity(roundUp(capacity)),
+          m_mask(m_capacity - 1),
+          m_storage(new char[m_capacity])
+    {
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    size_t capacity() const noexcept { return m_capacity; }
+
+    /** bytes currently readable */
+    size_t size() const noexcept
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const noexcept { return 0 == size(); }
+
+    /** bytes currently writable */
+    size_t space() const noexcept { return m_capacity - size(); }
+
+
+    //// producer side
+
+    /** the free space as up to two contiguous regions, to be filled before commit() */
+    MutableBuffers prepare() noexcept
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        const size_t free = m_capacity - (head - tail);
+        const size_t offset = head & m_mask;
+        const size_t first = std::min(free, m_capacity - offset);
+
+        return MutableBuffers{ boost::asio::buffer(m_storage.get() + offset, first),
+                               boost::asio::buffer(m_storage.get(), free - first) };
+    }
+
+    /** publishes the given number of bytes written into the prepared regions */
+    void commit(size_t length) noexcept
+    {
+        m_head.store(m_head.load(std::memory_order_relaxed) + length, std::memory_order_release);
+    }
+
+    /** copies as much of the given data as fits, returns the number of bytes taken */
+    size_t write(const char* data, size_t length) noexcept
+    {
+        size_t written = 0;
+
+        for (const boost::asio::mutable_buffer & region : prepare())
+        {
+            const size_t chunk = std::min(region.size(), length - written);
+            std::memcpy(region.data(), data + written, chunk);
+            written += chunk;
+        }
+
+        commit(written);
+        return written;
+    }
+
+
+    //// consumer side
+
+    /** the readable bytes as up to two contiguous regions */
+    ConstBuffers data() const noexcept
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t used = m_head.load(std::memory_order_acquire) - tail;
+        const size_t offset = tail & m_mask;
+        const size_t first = std::min(used, m_capacity - offset);
+
+        return ConstBuffers{ boost::asio::buffer(m_storage.get() + offset, first),
+                             boost::asio::buffer(m_storage.get(), used - first) };
+    }
+
+    /** releases the given number of bytes at the front */
+    void consume(size_t length) noexcept
+    {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + length, std::memory_order_release);
+    }
+
+private:
+    static size_t roundUp(size_t capacity) noexcept
+    {
+        size_t result = CACHE_LINE_SIZE;
+
+        while (result < capacity)
+        {
+            result <<= 1;
+        }
+
+        return result;
+    }
+
+    // producer and consumer indices on separate cache lines, so both sides do not false-share
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_head{ 0 }; /**< total bytes written, owned by the producer */
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail{ 0 }; /**< total bytes read, owned by the consumer */
+
+    alignas(CACHE_LINE_SIZE) const size_t m_capacity;
+    const size_t              m_mask;
+    std::unique_ptr<char[]>   m_storage;
+};
+
+#endif /* RINGBUFFER_H_3C0F6A2E_5B1D_4E8A_9F47_2D61C8B05A13 */
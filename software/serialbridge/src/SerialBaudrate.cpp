@@ -0,0 +1,45 @@
+/**
+ * @file		SerialBaudrate.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ * @remark		a unit of its own: the termios2 definitions of asm/termbits.h clash with termios.h
+ */
+
+#include "SerialTuning.h"
+
+#ifdef __linux__
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+#endif
+
+
+uint32_t applyBaudrate(int fd, uint32_t baudrate)
+{
+#ifdef __linux__
+    struct termios2 settings;
+
+    if (0 != ::ioctl(fd, TCGETS2, &settings))
+    {
+        return 0;
+    }
+
+    // BOTHER takes the rate from c_ispeed/c_ospeed instead of the Bxxx code, for input and output
+    settings.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+    settings.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+    settings.c_ispeed = baudrate;
+    settings.c_ospeed = baudrate;
+
+    if (0 != ::ioctl(fd, TCSETS2, &settings) || 0 != ::ioctl(fd, TCGETS2, &settings))
+    {
+        return 0;
+    }
+
+    // drivers write back the rate they could set up (clamped to the uart's range, or their fallback)
+    return settings.c_ospeed;
+#else
+    (void) fd;
+    (void) baudrate;
+    return 0;
+#endif
+}
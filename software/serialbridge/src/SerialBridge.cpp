@@ -1,8 +1,36 @@
 #include "SerialBridge.h"
+#include "Coalescer.h"
+#include "RingBuffer.h"
+#include "System.h"
 
+#ifdef SERIALBRIDGE_WITH_IO_URING
+#include "IoUring.h"
+#endif
+
+#ifdef SERIALBRIDGE_WITH_SPLICE
+#include "SplicePump.h"
+#endif
+
+#ifdef SERIALBRIDGE_WITH_HOTPLUG
+#include "DeviceWatcher.h"
+#endif
+
+#ifdef SERIALBRIDGE_WITH_SPOOL
+#include "Spool.h"
+#endif
+
+#ifdef SERIALBRIDGE_WITH_CAPTURE
+#include "Capture.h"
+#endif
+
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
+#include <boost/filesystem.hpp>
+
 static const char* HelloString = "SerialBridge\n\r";
+static const char* OfflineString = "SerialBridge: serial device lost\n\r";
 
 static NetworkServer::eTransport getServerType(const Arguments& options)
 {
@@ -13,13 +41,375 @@ static NetworkServer::eTransport getServerType(const Arguments& options)
 }
 
 
+
+/** low_latency flag, latency timer and VMIN/VTIME as the driver reports them */
+static std::string describe(const SerialPort::Latency& latency)
+{
+    std::string text = "low_latency " + std::string(latency.lowLatency < 0 ? "n/a" : (latency.lowLatency > 0 ? "on" : "off"));
+
+    text += ", latency timer " + (latency.latencyTimerMs < 0 ? std::string("n/a") : std::to_string(latency.latencyTimerMs) + " ms");
+    text += ", vmin " + std::to_string(latency.vmin) + ", vtime " + std::to_string(latency.vtime);
+
+    return text;
+}
+
+/** the hand-over to the splice pump waits for pending writes, the data path stays in user space if they never drain */
+static constexpr std::chrono::milliseconds SPLICE_RETRY_INTERVAL(10);
+static constexpr unsigned SPLICE_ATTEMPTS = 100;
+
+/** the drain keeps the client queues between the low watermark and one chunk above it, polling while they are fuller */
+static constexpr size_t SPOOL_DRAIN_CHUNK = 64 * 1024;
+static constexpr std::chrono::milliseconds SPOOL_DRAIN_INTERVAL(1);
+
+
+/** the ring of a bridge, nullptr if asio was asked for or io_uring is not available */
+static std::shared_ptr<IoUring> createIoUring(const Arguments& options, const boost::asio::any_io_executor& strand)
+{
+    if (System::eIoBackend::IoUring != options.ioBackend)
+    {
+        return nullptr;
+    }
+
+#ifdef SERIALBRIDGE_WITH_IO_URING
+    return IoUring::create(strand);
+#else
+    (void) strand;
+    std::cerr << "io_uring requested, but SerialBridge was built without it, using asio" << std::endl;
+    return nullptr;
+#endif
+}
+
+
 SerialBridge::SerialBridge(const Arguments& options)
+    : SerialBridge(options, System::makeStrand())
+{
+}
+
+
+SerialBridge::SerialBridge(const Arguments& options, const boost::asio::any_io_executor& strand)
     : options(options),
-    serialPort(options.strDevice, options.uiBaudrate, SerialPort::eFlowControl::None),
-    tcpServer(options.strAddress, options.port, getServerType(options), options.strSSLCert)
+    logPrefix(options.strName.empty() ? std::string() : "[" + options.strName + "] "),
+    strand(strand),
+    uring(createIoUring(options, strand)),
+    serialPort(options.strDevice, options.uiBaudrate, options.flowControl, strand),
+    tcpServer(strand, options.strAddress, options.port, getServerType(options), options.strSSLCert, options.strSSLKey, uring),
+    statsTimer(strand),
+    connectTimer(strand),
+    spliceTimer(strand),
+    spoolTimer(strand)
 {
+    NetworkServer::QueueLimits limits;
+    limits.highWatermark = options.uiTxHighWatermark * 1024U;
+    limits.lowWatermark = options.uiTxLowWatermark * 1024U;
+    limits.policy = options.overflowPolicy;
+
     serialPort.setHandler(this);
+    serialPort.setFraming(static_cast<uint8_t>(options.uiDataBits), options.parity, options.stopBits);
+    serialPort.setReceiveBuffers(options.uiRxBufferSize, options.uiRxBufferCount);
+    serialPort.setQueueLimits(limits.highWatermark, limits.lowWatermark);
+    serialPort.setLatencyMode(options.latencyMode, options.uiLatencyTimer);
+    serialPort.setIoUring(uring);
+
     tcpServer.setHandler(this);
+    tcpServer.setReceiveBuffers(options.uiRxBufferSize, options.uiRxBufferCount);
+    tcpServer.setQueueLimits(limits);
+
+    NetworkServer::DatagramOptions datagram;
+    datagram.maxDatagramSize = options.uiMaxDatagram;
+    datagram.coalesceMicros = options.uiCoalesceMicros;
+    datagram.peerTimeoutSeconds = options.uiPeerTimeout;
+    datagram.reliable = options.useReliableUDP;
+    datagram.simLossPercent = options.uiSimLoss;
+    datagram.simReorderPercent = options.uiSimReorder;
+    tcpServer.setDatagramOptions(datagram);
+    tcpServer.setSocketOptions(options.socketOptions);
+
+    if (options.uiHistory > 0)
+    {
+        // a replay beyond the watermark would congest the new client right away
+        if (options.uiHistory > options.uiTxHighWatermark)
+        {
+            std::cout << logPrefix << "History limited to the tx high watermark of " << options.uiTxHighWatermark << " KiB" << std::endl;
+        }
+
+        historyLimit = std::min(options.uiHistory, options.uiTxHighWatermark) * 1024U;
+        history.reset(new RingBuffer(historyLimit));
+    }
+
+    if (!options.strSpoolDir.empty())
+    {
+#ifdef SERIALBRIDGE_WITH_SPOOL
+        Spool::Settings spooling;
+        spooling.directory = options.strSpoolDir;
+        spooling.maxBytes = uint64_t(options.uiSpoolSize) * 1024U * 1024U;
+        spooling.segmentBytes = std::min<uint64_t>(options.uiSpoolSegment * 1024U, spooling.maxBytes);
+        spooling.syncMillis = options.uiSpoolSync;
+
+        spool = Spool::open(strand, spooling);
+#else
+        std::cerr << logPrefix << "Spool requested, but SerialBridge was built without it" << std::endl;
+#endif
+    }
+
+    if (!options.strCapture.empty())
+    {
+#ifdef SERIALBRIDGE_WITH_CAPTURE
+        try
+        {
+            capture = std::make_shared<CaptureWriter>(options.strCapture);
+            std::cout << logPrefix << "Capturing to " << options.strCapture << std::endl;
+        }
+        catch (const char* const text)
+        {
+            std::cerr << logPrefix << "Capture: " << text << " (" << std::strerror(errno) << "), " << options.strCapture << " not recorded" << std::endl;
+        }
+#else
+        std::cerr << logPrefix << "Capture requested, but SerialBridge was built without it" << std::endl;
+#endif
+    }
+
+    Coalescer::Settings coalescing;
+    coalescing.maxDelayMicros = options.uiSerialCoalesceMicros;
+    coalescing.maxBytes = options.uiSerialCoalesceBytes;
+    coalescing.delimiter = options.serialDelimiter;
+
+    // the bridge owns the coalescer and both run on the strand, so the handler never outlives the bridge
+    coalescer = std::make_shared<Coalescer>(strand, coalescing, [this](const char* data, size_t length)
+                                            {
+                                                if (spoolData(data, length))
+                                                {
+                                                    return;
+                                                }
+
+                                                // recorded as sent, so a replay never repeats what a new client gets live
+                                                recordHistory(data, length);
+
+                                                if (!tcpClients.empty())
+                                                {
+                                                    tcpServer.send(reinterpret_cast<const uint8_t*>(data), length);
+                                                }
+                                            });
+}
+
+SerialBridge::~SerialBridge()
+{
+    // completions still pending on the port or server must not reach this bridge anymore
+    serialPort.setHandler(nullptr);
+    tcpServer.setHandler(nullptr);
+    coalescer->stop();
+
+#ifdef SERIALBRIDGE_WITH_HOTPLUG
+    if (nullptr != deviceWatcher)
+    {
+        deviceWatcher->stop();
+    }
+#endif
+
+#ifdef SERIALBRIDGE_WITH_SPLICE
+    // cancels the readiness waits, which keep the pump and its descriptors alive otherwise
+    if (nullptr != splice)
+    {
+        splice->stop();
+    }
+#endif
+
+#ifdef SERIALBRIDGE_WITH_IO_URING
+    // drops whatever is still in flight, the port and server then close their descriptors
+    if (nullptr != uring)
+    {
+        uring->shutdown();
+    }
+#endif
+}
+
+void SerialBridge::run()
+{
+    if (nullptr != uring)
+    {
+        std::cout << logPrefix << "I/O backend: io_uring (serial device" << (options.useUDP || !options.strSSLCert.empty() ? ", clients via asio)" : " and tcp clients)") << std::endl;
+    }
+
+    if (options.useSplice)
+    {
+#ifdef SERIALBRIDGE_WITH_SPLICE
+        if (nullptr != uring || options.useUDP || !options.strSSLCert.empty())
+        {
+            std::cout << logPrefix << "Splice passthrough needs plain TCP on the asio backend, disabled" << std::endl;
+        }
+        else if (coalescer->isEnabled() || nullptr != history || nullptr != spool || nullptr != capture)
+        {
+            std::cout << logPrefix << "Splice passthrough would bypass the serial coalescing, history, spool and capture, disabled" << std::endl;
+        }
+#else
+        std::cerr << logPrefix << "Splice passthrough requested, but SerialBridge was built without it" << std::endl;
+#endif
+    }
+
+#ifdef SERIALBRIDGE_WITH_HOTPLUG
+    deviceWatcher = DeviceWatcher::create(strand, options.strDevice);
+
+    if (nullptr != deviceWatcher)
+    {
+        std::weak_ptr<SerialBridge> weak(shared_from_this());
+
+        deviceWatcher->start([weak]()
+                             {
+                                 if (auto self = weak.lock())
+                                 {
+                                     self->onDeviceChange();
+                                 }
+                             });
+    }
+#else
+    if (0 == options.strDevice.compare(0, 4, "usb:"))
+    {
+        std::cerr << logPrefix << "USB device matching requested, but SerialBridge was built without hotplug support" << std::endl;
+    }
+#endif
+
+    scheduleStatistics();
+    updateNetworkPause();
+    connectSerial();
+}
+
+void SerialBridge::connectSerial()
+{
+    // a hotplug event may have been faster than the timer
+    if (serialConnected)
+    {
+        return;
+    }
+
+    serialDevice = options.strDevice;
+
+#ifdef SERIALBRIDGE_WITH_HOTPLUG
+    if (isUsbDeviceSpec(options.strDevice))
+    {
+        serialDevice = findUsbDevice(options.strDevice);
+    }
+#endif
+
+    ++reconnectAttempts;
+
+    try
+    {
+        if (!serialDevice.empty())
+        {
+            serialPort.setDevice(serialDevice);
+            serialPort.awaitConnection(0);
+        }
+    }
+    catch (const char* const text)
+    {
+        // the driver refused the baud rate or line settings: polling again cannot help
+        if (SerialPort::UNSUPPORTED_SETTINGS == text)
+        {
+            throw;
+        }
+
+        std::cerr << logPrefix << text << std::endl;
+    }
+
+    if (serialConnected)
+    {
+        connectTimer.cancel();
+        serialPort.start();
+        return;
+    }
+
+    // hotplug events retry right away, the timer covers devices without them and opens failing for other reasons
+    const std::chrono::milliseconds minDelay(options.uiReconnectMin);
+    const std::chrono::milliseconds maxDelay(options.uiReconnectMax);
+    reconnectDelay = reconnectDelay < minDelay ? minDelay : std::min(2 * reconnectDelay, maxDelay);
+
+    std::weak_ptr<SerialBridge> weak(shared_from_this());
+
+    connectTimer.expires_after(reconnectDelay);
+    connectTimer.async_wait([weak](const boost::system::error_code& error)
+                            {
+                                auto self = weak.lock();
+
+                                if (!error && self)
+                                {
+                                    try
+                                    {
+                                        self->connectSerial();
+                                    }
+                                    catch (const char* const text)
+                                    {
+                                        std::cerr << self->logPrefix << ">>> " << text << " (" << self->options.strDevice << " stays closed)" << std::endl;
+                                    }
+                                }
+                            });
+}
+
+void SerialBridge::onDeviceChange()
+{
+    boost::system::error_code error;
+
+    if (!serialConnected)
+    {
+        // something changed on the way to the device, the backoff starts over
+        reconnectDelay = std::chrono::milliseconds(0);
+
+        try
+        {
+            connectSerial();
+        }
+        catch (const char* const text)
+        {
+            std::cerr << logPrefix << ">>> " << text << " (" << serialDevice << " stays closed)" << std::endl;
+        }
+    }
+    else if (!boost::filesystem::exists(serialDevice, error))
+    {
+        disconnectSerial();
+    }
+}
+
+/** the node went away before the port noticed */
+void SerialBridge::disconnectSerial()
+{
+    std::cout << logPrefix << "Serial port " << serialDevice << " removed" << std::endl;
+
+    serialPort.close();
+    goOffline();
+}
+
+/** the clients stay connected while the bridge reopens the device */
+void SerialBridge::goOffline()
+{
+    serialConnected = false;
+    serialCongested = false;   // the closed port reports no relief anymore
+    offlineSince = std::chrono::steady_clock::now();
+    reconnectDelay = std::chrono::milliseconds(0);
+    reconnectAttempts = 0;
+
+    leaveSplice();
+    updateNetworkPause();
+
+    // the last bytes of the device go out ahead of any status line
+    coalescer->flush();
+
+    if (SerialPort::eOfflinePolicy::Notify == options.offlinePolicy && !tcpClients.empty())
+    {
+        tcpServer.send(OfflineString);
+    }
+
+    // called from the port and hotplug handlers, nothing above them would catch a refused reopen
+    try
+    {
+        connectSerial();
+    }
+    catch (const char* const text)
+    {
+        std::cerr << logPrefix << ">>> " << text << " (" << serialDevice << " stays closed)" << std::endl;
+    }
+}
+
+void SerialBridge::updateNetworkPause()
+{
+    tcpServer.pauseReading(serialCongested || (!serialConnected && SerialPort::eOfflinePolicy::Pause == options.offlinePolicy));
 }
 
 bool SerialBridge::isSerialAvailable() const
@@ -37,36 +427,77 @@ void SerialBridge::start()
     serialPort.start();
 }
 
-void SerialBridge::checkReadyness()
+void SerialBridge::checkReadyness(ClientId client)
 {
-    if (tcpConnected && serialConnected)
+    if (!tcpClients.empty() && serialConnected)
     {
-        std::cout << "TCP + Serial ready" << std::endl;
-        if (!readySent)
-        {
-            tcpServer.send(HelloString);
-            readySent = true;
-        }
+        std::cout << logPrefix << "TCP + Serial ready" << std::endl;
+        tcpServer.sendTo(client, reinterpret_cast<const uint8_t*>(HelloString), std::strlen(HelloString));
     }
 }
 
 void SerialBridge::onSerialConnected()
 {
     serialConnected = true;
-    checkReadyness();
+
+    std::cout << logPrefix << "Serial latency: " << describe(serialPort.statistics().latency) << std::endl;
+
+    if (std::chrono::steady_clock::time_point() != offlineSince)
+    {
+        const auto offline = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - offlineSince);
+
+        std::cout << logPrefix << "Serial port back after " << offline.count() << " ms offline (" << reconnectAttempts << " attempts)" << std::endl;
+
+        ++reconnects;
+        offlineSince = std::chrono::steady_clock::time_point();
+    }
+
+    reconnectDelay = std::chrono::milliseconds(0);
+    reconnectAttempts = 0;
+    updateNetworkPause();
+
+    // queued before the data of the clients, which are read again from now on
+    if (!offlineBuffer.empty())
+    {
+        serialPort.send(offlineBuffer);
+        offlineBuffer.clear();
+    }
+
+    if (!tcpClients.empty())
+    {
+        tcpServer.send(HelloString);
+    }
+
+    updateSplice();
+}
+
+void SerialBridge::onSerialDisconnected()
+{
+    std::cout << logPrefix << "Serial port " << serialDevice << " failed, reconnecting" << std::endl;
+
+    goOffline();
 }
 
 void SerialBridge::onSerialReadComplete(const char* msg, size_t length)
 {
-    if (tcpConnected)
-    {
-        tcpServer.send(std::string(msg, msg + length));
-    }
+    recordCapture(true, 0, msg, length);
+    coalescer->append(msg, length);
 }
 
-void SerialBridge::onNetworkReadComplete(const char* msg, size_t length)
+void SerialBridge::onNetworkReadComplete(ClientId client, const char* msg, size_t length)
 {
-    if (tcpConnected)
+    recordCapture(false, client, msg, length);
+
+    if (!serialConnected)
+    {
+        // reads still pending when the device went away complete later, they are kept up to one tx queue
+        if (SerialPort::eOfflinePolicy::Pause == options.offlinePolicy)
+        {
+            const size_t limit = options.uiTxHighWatermark * 1024U;
+            offlineBuffer.append(msg, std::min(length, limit - std::min(limit, offlineBuffer.size())));
+        }
+    }
+    else if (!tcpClients.empty())
     {
         serialPort.send((uint8_t*)msg, length);
     }
@@ -77,19 +508,401 @@ void SerialBridge::onSerialWriteComplete(const char* msg, size_t length)
 {
 }
 
-void SerialBridge::onNetworkClientAccept()
+void SerialBridge::onSerialCongestion(bool congested)
+{
+    // the device is slower than the clients: stop reading from the network until the queue drained
+    serialCongested = congested;
+    updateNetworkPause();
+}
+
+void SerialBridge::onNetworkCongestion(bool congested)
+{
+    // a client is slower than the device: stop reading the uart, hardware flow control throttles the device
+    serialPort.pauseReading(congested);
+}
+
+void SerialBridge::scheduleStatistics()
+{
+    if (options.uiStatsInterval > 0)
+    {
+        std::weak_ptr<SerialBridge> weak(shared_from_this());
+
+        statsTimer.expires_after(std::chrono::seconds(options.uiStatsInterval));
+        statsTimer.async_wait([weak](const boost::system::error_code& error)
+                              {
+                                  auto self = weak.lock();
+
+                                  if (!error && self)
+                                  {
+                                      self->printStatistics();
+                                      self->scheduleStatistics();
+                                  }
+                              });
+    }
+}
+
+void SerialBridge::printStatistics()
+{
+    const SerialPort::Statistics serial = serialPort.statistics();
+
+    std::cout << logPrefix << "Serial: rx " << serial.rxBytes << " B, tx " << serial.txBytes << " B, "
+              << "queued " << serial.txQueuedBytes << " B, dropped " << serial.txDroppedBytes << " B"
+              << (serial.txCongested ? ", congested" : "")
+              << (serial.rxPaused ? ", reading paused" : "") << ", " << describe(serial.latency)
+              << (serialConnected ? "" : ", offline") << ", reconnects " << reconnects << std::endl;
+
+    for (const NetworkServer::ClientStatistics & client : tcpServer.statistics())
+    {
+        std::cout << logPrefix << "Client " << client.client << ": sent " << client.sentBytes << " B, "
+                  << "queued " << client.queuedBytes << " B, dropped " << client.droppedBytes << " B";
+
+        if (client.retransmissions > 0 || client.duplicates > 0)
+        {
+            std::cout << ", retransmitted " << client.retransmissions << ", duplicates " << client.duplicates;
+        }
+
+        std::cout << (client.congested ? ", congested" : "") << std::endl;
+    }
+
+    if (coalescer->isEnabled())
+    {
+        const Coalescer::Statistics & coalescing = coalescer->statistics();
+
+        std::cout << logPrefix << "Coalescer: " << coalescing.sizeBytes.count() << " flushes (size "
+                  << coalescing.flushes[static_cast<size_t>(Coalescer::eFlush::Size)] << ", timer "
+                  << coalescing.flushes[static_cast<size_t>(Coalescer::eFlush::Timer)] << ", delimiter "
+                  << coalescing.flushes[static_cast<size_t>(Coalescer::eFlush::Delimiter)] << "), "
+                  << "size p50/p99/max " << coalescing.sizeBytes.percentile(0.5) << "/" << coalescing.sizeBytes.percentile(0.99)
+                  << "/" << coalescing.sizeBytes.max() << " B, delay p50/p99/max " << coalescing.delayMicros.percentile(0.5)
+                  << "/" << coalescing.delayMicros.percentile(0.99) << "/" << coalescing.delayMicros.max() << " us" << std::endl;
+    }
+
+#ifdef SERIALBRIDGE_WITH_SPOOL
+    if (nullptr != spool)
+    {
+        const Spool::Statistics & spooling = spool->statistics();
+
+        std::cout << logPrefix << "Spool: " << spool->size() << " B pending in " << spool->segments() << " segments, spooled "
+                  << spooling.spooledBytes << " B, drained " << spooling.drainedBytes << " B, dropped " << spooling.droppedBytes
+                  << " B, " << spooling.syncs << " syncs" << std::endl;
+    }
+#endif
+
+#ifdef SERIALBRIDGE_WITH_CAPTURE
+    if (nullptr != capture)
+    {
+        std::cout << logPrefix << "Capture: " << capture->records() << " records, " << capture->size() << " B" << std::endl;
+    }
+#endif
+
+#ifdef SERIALBRIDGE_WITH_SPLICE
+    // spliced bytes bypass the counters of port and client
+    if (nullptr != splice)
+    {
+        std::cout << logPrefix << "Splice: client " << spliceClient << ", " << splice->toNetworkBytes() << " B to network, "
+                  << splice->toSerialBytes() << " B to serial" << std::endl;
+    }
+#endif
+}
+
+void SerialBridge::onNetworkClientAccept(ClientId client)
+{
+    tcpClients.push_back(client);
+
+    std::cout << logPrefix << "Client Connect (" << client << ", " << tcpClients.size() << " connected)" << std::endl;
+
+    // a second client needs the fan-out in user space, the pump hands back what it still holds first
+    updateSplice();
+    checkReadyness(client);
+    replayHistory(client);
+    drainSpool();
+}
+
+void SerialBridge::onNetworkClientDisconnect(ClientId client)
+{
+    tcpClients.erase(std::remove(tcpClients.begin(), tcpClients.end(), client), tcpClients.end());
+
+    std::cout << logPrefix << "Client Disconnect (" << client << ", " << tcpClients.size() << " connected)" << std::endl;
+
+    if (client == spliceClient)
+    {
+        leaveSplice();
+    }
+
+    updateSplice();
+}
+
+void SerialBridge::recordHistory(const char* msg, size_t length)
+{
+    if (nullptr == history)
+    {
+        return;
+    }
+
+    // only the newest bytes of a read larger than the limit are kept
+    if (length >= historyLimit)
+    {
+        history->consume(history->size());
+        msg += length - historyLimit;
+        length = historyLimit;
+    }
+    else if (history->size() + length > historyLimit)
+    {
+        history->consume(history->size() + length - historyLimit);
+    }
+
+    history->write(msg, length);
+}
+
+void SerialBridge::replayHistory(ClientId client)
+{
+    if (nullptr == history)
+    {
+        return;
+    }
+
+    // queued on this client only, live data sent from now on lines up behind it
+    for (const boost::asio::const_buffer & region : history->data())
+    {
+        if (region.size() > 0)
+        {
+            tcpServer.sendTo(client, static_cast<const uint8_t*>(region.data()), region.size());
+        }
+    }
+}
+
+void SerialBridge::recordCapture(bool fromSerial, ClientId client, const char* msg, size_t length)
+{
+#ifdef SERIALBRIDGE_WITH_CAPTURE
+    if (nullptr == capture)
+    {
+        return;
+    }
+
+    try
+    {
+        capture->record(fromSerial ? Capture::eDirection::SerialToNetwork : Capture::eDirection::NetworkToSerial, client, msg, length);
+    }
+    catch (const char* const text)
+    {
+        // the file keeps every record completed so far
+        std::cerr << logPrefix << "Capture: " << text << " (" << std::strerror(errno) << "), recording stopped" << std::endl;
+        capture.reset();
+    }
+#else
+    (void) fromSerial;
+    (void) client;
+    (void) msg;
+    (void) length;
+#endif
+}
+
+/** true if the data went to the spool: no client is connected, or the clients still get older data from it */
+bool SerialBridge::spoolData(const char* msg, size_t length)
 {
-    tcpConnected = true;
+#ifdef SERIALBRIDGE_WITH_SPOOL
+    if (nullptr == spool || (!tcpClients.empty() && spool->empty()))
+    {
+        return false;
+    }
 
-    std::cout << "Client Connect" << std::endl;
+    try
+    {
+        spool->append(msg, length);
+    }
+    catch (const char* const text)
+    {
+        // the segments written so far stay on disk and are recovered on the next start
+        std::cerr << logPrefix << "Spool: " << text << " (" << std::strerror(errno) << "), spooling stopped" << std::endl;
+        spool.reset();
+        return false;
+    }
 
-    checkReadyness();
+    drainSpool();
+    return true;
+#else
+    (void) msg;
+    (void) length;
+    return false;
+#endif
 }
 
-void SerialBridge::onNetworkClientDisconnect()
+/** sends the spooled data at the pace the slowest client takes it, live data queues up in the spool meanwhile */
+void SerialBridge::drainSpool()
 {
-    tcpConnected = false;
-    readySent = false;
+#ifdef SERIALBRIDGE_WITH_SPOOL
+    if (nullptr == spool || spool->empty() || tcpClients.empty() || spoolDrainScheduled)
+    {
+        return;
+    }
+
+    const size_t lowWatermark = options.uiTxLowWatermark * 1024U;
+    const size_t highWatermark = options.uiTxHighWatermark * 1024U;
+
+    for (;;)
+    {
+        size_t queued = 0;
+
+        for (const NetworkServer::ClientStatistics & client : tcpServer.statistics())
+        {
+            queued = std::max(queued, client.queuedBytes);
+        }
+
+        // an empty queue always takes a chunk, otherwise a low watermark of 0 would never let the spool drain
+        if ((queued > 0 && queued >= lowWatermark) || queued >= highWatermark || spool->empty())
+        {
+            break;
+        }
+
+        // every client gets it, one joining meanwhile sees the history and then the rest of the spool;
+        // bounded by the high watermark, so draining never triggers the overflow policy
+        const boost::asio::const_buffer chunk = spool->front(std::min(SPOOL_DRAIN_CHUNK, highWatermark - queued));
+
+        recordHistory(static_cast<const char*>(chunk.data()), chunk.size());
+        tcpServer.send(static_cast<const uint8_t*>(chunk.data()), chunk.size());
+        spool->consume(chunk.size());
+    }
+
+    if (spool->empty())
+    {
+        std::cout << logPrefix << "Spool drained (" << spool->statistics().drainedBytes << " B in total), live" << std::endl;
+        return;
+    }
+
+    std::weak_ptr<SerialBridge> weak(shared_from_this());
+
+    spoolDrainScheduled = true;
+    spoolTimer.expires_after(SPOOL_DRAIN_INTERVAL);
+    spoolTimer.async_wait([weak](const boost::system::error_code& error)
+                          {
+                              auto self = weak.lock();
+
+                              if (!error && self)
+                              {
+                                  self->spoolDrainScheduled = false;
+                                  self->drainSpool();
+                              }
+                          });
+#endif
+}
+
+bool SerialBridge::canSplice() const
+{
+#ifdef SERIALBRIDGE_WITH_SPLICE
+    // the pump sees neither the bytes nor more than one socket: everything inspecting or fanning out the data rules it out
+    return options.useSplice && nullptr == uring && !options.useUDP && options.strSSLCert.empty() &&
+           !coalescer->isEnabled() && nullptr == history && nullptr == spool &&
+           nullptr == capture && serialConnected && 1 == tcpClients.size();
+#else
+    return false;
+#endif
+}
+
+void SerialBridge::updateSplice()
+{
+    if (!canSplice())
+    {
+        leaveSplice();
+    }
+    else if (0 == spliceClient)
+    {
+        spliceClient = tcpClients.front();
+        spliceAttempts = 0;
+        trySplice();
+    }
+}
+
+void SerialBridge::trySplice()
+{
+#ifdef SERIALBRIDGE_WITH_SPLICE
+    if (0 == spliceClient || nullptr != splice)
+    {
+        return;
+    }
+
+    // both sides stop reading, once their writes drained the pump takes over the descriptors
+    const int socketFd = tcpServer.suspendClient(spliceClient);
+    const int serialFd = serialPort.suspendReading();
+
+    if (socketFd >= 0 && serialFd >= 0)
+    {
+        splice = SplicePump::create(strand, serialFd, socketFd);
+
+        if (nullptr != splice)
+        {
+            std::weak_ptr<SerialBridge> weak(shared_from_this());
+
+            std::cout << logPrefix << "Client " << spliceClient << ": splice passthrough" << std::endl;
+
+            splice->start([weak](SplicePump::eStop)
+                          {
+                              // the read engines take over again and report the closed side the usual way
+                              if (auto self = weak.lock())
+                              {
+                                  self->leaveSplice();
+                              }
+                          });
+            return;
+        }
+    }
+    else if (++spliceAttempts < SPLICE_ATTEMPTS)
+    {
+        std::weak_ptr<SerialBridge> weak(shared_from_this());
+
+        spliceTimer.expires_after(SPLICE_RETRY_INTERVAL);
+        spliceTimer.async_wait([weak](const boost::system::error_code& error)
+                               {
+                                   auto self = weak.lock();
+
+                                   if (!error && self)
+                                   {
+                                       self->trySplice();
+                                   }
+                               });
+        return;
+    }
+
+    std::cout << logPrefix << "Client " << spliceClient << ": staying in user space" << std::endl;
+
+    // spliceClient stays set, so the bridge does not retry before the clients change
+    tcpServer.resumeClient(spliceClient);
+    serialPort.resumeReading();
+#endif
+}
+
+void SerialBridge::leaveSplice()
+{
+#ifdef SERIALBRIDGE_WITH_SPLICE
+    if (0 == spliceClient)
+    {
+        return;
+    }
+
+    spliceTimer.cancel();
+
+    if (nullptr != splice)
+    {
+        // bytes already in the pipes are queued ahead of anything the read engines receive from now on
+        const SplicePump::Residue residue = splice->stop();
+
+        std::cout << logPrefix << "Client " << spliceClient << ": back to user space (" << splice->toNetworkBytes() << " B to network, "
+                  << splice->toSerialBytes() << " B to serial spliced)" << std::endl;
+
+        splice.reset();
+
+        if (!residue.toNetwork.empty())
+        {
+            tcpServer.sendTo(spliceClient, reinterpret_cast<const uint8_t*>(residue.toNetwork.data()), residue.toNetwork.size());
+        }
+
+        if (!residue.toSerial.empty())
+        {
+            serialPort.send(residue.toSerial);
+        }
+    }
 
-    std::cout << "Client Disconnect" << std::endl;
+    tcpServer.resumeClient(spliceClient);
+    serialPort.resumeReading();
+    spliceClient = 0;
+#endif
 }
@@ -7,34 +7,116 @@
 #include "SerialPort.h"
 #include "NetworkServer.h"
 
-/* creates a tcp server socket for bridging serial UART data into a tcp network */
-class SerialBridge :	private SerialPort::ISerialHandler,
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/asio/steady_timer.hpp>
+
+/* creates a tcp server socket for bridging serial UART data into a tcp network,
+   owned by a shared pointer so timers never call into a removed bridge */
+class SerialBridge :	public std::enable_shared_from_this<SerialBridge>,
+                        private SerialPort::ISerialHandler,
                         private INetworkHandler
 {
     Arguments  options;
+    std::string logPrefix;   /* "[name] " of a bridge from the config file */
+    boost::asio::any_io_executor strand;   /* serializes every handler of this bridge */
+    std::shared_ptr<class IoUring> uring;  /* shared by device and clients, nullptr for the asio reactor */
     SerialPort serialPort;
     NetworkServer  tcpServer;
 
     bool serialConnected = false;
-    bool tcpConnected = false;
+    bool serialCongested = false;
+    std::string serialDevice;           /* node opened last, the resolved one for a usb spec */
+    std::shared_ptr<class DeviceWatcher> deviceWatcher;   /* inotify on the device path, nullptr if polling */
+
+    /* reconnect: retries back off exponentially from options.uiReconnectMin to options.uiReconnectMax */
+    std::chrono::milliseconds reconnectDelay{ 0 };
+    unsigned reconnectAttempts = 0;
+    uint64_t reconnects = 0;
+    std::chrono::steady_clock::time_point offlineSince;   /* when a connected device was lost, epoch before */
+    std::string offlineBuffer;          /* client data of reads in flight when the pause took effect */
+    std::vector<ClientId> tcpClients;   /* in the order they connected */
+
+    std::shared_ptr<class Coalescer> coalescer;   /* between serial reads and network writes */
+    std::unique_ptr<class RingBuffer> history;    /* recent serial output for new clients, nullptr if off */
+    size_t historyLimit = 0;                      /* bytes kept, the ring itself is rounded up to a power of two */
+
+    std::shared_ptr<class Spool> spool;   /* serial data kept on disk while no client is connected, nullptr if off */
+    bool spoolDrainScheduled = false;
+
+    std::shared_ptr<class CaptureWriter> capture;   /* every chunk in either direction, nullptr if off */
+
+    std::shared_ptr<class SplicePump> splice;   /* kernel passthrough, set while it moves the data */
+    ClientId spliceClient = 0;                  /* client handed over to the pump, 0 if none */
+    unsigned spliceAttempts = 0;
+
+    boost::asio::steady_timer statsTimer;
+    boost::asio::steady_timer connectTimer;
+    boost::asio::steady_timer spliceTimer;
+    boost::asio::steady_timer spoolTimer;
+
+    void checkReadyness(ClientId client);
 
-    bool readySent = false;
+    /* opens the device once it is present, on hotplug events or polling without blocking the io service */
+    void connectSerial();
+    void onDeviceChange();
+    void disconnectSerial();
+    void goOffline();
 
-    void checkReadyness();
+    /* scrollback: the ring keeps the newest bytes, a new client gets them before live data */
+    void recordHistory(const char* msg, size_t length);
+    void replayHistory(ClientId client);
+
+    /* spool: takes the serial data while no client is connected and until the clients caught up with it */
+    bool spoolData(const char* msg, size_t length);
+    void drainSpool();
+
+    /* capture: stops recording if the file cannot grow */
+    void recordCapture(bool fromSerial, ClientId client, const char* msg, size_t length);
+
+    /* clients are not read while the device is congested, or away with the pause policy */
+    void updateNetworkPause();
+
+    /* splice passthrough: entered while a single plain tcp client is attached and nothing inspects the data */
+    bool canSplice() const;
+    void updateSplice();
+    void trySplice();
+    void leaveSplice();
+
+    /* periodic queue depth report */
+    void scheduleStatistics();
+    void printStatistics();
 
     /* serial event handling */
     void onSerialConnected() final;
+    void onSerialDisconnected() final;
     void onSerialReadComplete(const char* msg, size_t length) final;
     void onSerialWriteComplete(const char* msg, size_t length) final;
+    void onSerialCongestion(bool congested) final;
 
     /* network event handling*/
-    void onNetworkReadComplete(const char* msg, size_t length) final;
-    void onNetworkClientAccept() final;
-    void onNetworkClientDisconnect() final;
+    void onNetworkReadComplete(ClientId client, const char* msg, size_t length) final;
+    void onNetworkClientAccept(ClientId client) final;
+    void onNetworkClientDisconnect(ClientId client) final;
+    void onNetworkCongestion(bool congested) final;
 
 public:
     SerialBridge(const Arguments& options);
 
+    /* on a strand created beforehand, so the bridge can be constructed on it already */
+    SerialBridge(const Arguments& options, const boost::asio::any_io_executor& strand);
+    ~SerialBridge();
+
+    /* starts bridging as soon as the device shows up, returns immediately;
+       throws SerialPort::UNSUPPORTED_SETTINGS if the device is present but refuses the line settings */
+    void run();
+
+    /* the strand all handlers of this bridge run on, the bridge should be released there too */
+    const boost::asio::any_io_executor& executor() const { return strand; }
+
     bool isSerialAvailable() const;
 
     void waitForSerial(uint16_t waitDelayMs);
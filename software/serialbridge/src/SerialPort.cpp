@@ -13,9 +13,18 @@
 
 #include "System.h"
 #include "SerialPort.h"
+#include "RingBuffer.h"
+#include "SerialTuning.h"
 
-#include <deque>
+#ifdef SERIALBRIDGE_WITH_IO_URING
+#include "UringStream.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <map>
+#include <utility>
 #include <iostream>
 #include <boost/bind/bind.hpp>
 #include <boost/asio.hpp>
@@ -34,60 +43,231 @@ static std::map<enum SerialPort::eFlowControl, serial_port_base::flow_control> c
     std::pair<enum SerialPort::eFlowControl, serial_port_base::flow_control>(SerialPort::eFlowControl::Software, serial_port_base::flow_control::software)
 };
 
+static std::map<enum SerialPort::eParity, serial_port_base::parity> convertParity =
+{
+    std::pair<enum SerialPort::eParity, serial_port_base::parity>(SerialPort::eParity::None, serial_port_base::parity::none),
+    std::pair<enum SerialPort::eParity, serial_port_base::parity>(SerialPort::eParity::Odd, serial_port_base::parity::odd),
+    std::pair<enum SerialPort::eParity, serial_port_base::parity>(SerialPort::eParity::Even, serial_port_base::parity::even)
+};
+
+static std::map<enum SerialPort::eStopBits, serial_port_base::stop_bits> convertStopBits =
+{
+    std::pair<enum SerialPort::eStopBits, serial_port_base::stop_bits>(SerialPort::eStopBits::One, serial_port_base::stop_bits::one),
+    std::pair<enum SerialPort::eStopBits, serial_port_base::stop_bits>(SerialPort::eStopBits::OnePointFive, serial_port_base::stop_bits::onepointfive),
+    std::pair<enum SerialPort::eStopBits, serial_port_base::stop_bits>(SerialPort::eStopBits::Two, serial_port_base::stop_bits::two)
+};
+
+
+/** sets a line option, a driver rejecting it makes the port useless */
+template <class Option>
+static void setOption(serial_port & port, const Option & option, const char* what, const std::string & device)
+{
+    boost::system::error_code error;
+    port.set_option(option, error);
+
+    if (error)
+    {
+        std::cerr << "Setting " << what << " of " << device << " failed: " << error.message() << std::endl;
+        throw SerialPort::UNSUPPORTED_SETTINGS;
+    }
+}
+
+/** reads a line option back, drivers silently replace settings their hardware lacks */
+template <class Option>
+static void verifyOption(serial_port & port, const Option & expected, const char* what, const std::string & device)
+{
+    boost::system::error_code error;
+    Option applied;
+    port.get_option(applied, error);
+
+    if (error || applied.value() != expected.value())
+    {
+        std::cerr << "Setting " << what << " of " << device << " failed: not applied by the driver" << std::endl;
+        throw SerialPort::UNSUPPORTED_SETTINGS;
+    }
+}
+
+
 struct SerialPort_Params
 {
     std::string  device;
     uint32_t     baudrate = 115200;
     enum SerialPort::eFlowControl flowControl = SerialPort::eFlowControl::None;
+    uint8_t      dataBits = 8;
+    enum SerialPort::eParity parity = SerialPort::eParity::None;
+    enum SerialPort::eStopBits stopBits = SerialPort::eStopBits::One;
+    size_t       rxBufferSize = 512;
+    size_t       rxBufferCount = 2;
+    size_t       txHighWatermark = 48 * 1024;
+    size_t       txLowWatermark = 16 * 1024;
+    enum SerialPort::eLatencyMode latencyMode = SerialPort::eLatencyMode::System;
+    uint32_t     latencyTimerMs = 0;         /**< overrides the latency timer of the mode, 0 keeps it */
     SerialPort::ISerialHandler* handler = nullptr;
+    any_io_executor executor;
+    std::shared_ptr<IoUring> uring;      /**< transfers through the ring instead of the reactor if set */
 
-    SerialPort_Params(const std::string& device, uint32_t baudrate, enum SerialPort::eFlowControl flowControl)
-        : device(device), baudrate(baudrate), flowControl(flowControl)
+    SerialPort_Params(const std::string& device, uint32_t baudrate, enum SerialPort::eFlowControl flowControl, const any_io_executor& executor)
+        : device(device), baudrate(baudrate), flowControl(flowControl), executor(executor)
     {}
 
 };
 
-struct SerialPort_Private
+/** pending operations hold a reference to their port, so completions never outlive it */
+struct SerialPort_Private : std::enable_shared_from_this<SerialPort_Private>
 {
-    static constexpr size_t RX_BUF_SIZE = 512;
+    static constexpr size_t TX_HEADROOM = 64 * 1024;  /**< ring space above the high watermark for network reads completing until the pause took effect */
 
-    bool 	               m_active = true;
-    io_service &           m_ioService;
+    std::atomic<bool>      m_active{ true };         /**< also read by isActive() from other threads */
+    any_io_executor        m_executor;               /**< completions of the port, usually the strand of its bridge */
     serial_port            m_serialPort;
+#ifdef SERIALBRIDGE_WITH_IO_URING
+    std::unique_ptr<UringStream> m_uring;            /**< reads and writes of the device if io_uring is used */
+#endif
 
-    std::vector<char>      m_rxBuffer;
-    std::deque<char>       m_txBuffer;
+    std::vector<char>      m_rxBuffer;               /**< m_rxBufferCount slices of m_rxBufferSize bytes */
+    size_t                 m_rxBufferSize;
+    size_t                 m_rxBufferCount;
+    size_t                 m_rxIndex = 0;            /**< slice the pending read fills */
+    RingBuffer             m_txBuffer;               /**< filled by the producer, drained by the write engine */
+    RingBuffer::ConstBuffers m_txSegments;           /**< ring regions owned by the pending write */
+    std::atomic<bool>      m_txScheduled{ false };   /**< true while a write is pending or posted */
+    const size_t           m_txHighWatermark;
+    const size_t           m_txLowWatermark;
+    std::atomic<bool>      m_txCongested{ false };
+
+    std::atomic<bool>      m_rxPaused{ false };      /**< reads are not re-armed while set, read by statistics() */
+    bool                   m_rxPending = false;      /**< a read is outstanding on the device */
+    bool                   m_rxSuspended = false;    /**< the device is handed over to a splice pump, reads stay off */
+    bool                   m_rxCancelled = false;    /**< the pending read was cancelled for the hand-over */
+
+    std::atomic<uint64_t>  m_rxBytes{ 0 };
+    std::atomic<uint64_t>  m_txBytes{ 0 };
+    std::atomic<uint64_t>  m_txDroppedBytes{ 0 };
+
+    uint32_t               m_baudrate = 0;           /**< as read back after opening */
+    SerialPort::Latency    m_latency;                /**< tty settings as read back after opening */
 
     // completion event handlers
-    SerialPort::ISerialHandler* & m_handler;
+    std::shared_ptr<SerialPort_Params> m_params;
+    SerialPort::ISerialHandler* &      m_handler;
+
+
+    SerialPort_Private(const std::shared_ptr<SerialPort_Params> & params)
+        : m_executor(params->executor),
+          m_serialPort(m_executor, params->device),
+          m_rxBufferSize(params->rxBufferSize),
+          m_rxBufferCount(params->rxBufferCount),
+          m_txBuffer(params->txHighWatermark + TX_HEADROOM),
+          m_txHighWatermark(params->txHighWatermark),
+          m_txLowWatermark(std::min(params->txLowWatermark, params->txHighWatermark)),
+          m_params(params),
+          m_handler(params->handler)
+    {
+        m_rxBuffer.resize(m_rxBufferSize * m_rxBufferCount);
+
+        const serial_port_base::character_size dataBits(params->dataBits);
+        setOption(m_serialPort, dataBits, "data bits", params->device);
+        setOption(m_serialPort, convertParity[params->parity], "parity", params->device);
+        setOption(m_serialPort, convertStopBits[params->stopBits], "stop bits", params->device);
+        setOption(m_serialPort, convertFlowControl[params->flowControl], "flow control", params->device);
+#ifdef __linux__
+        m_latency = applyLatencyMode(m_serialPort.native_handle(), params->device, params->latencyMode, params->latencyTimerMs);
 
+        // last, so no later tcsetattr touches it: asio only knows the Bxxx rates, termios2 takes any the uart can divide down to
+        m_baudrate = applyBaudrate(m_serialPort.native_handle(), params->baudrate);
 
-    SerialPort_Private(SerialPort_Params & params)
-        : m_ioService(System::IOService()),
-          m_serialPort(m_ioService, params.device),
-          m_handler(params.handler)
+        if (std::abs(static_cast<double>(m_baudrate) - params->baudrate) > BAUDRATE_TOLERANCE * params->baudrate)
+        {
+            std::cerr << "Baud rate " << params->baudrate << " not supported by " << params->device
+                      << " (driver applied " << m_baudrate << ")" << std::endl;
+            throw SerialPort::UNSUPPORTED_SETTINGS;
+        }
+
+        if (m_baudrate != params->baudrate)
+        {
+            std::cout << "Baud rate " << params->baudrate << " approximated by " << m_baudrate << std::endl;
+        }
+#else
+        m_serialPort.set_option(serial_port_base::baud_rate(params->baudrate));
+        m_baudrate = params->baudrate;
+#endif
+
+        // read back once everything is set, after the baud rate no further settings are written
+        verifyOption(m_serialPort, dataBits, "data bits", params->device);
+        verifyOption(m_serialPort, convertParity[params->parity], "parity", params->device);
+        verifyOption(m_serialPort, convertStopBits[params->stopBits], "stop bits", params->device);
+        verifyOption(m_serialPort, convertFlowControl[params->flowControl], "flow control", params->device);
+
+#ifdef SERIALBRIDGE_WITH_IO_URING
+        if (nullptr != params->uring)
+        {
+            // the kernel cycles through at least 8 buffers, so a burst does not starve the multishot read
+            m_uring.reset(new UringStream(params->uring, m_serialPort.native_handle(), UringStream::eKind::Device,
+                                          m_rxBufferSize, std::max<size_t>(8, m_rxBufferCount)));
+        }
+#endif
+    }
+
+
+    /** read and write completions, the same for the reactor and the io_uring */
+    template <class Stream>
+    void read(Stream & stream)
     {
-        m_rxBuffer.resize(RX_BUF_SIZE);
-        m_serialPort.set_option(serial_port_base::baud_rate(params.baudrate));
-        m_serialPort.set_option( convertFlowControl[params.flowControl]);
+        stream.async_read_some(boost::asio::buffer(&m_rxBuffer[m_rxIndex * m_rxBufferSize], m_rxBufferSize),
+            boost::bind(&SerialPort_Private::ReadOperationComplete,
+                shared_from_this(),
+                placeholders::error,
+                placeholders::bytes_transferred
+            )
+        );
+    }
+
+    template <class Stream>
+    void write(Stream & stream)
+    {
+        boost::asio::async_write(stream,
+            m_txSegments,
+            boost::bind(&SerialPort_Private::WriteOperationComplete,
+                shared_from_this(),
+                placeholders::error,
+                placeholders::bytes_transferred)
+        );
+    }
+
+    bool isUsingIoUring() const
+    {
+#ifdef SERIALBRIDGE_WITH_IO_URING
+        return nullptr != m_uring;
+#else
+        return false;
+#endif
     }
 
 
 
     bool StartReading() noexcept
     {
+        if (m_rxPaused || m_rxSuspended || m_rxPending)
+        {
+            return true;
+        }
+
         try
         {
-            m_serialPort.async_read_some(boost::asio::buffer(m_rxBuffer.data(), RX_BUF_SIZE),
-                boost::bind(&SerialPort_Private::ReadOperationComplete,
-                    this,
-                    placeholders::error,
-                    placeholders::bytes_transferred
-                )
-            );
+            m_rxPending = true;
+
+#ifdef SERIALBRIDGE_WITH_IO_URING
+            if (nullptr != m_uring)
+            {
+                read(*m_uring);
+                return true;
+            }
+#endif
+            read(m_serialPort);
         }
         catch (...)
         {
+            m_rxPending = false;
             return false;
         }
 
@@ -95,19 +275,38 @@ struct SerialPort_Private
     }
 
 
+    /** writes everything readable from the ring within one gather write, runs on the io service only */
     bool StartWriting() noexcept
     {
         try
         {
-            boost::asio::async_write(m_serialPort,
-                boost::asio::buffer(&m_txBuffer.front(), 1),
-                boost::bind(&SerialPort_Private::WriteOperationComplete,
-                    this,
-                    placeholders::error)
-            );
+            m_txSegments = m_txBuffer.data();
+
+            if (0 == boost::asio::buffer_size(m_txSegments))
+            {
+                m_txScheduled = false;
+
+                // a producer may have committed data right before the flag was released
+                if (m_txBuffer.empty() || m_txScheduled.exchange(true))
+                {
+                    return true;
+                }
+
+                m_txSegments = m_txBuffer.data();
+            }
+
+#ifdef SERIALBRIDGE_WITH_IO_URING
+            if (nullptr != m_uring)
+            {
+                write(*m_uring);
+                return true;
+            }
+#endif
+            write(m_serialPort);
         }
         catch (...)
         {
+            m_txScheduled = false;
             return false;
         }
 
@@ -118,98 +317,161 @@ struct SerialPort_Private
 
     void ReadOperationComplete(const boost::system::error_code& oError, size_t nBytesReceived)
     {
+        m_rxPending = false;
+
+        // cancelled for a splice hand-over: nothing went wrong, re-armed unless still suspended
+        if (std::exchange(m_rxCancelled, false) && oError == boost::asio::error::operation_aborted)
+        {
+            StartReading();
+            return;
+        }
+
         if (oError)
         {
             close(oError);
         }
         else
         {
-            if (nBytesReceived > 0)
-            {
-                if (nullptr != m_handler)
-                {
-                    m_handler->onSerialReadComplete(m_rxBuffer.data(), nBytesReceived);
-                }
+            const char* received = &m_rxBuffer[m_rxIndex * m_rxBufferSize];
 
-                m_rxBuffer.clear();
-                m_rxBuffer.resize(RX_BUF_SIZE);
-            }
+            // re-arm the uart on the next slice first, so the kernel keeps draining while the chunk is handled
+            m_rxIndex = (m_rxIndex + 1) % m_rxBufferCount;
 
             if (!StartReading())
             {
                 //ExecuteCloseOperation(oError); //< todo: not sure if still necessary
             }
+
+            m_rxBytes += nBytesReceived;
+
+            if (nBytesReceived > 0 && nullptr != m_handler)
+            {
+                m_handler->onSerialReadComplete(received, nBytesReceived);
+            }
         }
     }
 
 
 
-    void WriteOperationComplete(const boost::system::error_code& oError)
+    void WriteOperationComplete(const boost::system::error_code& oError, size_t nBytesSent)
     {
         if (oError)
         {
+            m_txScheduled = false;
             close(oError);
         }
         else
         {
             if (nullptr != m_handler)
             {
-                m_handler->onSerialWriteComplete(&m_txBuffer.front(), 1);
+                for (const const_buffer & segment : m_txSegments)
+                {
+                    if (segment.size() > 0)
+                    {
+                        m_handler->onSerialWriteComplete(static_cast<const char*>(segment.data()), segment.size());
+                    }
+                }
             }
 
-            m_txBuffer.pop_front();
+            m_txBuffer.consume(nBytesSent);
+            m_txBytes += nBytesSent;
 
-            if (!m_txBuffer.empty())
+            if (m_txBuffer.size() <= m_txLowWatermark && m_txCongested.exchange(false))
             {
-                if (!StartWriting())
+                if (nullptr != m_handler)
                 {
-                    //ExecuteCloseOperation(oError); //< todo: not sure if still necessary
+                    m_handler->onSerialCongestion(false);
                 }
             }
+
+            if (!StartWriting())
+            {
+                //ExecuteCloseOperation(oError); //< todo: not sure if still necessary
+            }
         }
     }
 
 
 
-    void sendChar(const char msg)
+    /** copies data into the tx ring from the producer thread and kicks the write engine if idle */
+    bool send(const char* msg, size_t length)
     {
-        bool bWriteInProgress = !m_txBuffer.empty();
+        const size_t queued = m_txBuffer.write(msg, length);
+
+        if (queued < length)
+        {
+            m_txDroppedBytes += length - queued;
+        }
 
-        m_txBuffer.push_back(msg);
+        if (queued > 0 && !m_txScheduled.exchange(true))
+        {
+            boost::asio::post(m_executor, boost::bind(&SerialPort_Private::StartWriting, shared_from_this()));
+        }
 
-        if (!bWriteInProgress)
+        if (m_txBuffer.size() >= m_txHighWatermark && !m_txCongested.exchange(true))
         {
-            StartWriting();
+            boost::asio::post(m_executor, boost::bind(&SerialPort_Private::notifyCongestion, shared_from_this()));
         }
+
+        return queued == length;
     }
 
-    void sendText(const std::string & msg)
+
+    /** reports the high watermark on the io service, unless the queue drained meanwhile */
+    void notifyCongestion()
     {
-        if (!msg.empty())
+        if (m_txCongested && nullptr != m_handler)
         {
-            bool bWriteInProgress = !m_txBuffer.empty();
+            m_handler->onSerialCongestion(true);
+        }
+    }
 
-            std::copy(msg.begin(), msg.end(), std::back_inserter(m_txBuffer));
 
-            if (!bWriteInProgress)
-            {
-                StartWriting();
-            }
+    void pauseReading(bool pause)
+    {
+        m_rxPaused = pause;
+
+        if (!m_rxPaused && m_active)
+        {
+            StartReading();
         }
     }
 
-    void sendBinary(const uint8_t* const msg, size_t length)
+
+    /** stops reading for a hand-over of the device; returns its descriptor once no read or write is in flight, -1 until then */
+    int suspendReading()
     {
-        if (nullptr != msg)
+#ifdef WIN32
+        return -1;
+#else
+        // completions buffered by the multishot read would be overtaken by the pump
+        if (!m_active || isUsingIoUring())
         {
-            bool bWriteInProgress = !m_txBuffer.empty();
+            return -1;
+        }
 
-            std::copy(msg, msg + length, std::back_inserter(m_txBuffer));
+        m_rxSuspended = true;
 
-            if (!bWriteInProgress)
-            {
-                StartWriting();
-            }
+        // the cancel hits pending writes as well, so an ongoing write is awaited first
+        if (m_rxPending && !m_rxCancelled && !m_txScheduled)
+        {
+            boost::system::error_code ignored;
+            m_rxCancelled = true;
+            m_serialPort.cancel(ignored);
+        }
+
+        return (m_rxPending || m_txScheduled || !m_txBuffer.empty()) ? -1 : m_serialPort.native_handle();
+#endif
+    }
+
+
+    void resumeReading()
+    {
+        m_rxSuspended = false;
+
+        if (m_active)
+        {
+            StartReading();
         }
     }
 
@@ -218,12 +480,33 @@ struct SerialPort_Private
     {
         if (oError == boost::asio::error::operation_aborted)
         {
-            std::cerr << "SerialPort Error: " << oError.message() << std::endl;
+            // pending operations of a port closed on purpose end this way
+            if (m_active)
+            {
+                std::cerr << "SerialPort Error: " << oError.message() << std::endl;
+            }
         }
         else
         {
-            m_serialPort.close();
-            m_active = false;
+#ifdef SERIALBRIDGE_WITH_IO_URING
+            if (nullptr != m_uring)
+            {
+                m_uring->cancel();
+            }
+#endif
+            boost::system::error_code ignored;
+            m_serialPort.close(ignored);
+
+            // a failing read and write report the device once, closing on purpose comes without an error
+            if (m_active.exchange(false) && oError)
+            {
+                std::cerr << "SerialPort Error: " << oError.message() << std::endl;
+
+                if (nullptr != m_handler)
+                {
+                    m_handler->onSerialDisconnected();
+                }
+            }
         }
     }
 
@@ -255,8 +538,17 @@ static bool isSerialPortPresent(const std::string& deviceName)
 ///////////////////////////
 
 
+const char* const SerialPort::UNSUPPORTED_SETTINGS = "Serial line settings not supported by the device!";
+
+
 SerialPort::SerialPort(const std::string& device, uint32_t baudRate, enum SerialPort::eFlowControl flowControl)
-    :   m_params(new SerialPort_Params(device, baudRate, flowControl)),
+    :   SerialPort(device, baudRate, flowControl, System::IOService().get_executor())
+{
+}
+
+
+SerialPort::SerialPort(const std::string& device, uint32_t baudRate, enum SerialPort::eFlowControl flowControl, const any_io_executor& executor)
+    :   m_params(new SerialPort_Params(device, baudRate, flowControl, executor)),
         m_private(nullptr)
 {
 }
@@ -300,7 +592,11 @@ void SerialPort::awaitConnection(uint16_t waitMs)
         {
             try
             {
-                m_private = std::shared_ptr<SerialPort_Private>(new SerialPort_Private(*m_params));
+                m_private = std::make_shared<SerialPort_Private>(m_params);
+            }
+            catch (const char* const)
+            {
+                throw;
             }
             catch (...)
             {
@@ -312,7 +608,14 @@ void SerialPort::awaitConnection(uint16_t waitMs)
                 m_params->handler->onSerialConnected();
             }
 
-            std::cout << "Serial port connected" << std::endl;
+            static const char* const parity = "NOE";
+            static const char* const stopBits[] = { "1", "1.5", "2" };
+            static const char* const flowControl[] = { "no", "rts/cts", "xon/xoff" };
+
+            std::cout << "Serial port " << m_params->device << " connected (" << m_private->m_baudrate << " baud, "
+                      << static_cast<unsigned>(m_params->dataBits) << parity[static_cast<size_t>(m_params->parity)]
+                      << stopBits[static_cast<size_t>(m_params->stopBits)] << ", "
+                      << flowControl[static_cast<size_t>(m_params->flowControl)] << " flow control)" << std::endl;
         }
         else
         {
@@ -335,6 +638,15 @@ bool SerialPort::start()
 }
 
 
+void SerialPort::setDevice(const std::string& device)
+{
+    if (nullptr != m_params)
+    {
+        m_params->device = device;
+    }
+}
+
+
 void SerialPort::setHandler(ISerialHandler* const handler)
 {
     if (nullptr != m_params)
@@ -344,21 +656,100 @@ void SerialPort::setHandler(ISerialHandler* const handler)
 }
 
 
+void SerialPort::setReceiveBuffers(size_t bufferSize, size_t bufferCount)
+{
+    if (nullptr != m_params)
+    {
+        m_params->rxBufferSize = std::max<size_t>(1, bufferSize);
+        m_params->rxBufferCount = std::max<size_t>(2, bufferCount);
+    }
+}
+
+
+void SerialPort::setQueueLimits(size_t highWatermark, size_t lowWatermark)
+{
+    if (nullptr != m_params)
+    {
+        m_params->txHighWatermark = std::max<size_t>(1, highWatermark);
+        m_params->txLowWatermark = std::min(lowWatermark, m_params->txHighWatermark);
+    }
+}
+
+
+void SerialPort::setFraming(uint8_t dataBits, eParity parity, eStopBits stopBits)
+{
+    if (nullptr != m_params)
+    {
+        m_params->dataBits = dataBits;
+        m_params->parity = parity;
+        m_params->stopBits = stopBits;
+    }
+}
+
+
+void SerialPort::setLatencyMode(eLatencyMode mode, uint32_t latencyTimerMs)
+{
+    if (nullptr != m_params)
+    {
+        m_params->latencyMode = mode;
+        m_params->latencyTimerMs = latencyTimerMs;
+    }
+}
+
+
+void SerialPort::setIoUring(const std::shared_ptr<IoUring>& uring)
+{
+    if (nullptr != m_params)
+    {
+        m_params->uring = uring;
+    }
+}
+
+
+bool SerialPort::isUsingIoUring() const
+{
+    return nullptr != m_private && m_private->isUsingIoUring();
+}
+
+
+void SerialPort::pauseReading(bool pause)
+{
+    if (nullptr != m_private)
+    {
+        boost::asio::post(m_private->m_executor, boost::bind(&SerialPort_Private::pauseReading, m_private, pause));
+    }
+}
+
+
+int SerialPort::suspendReading()
+{
+    return nullptr != m_private ? m_private->suspendReading() : -1;
+}
+
+
+void SerialPort::resumeReading()
+{
+    if (nullptr != m_private)
+    {
+        m_private->resumeReading();
+    }
+}
+
+
 bool SerialPort::send(const char cMsg) noexcept
 {
-	try
-	{
-                if (nullptr != m_private)
-                {
-		    m_private->m_ioService.post(boost::bind(&SerialPort_Private::sendChar, m_private.get(), cMsg));
-                    return true;
-                }
-	}
-	catch (...)
-	{
-	}
+    try
+    {
+        if (nullptr != m_private)
+        {
+            return m_private->send(&cMsg, 1);
+        }
+    }
+    catch (...)
+    {
+    }
 
-	return false;
+    return false;
 }
 
 
@@ -368,10 +759,7 @@ bool SerialPort::send(const std::string& text)
     {
         if (nullptr != m_private)
         {
-            m_private->m_ioService.post(boost::bind(&SerialPort_Private::sendText,
-                m_private.get(),
-                text));
-            return true;
+            return m_private->send(text.data(), text.size());
         }
     }
     catch (...)
@@ -387,13 +775,9 @@ bool SerialPort::send(const uint8_t* const data, size_t length)
 {
     try
     {
-        if (nullptr != m_private)
+        if (nullptr != m_private && nullptr != data)
         {
-            m_private->m_ioService.post(boost::bind(&SerialPort_Private::sendBinary,
-                m_private.get(),
-                data,
-                length));
-            return true;
+            return m_private->send(reinterpret_cast<const char*>(data), length);
         }
     }
     catch (...)
@@ -410,8 +794,9 @@ bool SerialPort::close() noexcept
 	{
             if (nullptr != m_private)
             {
-		m_private->m_ioService.post(boost::bind(&SerialPort_Private::close,
-			m_private.get(),
+		// inline when called on the port's strand, so a removed bridge frees its device right away
+		boost::asio::dispatch(m_private->m_executor, boost::bind(&SerialPort_Private::close,
+			m_private,
 			boost::system::error_code()));
                 return true;
             }
@@ -435,5 +820,21 @@ bool SerialPort::isActive() const
 }
 
 
+SerialPort::Statistics SerialPort::statistics() const
+{
+    Statistics stats;
 
+    if (nullptr != m_private)
+    {
+        stats.rxBytes = m_private->m_rxBytes;
+        stats.txBytes = m_private->m_txBytes;
+        stats.txDroppedBytes = m_private->m_txDroppedBytes;
+        stats.txQueuedBytes = m_private->m_txBuffer.size();
+        stats.txCongested = m_private->m_txCongested;
+        stats.rxPaused = m_private->m_rxPaused;
+        stats.baudrate = m_private->m_baudrate;
+        stats.latency = m_private->m_latency;
+    }
 
+    return stats;
+}
@@ -9,9 +9,12 @@
  * @copyright	GPLv3
  */
 
+#include <cstdint>
 #include <string>
 #include <memory>
 
+#include <boost/asio/any_io_executor.hpp>
+
 /** */
 class SerialPort
 {
@@ -20,14 +23,63 @@ class SerialPort
 
 public:
 
+	/** thrown on connect if the driver does not apply the requested line settings, retrying cannot help */
+	static const char* const UNSUPPORTED_SETTINGS;
+
 	class ISerialHandler
 	{
 	public:
 		virtual ~ISerialHandler() {}
 
 		virtual void onSerialConnected() = 0;
+
+		/** the device failed or went away and the port closed itself, not called for close() */
+		virtual void onSerialDisconnected() = 0;
+
 		virtual void onSerialReadComplete(const char* msg, size_t length) = 0;
 		virtual void onSerialWriteComplete(const char* msg, size_t length) = 0;
+
+		/** the tx queue crossed the high watermark (true) or drained to the low watermark (false) */
+		virtual void onSerialCongestion(bool congested) = 0;
+	};
+
+	/** what a bridge does with client data while its device is away */
+	enum class eOfflinePolicy : uint8_t
+	{
+		Pause = 0,   /**< clients are not read, their data waits in the socket buffers until the device is back */
+		Drop = 1,    /**< client data is discarded */
+		Notify = 2   /**< discarded, and the clients get a status line when the device is lost */
+	};
+
+	/** trade-off between the delay of single bytes and the number of wake-ups per byte */
+	enum class eLatencyMode : uint8_t
+	{
+		System = 0,     /**< leaves the driver settings as they are */
+		LowLatency = 1, /**< ASYNC_LOW_LATENCY and a 1 ms usb-serial latency timer (consoles, request/response) */
+		Batching = 2    /**< driver collects bytes for a full latency timer period (bulk streams) */
+	};
+
+	/** tty settings read back after the latency mode was applied */
+	struct Latency
+	{
+		eLatencyMode mode = eLatencyMode::System;
+		int      lowLatency = -1;      /**< ASYNC_LOW_LATENCY flag, -1 if the driver has no serial_struct (e.g. ptys) */
+		int      latencyTimerMs = -1;  /**< usb-serial latency timer, -1 if the device has none or it is not readable */
+		unsigned vmin = 0;
+		unsigned vtime = 0;            /**< deciseconds */
+	};
+
+	/** transfer counters and queue state */
+	struct Statistics
+	{
+		uint64_t rxBytes = 0;
+		uint64_t txBytes = 0;
+		uint64_t txDroppedBytes = 0;
+		size_t   txQueuedBytes = 0;
+		bool     txCongested = false;
+		bool     rxPaused = false;
+		uint32_t baudrate = 0;        /**< as applied by the driver */
+		Latency  latency;
 	};
 
 
@@ -39,9 +91,26 @@ public:
 		Software = 2
 	};
 
+	enum class eParity : uint8_t
+	{
+		None = 0,
+		Odd = 1,
+		Even = 2
+	};
+
+	enum class eStopBits : uint8_t
+	{
+		One = 0,
+		OnePointFive = 1,  /**< windows only, posix drivers have no such setting */
+		Two = 2
+	};
+
 	/** connects to given serial port device (e.g. \\.\COM1, /dev/ttyUSB0, /dev/cu0) with the given USART parameters (e.g. 115200, NoFlowControl) */
 	SerialPort(const std::string& device, uint32_t baudRate, SerialPort::eFlowControl flowControl);
 
+	/** same, with all completions running on the given executor (e.g. the strand of a bridge) */
+	SerialPort(const std::string& device, uint32_t baudRate, SerialPort::eFlowControl flowControl, const boost::asio::any_io_executor& executor);
+
 	SerialPort(const SerialPort&);
 	~SerialPort() noexcept;
 
@@ -53,16 +122,49 @@ public:
 	/** starts the communication */
 	bool start();
 
+	/** changes the device path, e.g. to the node a usb adapter got after replugging (applied on next connect) */
+	void setDevice(const std::string& device);
+
 	/** defines asynchronous read or write completion handlers */
 	void setHandler(ISerialHandler* const handler);
 
-	/** transmit single character */
+	/** sets size and number of the receive buffers, the next read is posted on a spare buffer before a chunk is handled (applied on next connect) */
+	void setReceiveBuffers(size_t bufferSize, size_t bufferCount);
+
+	/** sets the tx queue watermarks in bytes, the queue holds at least highWatermark bytes (applied on next connect) */
+	void setQueueLimits(size_t highWatermark, size_t lowWatermark);
+
+	/** sets data bits (5-8), parity and stop bits, checked against what the driver applied (applied on next connect) */
+	void setFraming(uint8_t dataBits, eParity parity, eStopBits stopBits);
+
+	/** sets the latency mode, latencyTimerMs overrides the usb-serial latency timer of the mode (0 keeps it; applied on next connect) */
+	void setLatencyMode(eLatencyMode mode, uint32_t latencyTimerMs = 0);
+
+	/** transfers through the given io_uring instead of the asio reactor, nullptr for asio;
+	 *  the ring has to run on the executor of the port (applied on next connect) */
+	void setIoUring(const std::shared_ptr<class IoUring>& uring);
+
+	/** true if the current connection transfers through an io_uring */
+	bool isUsingIoUring() const;
+
+	/** stops or restarts reading from the device, so hardware flow control throttles the sender */
+	void pauseReading(bool pause);
+
+	/** stops reading so a splice pump can take over the device; returns its descriptor once no read or
+	 *  write is in flight, -1 until then (call again) or if the port is closed or uses the io_uring.
+	 *  Runs on the executor of the port. */
+	int suspendReading();
+
+	/** hands the device back to the read engine after a splice pump stopped */
+	void resumeReading();
+
+	/** transmit single character, false if it could not be queued (tx buffer full or port closed) */
 	bool send(const char cMsg) noexcept;
 
 	/** transmit text */
 	bool send(const std::string& text);
 
-	/** transmit buffer */
+	/** transmit buffer, copied into the tx queue before returning; may be called from another thread than the io service */
 	bool send(const uint8_t* const data, size_t length);
 
 	/** closes device */
@@ -71,6 +173,9 @@ public:
 	/** true if still transceiving */
 	bool isActive() const;
 
+	/** current transfer counters */
+	Statistics statistics() const;
+
 };
 
 
@@ -0,0 +1,146 @@
+/**
+ * @file		SerialTuning.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include "SerialTuning.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef __linux__
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+
+#include <boost/filesystem.hpp>
+#endif
+
+
+uint32_t defaultLatencyTimer(SerialPort::eLatencyMode mode)
+{
+    switch (mode)
+    {
+    case SerialPort::eLatencyMode::LowLatency: return 1;
+    case SerialPort::eLatencyMode::Batching: return 16;   // the power-on default of FTDI and most usb-serial chips
+    default: return 0;
+    }
+}
+
+
+#ifdef __linux__
+/** sysfs attribute of the usb-serial port behind a tty, empty if there is none */
+static std::string latencyTimerPath(const std::string& device)
+{
+    boost::system::error_code error;
+
+    // resolves /dev/serial/by-id links to the tty node
+    const boost::filesystem::path node = boost::filesystem::canonical(device, error);
+
+    if (error)
+    {
+        return std::string();
+    }
+
+    const boost::filesystem::path attribute = boost::filesystem::path("/sys/class/tty") / node.filename() / "device" / "latency_timer";
+
+    return boost::filesystem::exists(attribute, error) ? attribute.string() : std::string();
+}
+
+static int readLatencyTimer(const std::string& path)
+{
+    std::ifstream attribute(path);
+    int milliseconds = -1;
+
+    attribute >> milliseconds;
+
+    return attribute ? milliseconds : -1;
+}
+
+static bool writeLatencyTimer(const std::string& path, uint32_t milliseconds)
+{
+    std::ofstream attribute(path);
+
+    attribute << milliseconds;
+    attribute.flush();
+
+    return static_cast<bool>(attribute);
+}
+#endif
+
+
+SerialPort::Latency applyLatencyMode(int fd, const std::string& device, SerialPort::eLatencyMode mode, uint32_t latencyTimerMs)
+{
+    SerialPort::Latency latency;
+    latency.mode = mode;
+
+#ifdef __linux__
+    termios settings;
+
+    if (0 == ::tcgetattr(fd, &settings))
+    {
+        // asio opens the tty raw with VMIN 1 and VTIME 0, the only values the non-blocking reactor works with: with VMIN 0 a read
+        // of an empty tty returns 0 (taken for end of file), VMIN > 1 without VTIME hides the tail of a burst from epoll
+        settings.c_cc[VMIN] = 1;
+        settings.c_cc[VTIME] = 0;
+
+        if (0 != ::tcsetattr(fd, TCSANOW, &settings))
+        {
+            std::cerr << "Setting VMIN/VTIME of " << device << " failed: " << std::strerror(errno) << std::endl;
+        }
+
+        if (0 == ::tcgetattr(fd, &settings))
+        {
+            latency.vmin = settings.c_cc[VMIN];
+            latency.vtime = settings.c_cc[VTIME];
+        }
+    }
+
+    serial_struct serial;
+
+    if (0 == ::ioctl(fd, TIOCGSERIAL, &serial))
+    {
+        const bool lowLatency = SerialPort::eLatencyMode::LowLatency == mode;
+
+        // a user may change the flag without privileges; ftdi_sio also moves its latency timer along (1 / 16 ms)
+        if (SerialPort::eLatencyMode::System != mode && lowLatency != (0 != (serial.flags & ASYNC_LOW_LATENCY)))
+        {
+            serial.flags = lowLatency ? (serial.flags | ASYNC_LOW_LATENCY) : (serial.flags & ~ASYNC_LOW_LATENCY);
+
+            if (0 != ::ioctl(fd, TIOCSSERIAL, &serial))
+            {
+                std::cerr << "Setting ASYNC_LOW_LATENCY of " << device << " failed: " << std::strerror(errno) << std::endl;
+            }
+        }
+
+        if (0 == ::ioctl(fd, TIOCGSERIAL, &serial))
+        {
+            latency.lowLatency = (0 != (serial.flags & ASYNC_LOW_LATENCY)) ? 1 : 0;
+        }
+    }
+
+    const std::string timer = latencyTimerPath(device);
+
+    if (!timer.empty())
+    {
+        const uint32_t milliseconds = latencyTimerMs > 0 ? latencyTimerMs : defaultLatencyTimer(mode);
+
+        if (milliseconds > 0 && static_cast<int>(milliseconds) != readLatencyTimer(timer) && !writeLatencyTimer(timer, milliseconds))
+        {
+            std::cerr << "Setting the latency timer of " << device << " failed (needs write access to " << timer << ")" << std::endl;
+        }
+
+        latency.latencyTimerMs = readLatencyTimer(timer);
+    }
+#else
+    (void) fd;
+    (void) device;
+    (void) latencyTimerMs;
+#endif
+
+    return latency;
+}
@@ -0,0 +1,30 @@
+#ifndef SERIALTUNING_H_E25C9B47_0D6F_4A31_93B8_7F14C6A2D580
+#define SERIALTUNING_H_E25C9B47_0D6F_4A31_93B8_7F14C6A2D580
+
+/**
+ * @file		SerialTuning.h
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include <string>
+
+#include "SerialPort.h"
+
+
+/** maximum deviation of the baud rate applied by the driver, within what uart receivers tolerate */
+constexpr double BAUDRATE_TOLERANCE = 0.02;
+
+/** sets any baud rate through termios2 (BOTHER) and returns the rate the driver reports back, 0 if it refused;
+ *  implemented in SerialBaudrate.cpp */
+uint32_t applyBaudrate(int fd, uint32_t baudrate);
+
+/** usb-serial latency timer of the mode, used unless the user gave one */
+uint32_t defaultLatencyTimer(SerialPort::eLatencyMode mode);
+
+/** sets VMIN/VTIME, the ASYNC_LOW_LATENCY flag and the usb-serial latency timer of an open tty and
+ *  reads back what the driver applied; parts the driver or device lacks are reported as unknown */
+SerialPort::Latency applyLatencyMode(int fd, const std::string& device, SerialPort::eLatencyMode mode, uint32_t latencyTimerMs);
+
+#endif /* SERIALTUNING_H_E25C9B47_0D6F_4A31_93B8_7F14C6A2D580 */
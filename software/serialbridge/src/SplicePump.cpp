@@ -0,0 +1,287 @@
+/**
+ * @file		SplicePump.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include "SplicePump.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/** duplicate of a descriptor owned by someone else, non-blocking like the original */
+static int duplicate(int fd)
+{
+    const int copy = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+
+    if (copy < 0)
+    {
+        throw "Failed to duplicate descriptor!";
+    }
+
+    // the flag lives in the shared file description, asio has set it already for its own operations
+    ::fcntl(copy, F_SETFL, ::fcntl(copy, F_GETFL) | O_NONBLOCK);
+
+    return copy;
+}
+
+static void closePipe(int (&pipe)[2])
+{
+    for (int & fd : pipe)
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+}
+
+
+std::shared_ptr<SplicePump> SplicePump::create(const boost::asio::any_io_executor & executor, int serialFd, int socketFd)
+{
+    try
+    {
+        return std::make_shared<SplicePump>(executor, serialFd, socketFd);
+    }
+    catch (const char* const text)
+    {
+        std::cerr << "splice: " << text << " (" << std::strerror(errno) << "), staying in user space" << std::endl;
+    }
+
+    return nullptr;
+}
+
+
+SplicePump::SplicePump(const boost::asio::any_io_executor & executor, int serialFd, int socketFd)
+    : m_executor(executor),
+      m_serial(executor),
+      m_network(executor)
+{
+    try
+    {
+        if (0 != ::pipe2(m_toNetwork.pipe, O_NONBLOCK | O_CLOEXEC) ||
+            0 != ::pipe2(m_toSerial.pipe, O_NONBLOCK | O_CLOEXEC))
+        {
+            throw "Failed to create pipes!";
+        }
+
+        m_serial.assign(duplicate(serialFd));
+        m_network.assign(duplicate(socketFd));
+    }
+    catch (...)
+    {
+        closePipe(m_toNetwork.pipe);
+        closePipe(m_toSerial.pipe);
+        throw;
+    }
+
+    const int pipeSize = ::fcntl(m_toNetwork.pipe[1], F_GETPIPE_SZ);
+    m_pipeSize = pipeSize > 0 ? static_cast<size_t>(pipeSize) : 65536;
+
+    m_toNetwork.source = &m_serial;
+    m_toNetwork.sink = &m_network;
+    m_toNetwork.sourceClosed = eStop::SerialClosed;
+    m_toNetwork.sinkClosed = eStop::NetworkClosed;
+
+    m_toSerial.source = &m_network;
+    m_toSerial.sink = &m_serial;
+    m_toSerial.sourceClosed = eStop::NetworkClosed;
+    m_toSerial.sinkClosed = eStop::SerialClosed;
+}
+
+
+SplicePump::~SplicePump()
+{
+    closePipe(m_toNetwork.pipe);
+    closePipe(m_toSerial.pipe);
+}
+
+
+void SplicePump::start(StopHandler onStop)
+{
+    m_onStop = std::move(onStop);
+    m_running = true;
+
+    pump(m_toNetwork);
+    pump(m_toSerial);
+}
+
+
+SplicePump::Residue SplicePump::stop()
+{
+    m_running = false;
+    m_onStop = nullptr;
+
+    // pending waits complete with operation_aborted and find the pump stopped
+    boost::system::error_code ignored;
+    m_serial.cancel(ignored);
+    m_network.cancel(ignored);
+
+    Residue residue;
+    residue.toNetwork = drainPipe(m_toNetwork);
+    residue.toSerial = drainPipe(m_toSerial);
+
+    return residue;
+}
+
+
+/** moves data until the source runs dry and the sink is full, then waits for whichever blocked */
+void SplicePump::pump(Channel & channel)
+{
+    bool progress = true;
+
+    while (m_running && progress)
+    {
+        progress = false;
+
+        if (channel.buffered > 0 && !channel.writeWait)
+        {
+            const ssize_t written = ::splice(channel.pipe[0], nullptr, channel.sink->native_handle(), nullptr,
+                                             channel.buffered, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+
+            if (written > 0)
+            {
+                channel.buffered -= static_cast<size_t>(written);
+                channel.moved += static_cast<uint64_t>(written);
+                progress = true;
+            }
+            else if (written < 0 && EAGAIN == errno)
+            {
+                waitWritable(channel);
+            }
+            else if (written < 0 && EINTR == errno)
+            {
+                progress = true;
+            }
+            else
+            {
+                fail(channel.sinkClosed);
+                return;
+            }
+        }
+
+        if (channel.buffered < m_pipeSize && !channel.readWait)
+        {
+            const ssize_t received = ::splice(channel.source->native_handle(), nullptr, channel.pipe[1], nullptr,
+                                              m_pipeSize - channel.buffered, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+
+            if (received > 0)
+            {
+                channel.buffered += static_cast<size_t>(received);
+                progress = true;
+            }
+            else if (received < 0 && EAGAIN == errno)
+            {
+                waitReadable(channel);
+            }
+            else if (received < 0 && EINTR == errno)
+            {
+                progress = true;
+            }
+            else
+            {
+                // eof of the socket or a hangup of the device
+                fail(channel.sourceClosed);
+                return;
+            }
+        }
+    }
+}
+
+
+void SplicePump::waitReadable(Channel & channel)
+{
+    channel.readWait = true;
+
+    channel.source->async_wait(boost::asio::posix::stream_descriptor::wait_read,
+                               [this, self = shared_from_this(), &channel](const boost::system::error_code & error)
+                               {
+                                   channel.readWait = false;
+
+                                   if (m_running)
+                                   {
+                                       if (error)
+                                       {
+                                           fail(channel.sourceClosed);
+                                       }
+                                       else
+                                       {
+                                           pump(channel);
+                                       }
+                                   }
+                               });
+}
+
+
+void SplicePump::waitWritable(Channel & channel)
+{
+    channel.writeWait = true;
+
+    channel.sink->async_wait(boost::asio::posix::stream_descriptor::wait_write,
+                             [this, self = shared_from_this(), &channel](const boost::system::error_code & error)
+                             {
+                                 channel.writeWait = false;
+
+                                 if (m_running)
+                                 {
+                                     if (error)
+                                     {
+                                         fail(channel.sinkClosed);
+                                     }
+                                     else
+                                     {
+                                         pump(channel);
+                                     }
+                                 }
+                             });
+}
+
+
+/** reports the first failure once, posted so the owner may stop the pump from within its handler */
+void SplicePump::fail(eStop reason)
+{
+    if (m_failed)
+    {
+        return;
+    }
+
+    m_failed = true;
+
+    boost::asio::post(m_executor, [self = shared_from_this(), reason]()
+                      {
+                          if (self->m_running && self->m_onStop)
+                          {
+                              self->m_onStop(reason);
+                          }
+                      });
+}
+
+
+std::string SplicePump::drainPipe(Channel & channel)
+{
+    std::string residue;
+    char buffer[4096];
+
+    while (channel.buffered > 0)
+    {
+        const ssize_t length = ::read(channel.pipe[0], buffer, sizeof(buffer));
+
+        if (length <= 0)
+        {
+            break;
+        }
+
+        residue.append(buffer, static_cast<size_t>(length));
+        channel.buffered -= std::min(channel.buffered, static_cast<size_t>(length));
+    }
+
+    return residue;
+}
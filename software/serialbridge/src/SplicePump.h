@@ -0,0 +1,99 @@
+#ifndef SPLICEPUMP_H_4B1F7A02_9E3C_4D6A_A8F5_2C71E0B9D364
+#define SPLICEPUMP_H_4B1F7A02_9E3C_4D6A_A8F5_2C71E0B9D364
+
+/**
+ * @file		SplicePump.h
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <boost/asio.hpp>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+
+
+/** moves bytes between the serial device and a single tcp client inside the kernel
+ *
+ *  Each direction splices from its source into a pipe and from the pipe into its sink,
+ *  so the payload never passes through user space. The pump works on duplicates of the
+ *  descriptors and waits for readiness on the given executor (the strand of the bridge);
+ *  the owners of the original descriptors must not read them while the pump runs.
+ */
+class SplicePump : public std::enable_shared_from_this<SplicePump>
+{
+public:
+    /** the side that went away */
+    enum class eStop : uint8_t
+    {
+        SerialClosed = 0,
+        NetworkClosed = 1
+    };
+
+    /** called once on the executor when a side closed or failed, the pump keeps its state until stop() */
+    using StopHandler = std::function<void(eStop)>;
+
+    /** bytes already taken from a source but not yet written to the sink */
+    struct Residue
+    {
+        std::string toNetwork;
+        std::string toSerial;
+    };
+
+    /** sets up pipes and descriptors, nullptr if the system refuses */
+    static std::shared_ptr<SplicePump> create(const boost::asio::any_io_executor & executor, int serialFd, int socketFd);
+
+    SplicePump(const boost::asio::any_io_executor & executor, int serialFd, int socketFd);
+    ~SplicePump();
+
+    SplicePump(const SplicePump&) = delete;
+    SplicePump& operator=(const SplicePump&) = delete;
+
+    /** starts moving data in both directions */
+    void start(StopHandler onStop);
+
+    /** stops moving data and hands out what is left in the pipes, so the caller can deliver it in order */
+    Residue stop();
+
+    uint64_t toNetworkBytes() const { return m_toNetwork.moved; }
+    uint64_t toSerialBytes() const { return m_toSerial.moved; }
+
+private:
+    /** one direction: source -> pipe -> sink */
+    struct Channel
+    {
+        boost::asio::posix::stream_descriptor * source = nullptr;
+        boost::asio::posix::stream_descriptor * sink = nullptr;
+        eStop   sourceClosed = eStop::SerialClosed;
+        eStop   sinkClosed = eStop::NetworkClosed;
+        int     pipe[2] = { -1, -1 };
+        size_t  buffered = 0;         /**< bytes in the pipe */
+        bool    readWait = false;     /**< waiting for the source to become readable */
+        bool    writeWait = false;    /**< waiting for the sink to become writable */
+        std::atomic<uint64_t> moved{ 0 };
+    };
+
+    void pump(Channel & channel);
+    void waitReadable(Channel & channel);
+    void waitWritable(Channel & channel);
+    void fail(eStop reason);
+    static std::string drainPipe(Channel & channel);
+
+    boost::asio::any_io_executor          m_executor;
+    boost::asio::posix::stream_descriptor m_serial;    /**< duplicate of the device descriptor */
+    boost::asio::posix::stream_descriptor m_network;   /**< duplicate of the client socket */
+    Channel       m_toNetwork;
+    Channel       m_toSerial;
+    size_t        m_pipeSize = 0;
+    bool          m_running = false;
+    bool          m_failed = false;
+    StopHandler   m_onStop;
+};
+
+#endif /* SPLICEPUMP_H_4B1F7A02_9E3C_4D6A_A8F5_2C71E0B9D364 */
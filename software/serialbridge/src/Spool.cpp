@@ -0,0 +1,450 @@
+/**
+ * @file		Spool.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include "Spool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+
+static const char SEGMENT_MAGIC[8] = { 'S', 'B', 'S', 'P', 'O', 'O', 'L', '2' };
+static const std::string SEGMENT_EXTENSION = ".spool";
+
+
+std::shared_ptr<Spool> Spool::open(const boost::asio::any_io_executor & executor, const Settings & settings)
+{
+    try
+    {
+        return std::make_shared<Spool>(executor, settings);
+    }
+    catch (const char* const text)
+    {
+        std::cerr << "Spool: " << text << " (" << std::strerror(errno) << "), " << settings.directory << " not used" << std::endl;
+    }
+
+    return nullptr;
+}
+
+
+Spool::Spool(const boost::asio::any_io_executor & executor, const Settings & settings)
+    : m_settings(settings),
+      m_syncTimer(executor)
+{
+    if (m_settings.segmentBytes <= HEADER_SIZE || m_settings.maxBytes < m_settings.segmentBytes)
+    {
+        errno = EINVAL;
+        throw "Segment size must be above the header and below the spool size!";
+    }
+
+    boost::system::error_code error;
+    boost::filesystem::create_directories(m_settings.directory, error);
+
+    if (error)
+    {
+        errno = error.value();
+        throw "Failed to create the spool directory!";
+    }
+
+    recover();
+
+    m_flusher = std::thread([this] { flush(); });
+}
+
+
+Spool::~Spool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_flushMutex);
+        m_stopping = true;
+    }
+
+    m_syncTimer.cancel();
+    m_flushWakeup.notify_one();
+
+    if (m_flusher.joinable())
+    {
+        m_flusher.join();
+    }
+
+    // the last writes reach the disk no later than an orderly shutdown
+    for (Segment & segment : m_segments)
+    {
+        if (segment.dirty && m_settings.syncMillis > 0)
+        {
+            persist(segment.fd, segment.header().written);
+        }
+
+        release(segment, false);
+    }
+}
+
+
+void Spool::append(const char* data, size_t length)
+{
+    m_statistics.spooledBytes += length;
+
+    while (length > 0)
+    {
+        if (m_segments.empty() || m_segments.back().header().written == m_segments.back().capacity)
+        {
+            roll();
+        }
+
+        Segment & segment = m_segments.back();
+        Header & header = segment.header();
+        const size_t chunk = std::min<size_t>(length, segment.capacity - header.written);
+
+        std::memcpy(segment.map + HEADER_SIZE + header.written, data, chunk);
+        header.written += chunk;
+
+        // without syncs the kernel writes back in any order, there is no safer position to keep
+        if (0 == m_settings.syncMillis)
+        {
+            header.synced = header.written;
+        }
+
+        markDirty(segment);
+
+        m_pendingBytes += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+
+boost::asio::const_buffer Spool::front(size_t maxLength) const
+{
+    for (const Segment & segment : m_segments)
+    {
+        const Header & header = segment.header();
+
+        if (header.consumed < header.written)
+        {
+            const size_t length = std::min<size_t>(maxLength, header.written - header.consumed);
+            return boost::asio::const_buffer(segment.map + HEADER_SIZE + header.consumed, length);
+        }
+    }
+
+    return boost::asio::const_buffer();
+}
+
+
+void Spool::consume(size_t length)
+{
+    length = std::min<uint64_t>(length, m_pendingBytes);
+    m_pendingBytes -= length;
+    m_overrun = false;
+    m_statistics.drainedBytes += length;
+
+    while (!m_segments.empty())
+    {
+        Segment & segment = m_segments.front();
+        Header & header = segment.header();
+        const size_t chunk = std::min<size_t>(length, header.written - header.consumed);
+
+        if (chunk > 0)
+        {
+            header.consumed += chunk;
+            markDirty(segment);
+            length -= chunk;
+        }
+
+        // the segment being written stays, everything before it is gone once drained
+        if (header.consumed < header.written || m_segments.size() == 1)
+        {
+            break;
+        }
+
+        release(segment, true);
+        m_segments.pop_front();
+    }
+}
+
+
+std::string Spool::path(uint64_t sequence) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016" PRIx64, sequence);
+
+    return (boost::filesystem::path(m_settings.directory) / (name + SEGMENT_EXTENSION)).string();
+}
+
+
+/** maps the segments left by an earlier run, in the order they were written; broken ones are removed */
+void Spool::recover()
+{
+    boost::system::error_code error;
+    std::vector<uint64_t> sequences;
+
+    for (boost::filesystem::directory_iterator entry(m_settings.directory, error), end; !error && entry != end; entry.increment(error))
+    {
+        const boost::filesystem::path & file = entry->path();
+        uint64_t sequence = 0;
+        char rest = 0;
+
+        if (file.extension() == SEGMENT_EXTENSION && 1 == std::sscanf(file.stem().c_str(), "%" SCNx64 "%c", &sequence, &rest))
+        {
+            sequences.push_back(sequence);
+        }
+    }
+
+    std::sort(sequences.begin(), sequences.end());
+
+    for (const uint64_t sequence : sequences)
+    {
+        const std::string file = path(sequence);
+        Segment segment;
+        struct stat status{};
+
+        segment.sequence = sequence;
+        segment.fd = ::open(file.c_str(), O_RDWR | O_CLOEXEC);
+
+        if (segment.fd >= 0 && 0 == ::fstat(segment.fd, &status) && static_cast<size_t>(status.st_size) > HEADER_SIZE)
+        {
+            void* map = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, segment.fd, 0);
+
+            if (MAP_FAILED != map)
+            {
+                segment.map = static_cast<char*>(map);
+                segment.capacity = static_cast<size_t>(status.st_size) - HEADER_SIZE;
+            }
+        }
+
+        if (nullptr == segment.map || 0 != std::memcmp(segment.header().magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)))
+        {
+            std::cerr << "Spool: removing unreadable segment " << file << std::endl;
+            release(segment, true);
+            continue;
+        }
+
+        // written may run ahead of the data on disk after a power loss, synced never does
+        Header & header = segment.header();
+        header.written = std::min<uint64_t>(std::min(header.written, header.synced), segment.capacity);
+        header.synced = header.written;
+        header.consumed = std::min(header.consumed, header.written);
+
+        m_pendingBytes += header.written - header.consumed;
+        m_nextSequence = sequence + 1;
+        m_segments.push_back(segment);
+    }
+
+    // drained segments before the last one were deleted already, unless the run ended in between
+    while (m_segments.size() > 1 && m_segments.front().header().consumed == m_segments.front().header().written)
+    {
+        release(m_segments.front(), true);
+        m_segments.pop_front();
+    }
+
+    if (m_pendingBytes > 0)
+    {
+        std::cout << "Spool: recovered " << m_pendingBytes << " bytes in " << m_segments.size() << " segments from " << m_settings.directory << std::endl;
+    }
+}
+
+
+/** starts a new segment, the oldest one is dropped first if the spool would exceed its size */
+void Spool::roll()
+{
+    while (!m_segments.empty() && (m_segments.size() + 1) * m_settings.segmentBytes > m_settings.maxBytes)
+    {
+        Segment & oldest = m_segments.front();
+        const uint64_t lost = oldest.header().written - oldest.header().consumed;
+
+        // reported once per overrun, the statistics count the rest
+        if (lost > 0 && !m_overrun)
+        {
+            std::cerr << "Spool: full, dropping the oldest data" << std::endl;
+            m_overrun = true;
+        }
+
+        m_statistics.droppedBytes += lost;
+        m_pendingBytes -= lost;
+
+        release(oldest, true);
+        m_segments.pop_front();
+    }
+
+    Segment segment;
+    const std::string file = path(m_nextSequence);
+
+    segment.sequence = m_nextSequence++;
+    segment.capacity = m_settings.segmentBytes - HEADER_SIZE;
+    segment.fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (segment.fd < 0)
+    {
+        throw "Failed to create a spool segment!";
+    }
+
+    // blocks are reserved up front: a full disk fails here instead of raising SIGBUS on a write into the mapping
+    const int result = ::posix_fallocate(segment.fd, 0, static_cast<off_t>(m_settings.segmentBytes));
+
+    if (0 != result)
+    {
+        release(segment, true);
+        errno = result;
+        throw "Failed to allocate a spool segment!";
+    }
+
+    void* map = ::mmap(nullptr, m_settings.segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, segment.fd, 0);
+
+    if (MAP_FAILED == map)
+    {
+        release(segment, true);
+        throw "Failed to map a spool segment!";
+    }
+
+    segment.map = static_cast<char*>(map);
+    std::memcpy(segment.header().magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    segment.header().written = 0;
+    segment.header().consumed = 0;
+    segment.header().synced = 0;
+    markDirty(segment);
+
+    m_segments.push_back(segment);
+}
+
+
+void Spool::release(Segment & segment, bool remove)
+{
+    if (nullptr != segment.map)
+    {
+        ::munmap(segment.map, segment.capacity + HEADER_SIZE);
+        segment.map = nullptr;
+    }
+
+    if (segment.fd >= 0)
+    {
+        ::close(segment.fd);
+        segment.fd = -1;
+    }
+
+    if (remove)
+    {
+        ::unlink(path(segment.sequence).c_str());
+    }
+}
+
+
+void Spool::markDirty(Segment & segment)
+{
+    segment.dirty = true;
+
+    if (m_syncScheduled || 0 == m_settings.syncMillis)
+    {
+        return;
+    }
+
+    std::weak_ptr<Spool> weak(shared_from_this());
+
+    m_syncScheduled = true;
+    m_syncTimer.expires_after(std::chrono::milliseconds(m_settings.syncMillis));
+    m_syncTimer.async_wait([weak](const boost::system::error_code & error)
+                           {
+                               auto self = weak.lock();
+
+                               if (!error && self)
+                               {
+                                   self->m_syncScheduled = false;
+                                   self->sync();
+                               }
+                           });
+}
+
+
+/** hands the segments written since the last sync to the flusher, one batch per interval however many writes it covers */
+void Spool::sync()
+{
+    std::vector<std::pair<int, uint64_t>> fds;
+
+    for (Segment & segment : m_segments)
+    {
+        if (segment.dirty)
+        {
+            const int fd = ::dup(segment.fd);
+
+            if (fd >= 0)
+            {
+                fds.emplace_back(fd, segment.header().written);
+            }
+
+            segment.dirty = false;
+        }
+    }
+
+    if (fds.empty())
+    {
+        return;
+    }
+
+    ++m_statistics.syncs;
+
+    {
+        std::lock_guard<std::mutex> lock(m_flushMutex);
+        m_flushQueue.insert(m_flushQueue.end(), fds.begin(), fds.end());
+    }
+
+    m_flushWakeup.notify_one();
+}
+
+
+/** flusher thread: the mapped pages are in the page cache, so syncing the file writes them out */
+void Spool::flush()
+{
+    std::unique_lock<std::mutex> lock(m_flushMutex);
+
+    for (;;)
+    {
+        m_flushWakeup.wait(lock, [this] { return m_stopping || !m_flushQueue.empty(); });
+
+        std::vector<std::pair<int, uint64_t>> fds;
+        fds.swap(m_flushQueue);
+
+        lock.unlock();
+
+        for (const auto & entry : fds)
+        {
+            persist(entry.first, entry.second);
+            ::close(entry.first);
+        }
+
+        lock.lock();
+
+        if (m_stopping && m_flushQueue.empty())
+        {
+            return;
+        }
+    }
+}
+
+
+/** syncs the data up to the written bytes, then publishes them as synced; also fine for a released segment */
+void Spool::persist(int fd, uint64_t written)
+{
+    if (0 != ::fdatasync(fd))
+    {
+        return;
+    }
+
+    // through the descriptor, the mapping may be gone already; same page as the mapped header
+    if (static_cast<ssize_t>(sizeof(written)) == ::pwrite(fd, &written, sizeof(written), static_cast<off_t>(offsetof(Header, synced))))
+    {
+        ::fdatasync(fd);
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef SPOOL_H_9F2A64C8_3D1E_4B7F_A5C0_6E81D47B29F3
+#define SPOOL_H_9F2A64C8_3D1E_4B7F_A5C0_6E81D47B29F3
+
+/**
+ * @file		Spool.h
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+
+/** disk-backed fifo of serial data for the time no client is connected
+ *
+ *  The data goes into memory-mapped, append-only segment files of a fixed size; the oldest
+ *  segment is dropped once the total size would exceed its bound. The positions are kept in the
+ *  header of each segment; a sync first writes out the data and only then the position it
+ *  reached, which is all a restart trusts. Syncs are batched per interval and run on a thread
+ *  of their own, so a slow SD card never stalls the event loop. All other methods run on the
+ *  executor (the strand of the bridge).
+ */
+class Spool : public std::enable_shared_from_this<Spool>
+{
+public:
+    struct Settings
+    {
+        std::string directory;                  /**< one per bridge, created if missing */
+        uint64_t    maxBytes = 64 * 1024 * 1024;
+        size_t      segmentBytes = 1024 * 1024;
+        uint32_t    syncMillis = 1000;          /**< data written is synced at most this late, 0 leaves it to the kernel */
+    };
+
+    struct Statistics
+    {
+        uint64_t spooledBytes = 0;
+        uint64_t drainedBytes = 0;
+        uint64_t droppedBytes = 0;   /**< lost with the oldest segment when the bound was reached */
+        uint64_t syncs = 0;
+    };
+
+    /** opens the spool and recovers the segments left in its directory, nullptr if the directory is not usable */
+    static std::shared_ptr<Spool> open(const boost::asio::any_io_executor & executor, const Settings & settings);
+
+    Spool(const boost::asio::any_io_executor & executor, const Settings & settings);
+    ~Spool();
+
+    Spool(const Spool&) = delete;
+    Spool& operator=(const Spool&) = delete;
+
+    /** appends the data, dropping the oldest segment if the spool is full */
+    void append(const char* data, size_t length);
+
+    /** the oldest pending bytes, contiguous within one segment */
+    boost::asio::const_buffer front(size_t maxLength) const;
+
+    /** releases bytes taken from front(), fully drained segments are deleted */
+    void consume(size_t length);
+
+    bool empty() const { return 0 == m_pendingBytes; }
+    uint64_t size() const { return m_pendingBytes; }
+    size_t segments() const { return m_segments.size(); }
+
+    const Statistics & statistics() const { return m_statistics; }
+
+private:
+    /** placed at the start of each segment file, the payload follows at HEADER_SIZE */
+    struct Header
+    {
+        char     magic[8];
+        uint64_t written;    /**< payload bytes appended */
+        uint64_t consumed;   /**< payload bytes drained */
+        uint64_t synced;     /**< payload bytes known to be on disk, written after them */
+    };
+
+    struct Segment
+    {
+        uint64_t sequence = 0;
+        int      fd = -1;
+        char*    map = nullptr;
+        size_t   capacity = 0;    /**< payload bytes */
+        bool     dirty = false;
+
+        Header & header() const { return *reinterpret_cast<Header*>(map); }
+    };
+
+    static constexpr size_t HEADER_SIZE = 64;
+
+    std::string path(uint64_t sequence) const;
+    void recover();
+    void roll();
+    void release(Segment & segment, bool remove);
+    void markDirty(Segment & segment);
+    void sync();
+    void flush();
+    static void persist(int fd, uint64_t written);
+
+    const Settings            m_settings;
+    std::deque<Segment>       m_segments;
+    uint64_t                  m_nextSequence = 0;
+    uint64_t                  m_pendingBytes = 0;
+    Statistics                m_statistics;
+    bool                      m_overrun = false;   /**< dropped data since the last drain */
+
+    boost::asio::steady_timer m_syncTimer;
+    bool                      m_syncScheduled = false;
+
+    // flusher thread: fdatasync of duplicated descriptors, which stay valid after a segment was released
+    std::thread               m_flusher;
+    std::mutex                m_flushMutex;
+    std::condition_variable   m_flushWakeup;
+    std::vector<std::pair<int, uint64_t>> m_flushQueue;   /**< descriptor and the written bytes to persist */
+    bool                      m_stopping = false;
+};
+
+#endif /* SPOOL_H_9F2A64C8_3D1E_4B7F_A5C0_6E81D47B29F3 */
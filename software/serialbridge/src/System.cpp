@@ -10,6 +10,15 @@
 
 
 #include <boost/asio/io_service.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <iostream>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 const std::string System::ALL_INTERFACES = "all interfaces";
 
@@ -28,9 +37,57 @@ boost::asio::io_service & System::IOService()
 
 
 
-void System::run()
+boost::asio::any_io_executor System::makeStrand()
 {
-	m_private.ioService.run();
+	return boost::asio::make_strand(m_private.ioService);
+}
+
+
+
+/** binds the calling thread to the given cpu */
+static void pinThread(unsigned cpu)
+{
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+
+	if (0 != pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+	{
+		std::cerr << "Pinning a worker to cpu " << cpu << " failed" << std::endl;
+	}
+#else
+	(void) cpu;
+#endif
+}
+
+
+
+void System::run(size_t threads, const std::vector<unsigned> & cpus)
+{
+	auto worker = [&cpus](size_t index)
+	{
+		if (!cpus.empty())
+		{
+			pinThread(cpus[index % cpus.size()]);
+		}
+
+		m_private.ioService.run();
+	};
+
+	std::vector<std::thread> workers;
+
+	for (size_t index = 1; index < threads; ++index)
+	{
+		workers.emplace_back(worker, index);
+	}
+
+	worker(0);
+
+	for (std::thread & thread : workers)
+	{
+		thread.join();
+	}
 }
 
 
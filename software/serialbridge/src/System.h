@@ -9,6 +9,7 @@
  */
 
 #include <string>
+#include <vector>
 
 #include <boost/asio.hpp>
 
@@ -20,11 +21,23 @@ class System
 
 public:
 
+	/** how a bridge moves data between its descriptors and the kernel */
+	enum class eIoBackend : uint8_t
+	{
+		Asio = 0,     /**< readiness via the epoll reactor, one syscall per transfer */
+		IoUring = 1   /**< completions via io_uring, batched submissions and multishot receives */
+	};
+
 	/** gets the fundamental asio service for running all IO requests */
 	static boost::asio::io_service & IOService();
 
-	/** runs the io service */
-	static void run();
+	/** creates a strand on the io service: handlers bound to it never run concurrently,
+	 *  so each bridge owns one and keeps its state race-free on any number of threads */
+	static boost::asio::any_io_executor makeStrand();
+
+	/** runs the io service on the calling thread plus threads - 1 workers,
+	 *  worker i is pinned to cpus[i % cpus.size()] if any cpus are given */
+	static void run(size_t threads = 1, const std::vector<unsigned> & cpus = std::vector<unsigned>());
 
 
 	/** the identifier to connect to all sockets */
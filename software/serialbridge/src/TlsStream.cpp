@@ -0,0 +1,64 @@
+/**
+ * @file		TlsStream.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include "TlsStream.h"
+
+#include <iostream>
+
+
+/** prints the reason of the last OpenSSL failure */
+static void printError(const char* what)
+{
+    char reason[256] = { 0 };
+    ERR_error_string_n(ERR_get_error(), reason, sizeof(reason));
+
+    std::cerr << "TLS: " << what << ": " << reason << std::endl;
+}
+
+
+TlsContext::TlsContext(const std::string& certFile, const std::string& keyFile)
+    : m_context(SSL_CTX_new(TLS_server_method()))
+{
+    if (nullptr == m_context)
+    {
+        printError("creating the context failed");
+        throw "Failed to create TLS context!";
+    }
+
+    SSL_CTX_set_min_proto_version(m_context, TLS1_2_VERSION);
+
+    // the kernel offloads AES-GCM (and ChaCha20-Poly1305 on recent kernels), so those are preferred
+    SSL_CTX_set_cipher_list(m_context, "ECDHE+AESGCM:ECDHE+CHACHA20:!aNULL");
+    SSL_CTX_set_ciphersuites(m_context, "TLS_AES_128_GCM_SHA256:TLS_AES_256_GCM_SHA384:TLS_CHACHA20_POLY1305_SHA256");
+
+#ifdef SSL_OP_ENABLE_KTLS
+    SSL_CTX_set_options(m_context, SSL_OP_ENABLE_KTLS);
+#endif
+
+    // reconnecting clients resume via session id or ticket instead of a full handshake
+    static const unsigned char SESSION_CONTEXT[] = "SerialBridge";
+
+    SSL_CTX_set_session_cache_mode(m_context, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_set_session_id_context(m_context, SESSION_CONTEXT, sizeof(SESSION_CONTEXT) - 1);
+
+    const std::string & key = keyFile.empty() ? certFile : keyFile;
+
+    if (1 != SSL_CTX_use_certificate_chain_file(m_context, certFile.c_str()) ||
+        1 != SSL_CTX_use_PrivateKey_file(m_context, key.c_str(), SSL_FILETYPE_PEM) ||
+        1 != SSL_CTX_check_private_key(m_context))
+    {
+        printError(("loading " + certFile + " / " + key + " failed").c_str());
+        SSL_CTX_free(m_context);
+        throw "Failed to load TLS certificate!";
+    }
+}
+
+
+TlsContext::~TlsContext()
+{
+    SSL_CTX_free(m_context);
+}
@@ -0,0 +1,257 @@
+#ifndef TLSSTREAM_H_9A47E2C6_3F18_4D0B_8C5E_6B2D71F4A903
+#define TLSSTREAM_H_9A47E2C6_3F18_4D0B_8C5E_6B2D71F4A903
+
+/**
+ * @file		TlsStream.h
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include <algorithm>
+#include <climits>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/error.hpp>
+
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+
+
+/** server side tls configuration: certificate chain, key and session cache for resumption */
+class TlsContext
+{
+    SSL_CTX* m_context;
+
+public:
+    /** loads the PEM certificate chain and private key (key may be empty if it is part of the certificate file) */
+    TlsContext(const std::string& certFile, const std::string& keyFile);
+    ~TlsContext();
+
+    TlsContext(const TlsContext&) = delete;
+    TlsContext& operator=(const TlsContext&) = delete;
+
+    SSL_CTX* native() const { return m_context; }
+};
+
+
+/** tls stream on a socket BIO, so OpenSSL may hand the record layer to the kernel (kTLS)
+ *
+ *  Satisfies asio's AsyncReadStream/AsyncWriteStream. While kTLS is active for a direction,
+ *  reads or writes go straight to the socket and the kernel en-/decrypts; otherwise they
+ *  run through SSL_read/SSL_write on the non-blocking socket.
+ */
+class TlsStream
+{
+public:
+    using executor_type = boost::asio::ip::tcp::socket::executor_type;
+    using lowest_layer_type = boost::asio::ip::tcp::socket::lowest_layer_type;
+
+    static constexpr size_t MAX_RECORD_SIZE = 16384;
+
+    TlsStream(boost::asio::ip::tcp::socket socket, TlsContext& context)
+        : m_socket(std::move(socket)),
+          m_ssl(SSL_new(context.native()))
+    {
+        m_socket.non_blocking(true);
+        SSL_set_fd(m_ssl, static_cast<int>(m_socket.native_handle()));
+        SSL_set_mode(m_ssl, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+        SSL_set_accept_state(m_ssl);
+    }
+
+    TlsStream(TlsStream&& rhs) noexcept
+        : m_socket(std::move(rhs.m_socket)),
+          m_ssl(rhs.m_ssl),
+          m_kernelSend(rhs.m_kernelSend),
+          m_kernelReceive(rhs.m_kernelReceive)
+    {
+        rhs.m_ssl = nullptr;
+    }
+
+    ~TlsStream()
+    {
+        if (nullptr != m_ssl)
+        {
+            SSL_free(m_ssl);
+        }
+    }
+
+    TlsStream(const TlsStream&) = delete;
+    TlsStream& operator=(const TlsStream&) = delete;
+
+    executor_type get_executor() { return m_socket.get_executor(); }
+
+    lowest_layer_type& lowest_layer() { return m_socket.lowest_layer(); }
+
+    bool isKernelSend() const { return m_kernelSend; }
+    bool isKernelReceive() const { return m_kernelReceive; }
+    bool isResumed() const { return 1 == SSL_session_reused(m_ssl); }
+    std::string version() const { return SSL_get_version(m_ssl); }
+
+
+    /** server handshake, afterwards the kTLS state of both directions is known */
+    template <class Handler>
+    void async_handshake(Handler&& handler)
+    {
+        perform([this]() { return SSL_accept(m_ssl); },
+                [this, handler = std::forward<Handler>(handler)](const boost::system::error_code& error, size_t) mutable
+                {
+                    if (!error)
+                    {
+                        m_kernelSend = BIO_get_ktls_send(SSL_get_wbio(m_ssl)) > 0;
+                        m_kernelReceive = BIO_get_ktls_recv(SSL_get_rbio(m_ssl)) > 0;
+                    }
+
+                    handler(error);
+                });
+    }
+
+
+    template <class MutableBuffers, class Handler>
+    void async_read_some(const MutableBuffers& buffers, Handler&& handler)
+    {
+        if (m_kernelReceive)
+        {
+            m_socket.async_read_some(buffers, std::forward<Handler>(handler));
+            return;
+        }
+
+        boost::asio::mutable_buffer target;
+
+        for (auto it = boost::asio::buffer_sequence_begin(buffers); it != boost::asio::buffer_sequence_end(buffers); ++it)
+        {
+            if (it->size() > 0)
+            {
+                target = *it;
+                break;
+            }
+        }
+
+        if (0 == target.size())
+        {
+            complete(std::forward<Handler>(handler), 0);
+            return;
+        }
+
+        perform([this, target]() { return SSL_read(m_ssl, target.data(), static_cast<int>(std::min<size_t>(target.size(), INT_MAX))); },
+                std::forward<Handler>(handler));
+    }
+
+
+    /** the handler is taken by reference: composed operations move themselves into it while the buffers are still read from them */
+    template <class ConstBuffers, class Handler>
+    void async_write_some(const ConstBuffers& buffers, Handler&& handler)
+    {
+        if (m_kernelSend)
+        {
+            m_socket.async_write_some(buffers, std::forward<Handler>(handler));
+            return;
+        }
+
+        // small chunks are gathered into one record instead of one record each
+        m_record.resize(std::min(MAX_RECORD_SIZE, boost::asio::buffer_size(buffers)));
+        const size_t length = boost::asio::buffer_copy(boost::asio::buffer(m_record), buffers);
+
+        // like on a socket, an empty write completes at once (SSL_write would report it as an error)
+        if (0 == length)
+        {
+            complete(std::forward<Handler>(handler), 0);
+            return;
+        }
+
+        perform([this, length]() { return SSL_write(m_ssl, m_record.data(), static_cast<int>(length)); },
+                std::forward<Handler>(handler));
+    }
+
+
+    /** best effort close_notify before the socket gets closed */
+    void shutdown()
+    {
+        if (nullptr != m_ssl)
+        {
+            SSL_shutdown(m_ssl);
+        }
+    }
+
+private:
+    /** completions are never invoked from within the initiating call */
+    template <class Handler>
+    void complete(Handler handler, size_t length)
+    {
+        boost::asio::post(m_socket.get_executor(), [handler = std::move(handler), length]() mutable { handler(boost::system::error_code(), length); });
+    }
+
+    /** runs the OpenSSL call until it succeeds or fails, waiting for socket readiness in between */
+    template <class Operation, class Handler>
+    void perform(Operation operation, Handler handler)
+    {
+        ERR_clear_error();
+
+        const int result = operation();
+
+        if (result > 0)
+        {
+            complete(std::move(handler), static_cast<size_t>(result));
+            return;
+        }
+
+        const int reason = SSL_get_error(m_ssl, result);
+
+        if (SSL_ERROR_WANT_READ == reason || SSL_ERROR_WANT_WRITE == reason)
+        {
+            m_socket.async_wait(SSL_ERROR_WANT_READ == reason ? boost::asio::ip::tcp::socket::wait_read : boost::asio::ip::tcp::socket::wait_write,
+                                [this, operation, handler = std::move(handler)](const boost::system::error_code& error) mutable
+                                {
+                                    if (error)
+                                    {
+                                        handler(error, 0);
+                                    }
+                                    else
+                                    {
+                                        perform(operation, std::move(handler));
+                                    }
+                                });
+            return;
+        }
+
+        boost::system::error_code error = boost::asio::error::eof;
+
+        if (SSL_ERROR_SSL == reason)
+        {
+            error = boost::system::error_code(static_cast<int>(ERR_get_error()), boost::asio::error::get_ssl_category());
+        }
+        else if (SSL_ERROR_SYSCALL == reason && 0 != errno)
+        {
+            error = boost::system::error_code(errno, boost::system::system_category());
+        }
+
+        boost::asio::post(m_socket.get_executor(), [handler = std::move(handler), error]() mutable { handler(error, 0); });
+    }
+
+    boost::asio::ip::tcp::socket m_socket;
+    SSL*                         m_ssl;
+    bool                         m_kernelSend = false;
+    bool                         m_kernelReceive = false;
+    std::vector<char>            m_record;   /**< plaintext of the pending SSL_write */
+};
+
+
+template <class Handler>
+void startHandshake(TlsStream& stream, Handler handler)
+{
+    stream.async_handshake(std::move(handler));
+}
+
+inline void closeStream(TlsStream& stream)
+{
+    boost::system::error_code ignored;
+
+    stream.shutdown();
+    stream.lowest_layer().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+    stream.lowest_layer().close(ignored);
+}
+
+#endif /* TLSSTREAM_H_9A47E2C6_3F18_4D0B_8C5E_6B2D71F4A903 */
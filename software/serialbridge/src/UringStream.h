@@ -0,0 +1,404 @@
+#ifndef URINGSTREAM_H_0F4B7E2A_93C1_4D68_A5B2_7E19C64D0A35
+#define URINGSTREAM_H_0F4B7E2A_93C1_4D68_A5B2_7E19C64D0A35
+
+/**
+ * @file		UringStream.h
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <boost/asio.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+#include "IoUring.h"
+
+
+/** AsyncReadStream/AsyncWriteStream on a descriptor whose transfers run through an IoUring
+ *
+ *  Reads are served by one multishot receive into a provided buffer ring: the kernel keeps
+ *  filling buffers without being asked again, async_read_some only copies out what arrived.
+ *  Writes are gathered into a single sendmsg/writev. The descriptor is not owned.
+ */
+class UringStream
+{
+public:
+    using executor_type = boost::asio::any_io_executor;
+
+    static constexpr size_t MAX_SEGMENTS = 64;
+
+    /** READ_MULTISHOT (6.7) is newer than most linux/io_uring.h, the opcode is stable though */
+    static constexpr uint8_t OP_READ_MULTISHOT = 49;
+
+    enum class eKind : uint8_t
+    {
+        Socket,   /**< recv/sendmsg */
+        Device    /**< read/writev, e.g. a tty */
+    };
+
+    UringStream(const std::shared_ptr<IoUring> & ring, int fd, eKind kind, size_t bufferSize, size_t bufferCount)
+        : m_ring(ring),
+          m_state(std::make_shared<State>())
+    {
+        m_state->ring = ring.get();
+        m_state->fd = fd;
+        m_state->kind = kind;
+        m_state->group = ring->createBufferGroup(bufferSize, std::max<size_t>(2, bufferCount));
+
+        if (nullptr == m_state->group)
+        {
+            throw "Failed to create io_uring receive buffers!";
+        }
+    }
+
+    UringStream(UringStream&&) = default;
+
+    ~UringStream()
+    {
+        cancel();
+    }
+
+    UringStream(const UringStream&) = delete;
+    UringStream& operator=(const UringStream&) = delete;
+
+    executor_type get_executor() { return m_ring->executor(); }
+
+
+    template <class MutableBuffers, class Handler>
+    void async_read_some(const MutableBuffers& buffers, Handler&& handler)
+    {
+        boost::asio::mutable_buffer target;
+
+        for (auto it = boost::asio::buffer_sequence_begin(buffers); it != boost::asio::buffer_sequence_end(buffers); ++it)
+        {
+            if (it->size() > 0)
+            {
+                target = *it;
+                break;
+            }
+        }
+
+        if (0 == target.size())
+        {
+            complete(std::forward<Handler>(handler), boost::system::error_code(), 0);
+            return;
+        }
+
+        m_state->pendingBuffer = target;
+        m_state->pendingHandler = std::forward<Handler>(handler);
+
+        if (!m_state->received.empty() || m_state->error)
+        {
+            boost::asio::post(m_ring->executor(), [state = m_state]() { deliver(state); });
+            return;
+        }
+
+        startReceiving(m_state);
+    }
+
+
+    /** the buffers are copied into the iovec before the handler is taken over (see TlsStream) */
+    template <class ConstBuffers, class Handler>
+    void async_write_some(const ConstBuffers& buffers, Handler&& handler)
+    {
+        std::vector<iovec> & segments = m_state->segments;
+        segments.clear();
+
+        for (auto it = boost::asio::buffer_sequence_begin(buffers); it != boost::asio::buffer_sequence_end(buffers) && segments.size() < MAX_SEGMENTS; ++it)
+        {
+            if (it->size() > 0)
+            {
+                segments.push_back({ const_cast<void*>(it->data()), it->size() });
+            }
+        }
+
+        if (segments.empty())
+        {
+            complete(std::forward<Handler>(handler), boost::system::error_code(), 0);
+            return;
+        }
+
+        State & state = *m_state;
+
+        std::function<void(const boost::system::error_code&, size_t)> callback = std::forward<Handler>(handler);
+
+        state.writeOperation = m_ring->submit([&state](io_uring_sqe & sqe)
+                                              {
+                                                  sqe.fd = state.fd;
+
+                                                  if (eKind::Socket == state.kind)
+                                                  {
+                                                      std::memset(&state.message, 0, sizeof(state.message));
+                                                      state.message.msg_iov = state.segments.data();
+                                                      state.message.msg_iovlen = state.segments.size();
+
+                                                      sqe.opcode = IORING_OP_SENDMSG;
+                                                      sqe.addr = reinterpret_cast<uint64_t>(&state.message);
+                                                      sqe.len = 1;
+                                                      sqe.msg_flags = MSG_NOSIGNAL;
+                                                  }
+                                                  else
+                                                  {
+                                                      sqe.opcode = IORING_OP_WRITEV;
+                                                      sqe.addr = reinterpret_cast<uint64_t>(state.segments.data());
+                                                      sqe.len = static_cast<uint32_t>(state.segments.size());
+                                                      sqe.off = static_cast<uint64_t>(-1);
+                                                  }
+                                              },
+                                              [state = m_state, callback](int result, uint32_t)
+                                              {
+                                                  state->writeOperation = 0;
+
+                                                  if (result < 0)
+                                                  {
+                                                      callback(toError(result), 0);
+                                                  }
+                                                  else
+                                                  {
+                                                      callback(boost::system::error_code(), static_cast<size_t>(result));
+                                                  }
+                                              });
+
+        if (0 == state.writeOperation)
+        {
+            complete(std::move(callback), boost::asio::error::no_buffer_space, 0);
+        }
+    }
+
+
+    /** pending operations complete with operation_aborted, required before the descriptor is closed */
+    void cancel()
+    {
+        if (nullptr != m_state)
+        {
+            m_ring->cancel(m_state->readOperation);
+            m_ring->cancel(m_state->writeOperation);
+        }
+    }
+
+private:
+    struct Received
+    {
+        uint16_t buffer;
+        size_t   length;
+        size_t   offset;
+    };
+
+    /** shared with the completions, so the buffers outlive a stream destroyed while the kernel still owns them */
+    struct State
+    {
+        IoUring *                                      ring = nullptr;
+        int                                            fd = -1;
+        eKind                                          kind = eKind::Socket;
+        std::shared_ptr<IoUring::BufferGroup>          group;
+        std::deque<Received>                           received;   /**< filled buffers not yet copied out */
+        boost::system::error_code                      error;      /**< sticky after eof or failure */
+        uint64_t                                       readOperation = 0;
+        bool                                           multishot = true;
+        bool                                           starved = false;   /**< every buffer is queued, receiving resumes on recycle */
+        boost::asio::mutable_buffer                    pendingBuffer;
+        std::function<void(const boost::system::error_code&, size_t)> pendingHandler;
+
+        uint64_t                                       writeOperation = 0;
+        std::vector<iovec>                             segments;
+        msghdr                                         message;
+    };
+
+    static boost::system::error_code toError(int result)
+    {
+        if (-ECANCELED == result)
+        {
+            return boost::asio::error::operation_aborted;
+        }
+
+        return boost::system::error_code(-result, boost::system::system_category());
+    }
+
+    template <class Handler>
+    void complete(Handler&& handler, const boost::system::error_code & error, size_t length)
+    {
+        boost::asio::post(m_ring->executor(),
+                          [handler = std::forward<Handler>(handler), error, length]() mutable { handler(error, length); });
+    }
+
+    static void startReceiving(const std::shared_ptr<State> & state)
+    {
+        if (0 != state->readOperation || state->starved || state->error)
+        {
+            return;
+        }
+
+        State & receiver = *state;
+
+        state->readOperation = state->ring->submit([&receiver](io_uring_sqe & sqe)
+                                                   {
+                                                       sqe.fd = receiver.fd;
+                                                       sqe.flags = IOSQE_BUFFER_SELECT;
+                                                       sqe.buf_group = receiver.group->id();
+
+                                                       if (eKind::Socket == receiver.kind)
+                                                       {
+                                                           sqe.opcode = IORING_OP_RECV;
+                                                           sqe.ioprio = receiver.multishot ? IORING_RECV_MULTISHOT : 0;
+                                                       }
+                                                       else
+                                                       {
+                                                           sqe.opcode = receiver.multishot ? OP_READ_MULTISHOT : static_cast<uint8_t>(IORING_OP_READ);
+                                                           sqe.len = receiver.multishot ? 0 : static_cast<uint32_t>(receiver.group->bufferSize());
+                                                           sqe.off = static_cast<uint64_t>(-1);
+                                                       }
+                                                   },
+                                                   [state](int result, uint32_t flags) { onReceived(state, result, flags); });
+
+        if (0 == state->readOperation)
+        {
+            state->error = boost::asio::error::no_buffer_space;
+        }
+    }
+
+    static void onReceived(const std::shared_ptr<State> & state, int result, uint32_t flags)
+    {
+        if (0 == (flags & IORING_CQE_F_MORE))
+        {
+            state->readOperation = 0;
+        }
+
+        if (result > 0 && (flags & IORING_CQE_F_BUFFER))
+        {
+            state->received.push_back({ static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT), static_cast<size_t>(result), 0 });
+        }
+        else if (0 == result)
+        {
+            state->error = boost::asio::error::eof;
+        }
+        else if (-ENOBUFS == result)
+        {
+            // the kernel ran dry; if everything was handed back meanwhile, receiving resumes at once
+            state->starved = !state->received.empty();
+        }
+        else if (-EINVAL == result && state->multishot)
+        {
+            // older kernel: one submission per read from now on
+            state->multishot = false;
+        }
+        else if (result < 0)
+        {
+            state->error = toError(result);
+        }
+
+        startReceiving(state);
+        deliver(state);
+    }
+
+    /** copies what arrived into the pending read and hands the buffers back to the kernel */
+    static void deliver(const std::shared_ptr<State> & state)
+    {
+        if (!state->pendingHandler || (state->received.empty() && !state->error))
+        {
+            return;
+        }
+
+        char * target = static_cast<char*>(state->pendingBuffer.data());
+        size_t space = state->pendingBuffer.size();
+        size_t length = 0;
+
+        while (space > 0 && !state->received.empty())
+        {
+            Received & front = state->received.front();
+            const size_t count = std::min(space, front.length - front.offset);
+
+            std::memcpy(target + length, state->group->data(front.buffer) + front.offset, count);
+            front.offset += count;
+            length += count;
+            space -= count;
+
+            if (front.offset == front.length)
+            {
+                state->group->recycle(front.buffer);
+                state->received.pop_front();
+                state->starved = false;
+            }
+        }
+
+        startReceiving(state);
+
+        auto handler = std::move(state->pendingHandler);
+        state->pendingHandler = nullptr;
+
+        handler(length > 0 ? boost::system::error_code() : state->error, length);
+    }
+
+    std::shared_ptr<IoUring> m_ring;
+    std::shared_ptr<State>   m_state;
+};
+
+
+/** accepted tcp socket whose transfers run through the io_uring of its bridge */
+class UringSocket
+{
+public:
+    using executor_type = boost::asio::ip::tcp::socket::executor_type;
+    using lowest_layer_type = boost::asio::ip::tcp::socket::lowest_layer_type;
+
+    static constexpr size_t BUFFER_SIZE = 4096;
+    static constexpr size_t BUFFER_COUNT = 16;
+
+    UringSocket(boost::asio::ip::tcp::socket socket, const std::shared_ptr<IoUring> & ring)
+        : m_socket(std::move(socket)),
+          m_stream(ring, m_socket.native_handle(), UringStream::eKind::Socket, BUFFER_SIZE, BUFFER_COUNT)
+    {
+    }
+
+    UringSocket(UringSocket&&) = default;
+
+    executor_type get_executor() { return m_socket.get_executor(); }
+
+    lowest_layer_type& lowest_layer() { return m_socket.lowest_layer(); }
+
+    template <class MutableBuffers, class Handler>
+    void async_read_some(const MutableBuffers& buffers, Handler&& handler)
+    {
+        m_stream.async_read_some(buffers, std::forward<Handler>(handler));
+    }
+
+    template <class ConstBuffers, class Handler>
+    void async_write_some(const ConstBuffers& buffers, Handler&& handler)
+    {
+        m_stream.async_write_some(buffers, std::forward<Handler>(handler));
+    }
+
+    void cancel() { m_stream.cancel(); }
+
+private:
+    boost::asio::ip::tcp::socket m_socket;
+    UringStream                  m_stream;   /**< declared after the socket: cancelled before it closes */
+};
+
+
+template <class Handler>
+void startHandshake(UringSocket &, Handler handler)
+{
+    handler(boost::system::error_code());
+}
+
+inline void closeStream(UringSocket & socket)
+{
+    boost::system::error_code ignored;
+
+    socket.cancel();
+    socket.lowest_layer().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+    socket.lowest_layer().close(ignored);
+}
+
+#endif /* URINGSTREAM_H_0F4B7E2A_93C1_4D68_A5B2_7E19C64D0A35 */
@@ -9,9 +9,11 @@
 #include <csignal>
 #include <iostream>
 #include <cstdlib>
+#include <memory>
 #include <thread>
 
 #include "Arguments.h"
+#include "BridgeManager.h"
 #include "SerialBridge.h"
 #include "System.h"
 
@@ -23,16 +25,22 @@ int main(int argc, char** argv)
 	{
 		try
 		{
-			SerialBridge bridge(options);
-
-			while (!bridge.isSerialAvailable())
+			if (!options.strBridgesFile.empty())
 			{
-				bridge.waitForSerial(4000);
-			}
+				BridgeManager manager(options.strBridgesFile, argc, argv);
 
-			bridge.start();
+				if (manager.start())
+				{
+					System::run(options.uiThreads, options.cpuAffinity);
+				}
+			}
+			else
+			{
+				auto bridge = std::make_shared<SerialBridge>(options);
+				bridge->run();
 
-			System::run();
+				System::run(options.uiThreads, options.cpuAffinity);
+			}
 		}
 		catch (const char* const text)
 		{
@@ -0,0 +1,472 @@
+#ifndef BRIDGEHARNESS_H_6A1D8E35_F74C_4B02_9C3E_D15B70A4E8F2
+#define BRIDGEHARNESS_H_6A1D8E35_F74C_4B02_9C3E_D15B70A4E8F2
+
+/**
+ * @file		BridgeHarness.h
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ *
+ * Runs a SerialBridge process against a pseudo-terminal and loopback clients for the pty
+ * tests and serialbridge_bench: the harness plays the device on the master side. POSIX
+ * only, errors are thrown as string literals.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+
+/** non-blocking descriptor helpers with deadlines */
+struct BridgeHarness
+{
+    using Clock = std::chrono::steady_clock;
+
+    /** "SerialBridge\n\r", sent by the bridge to each client once the device is open */
+    static constexpr size_t HELLO_LENGTH = 14;
+
+    /** test data is a counter modulo a prime, so dropped, doubled or reordered bytes show */
+    static constexpr unsigned PATTERN_PERIOD = 251;
+
+    /** the pattern bytes from the given stream offset on */
+    static std::string pattern(size_t length, uint64_t offset = 0)
+    {
+        std::string data(length, '\0');
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            data[i] = static_cast<char>((offset + i) % PATTERN_PERIOD);
+        }
+
+        return data;
+    }
+
+    /** waits for the events until the deadline, false on timeout */
+    static bool waitFor(int fd, short events, Clock::time_point deadline)
+    {
+        for (;;)
+        {
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            pollfd descriptor{ fd, events, 0 };
+
+            if (remaining <= 0)
+            {
+                return false;
+            }
+
+            const int result = ::poll(&descriptor, 1, static_cast<int>(std::min<int64_t>(remaining, 100)));
+
+            if (result > 0)
+            {
+                return true;
+            }
+
+            if (result < 0 && EINTR != errno)
+            {
+                return false;
+            }
+        }
+    }
+
+    static bool writeAll(int fd, const char* data, size_t length, Clock::time_point deadline)
+    {
+        while (length > 0)
+        {
+            if (!waitFor(fd, POLLOUT, deadline))
+            {
+                return false;
+            }
+
+            const ssize_t result = ::write(fd, data, length);
+
+            if (result > 0)
+            {
+                data += result;
+                length -= static_cast<size_t>(result);
+            }
+            else if (result < 0 && EAGAIN != errno && EINTR != errno)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /** bytes read into the buffer, 0 on timeout, -1 on failure or end of stream */
+    static ssize_t readSome(int fd, char* buffer, size_t length, Clock::time_point deadline)
+    {
+        if (!waitFor(fd, POLLIN, deadline))
+        {
+            return 0;
+        }
+
+        const ssize_t result = ::read(fd, buffer, length);
+
+        if (result < 0 && (EAGAIN == errno || EINTR == errno))
+        {
+            return 0;
+        }
+
+        return result > 0 ? result : -1;
+    }
+
+    /** reads until the buffer is full, false on timeout or end of stream */
+    static bool readExactly(int fd, char* buffer, size_t length, Clock::time_point deadline)
+    {
+        while (length > 0)
+        {
+            const ssize_t result = readSome(fd, buffer, length, deadline);
+
+            if (result < 0 || (0 == result && Clock::now() >= deadline))
+            {
+                return false;
+            }
+
+            buffer += result;
+            length -= static_cast<size_t>(result);
+        }
+
+        return true;
+    }
+
+    static void setNonBlocking(int fd)
+    {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    /** a loopback port nobody listens on, as picked by the kernel */
+    static uint16_t freePort()
+    {
+        const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in address{};
+        socklen_t length = sizeof(address);
+
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (fd < 0 || 0 != ::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) ||
+            0 != ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length))
+        {
+            ::close(fd);
+            throw "Failed to find a free port!";
+        }
+
+        ::close(fd);
+        return ntohs(address.sin_port);
+    }
+
+    /** connects a loopback client, retrying for a few seconds until the bridge listens; -1 if it never does */
+    static int connect(uint16_t port, Clock::time_point deadline)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        for (;;)
+        {
+            const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            const int one = 1;
+
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            if (0 == ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)))
+            {
+                setNonBlocking(fd);
+                return fd;
+            }
+
+            ::close(fd);
+
+            if (Clock::now() > deadline)
+            {
+                return -1;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+};
+
+
+/** a fresh directory below the temp directory, removed with its content when going out of scope */
+class ScratchDirectory
+{
+public:
+    explicit ScratchDirectory(const std::string & prefix)
+        : m_path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path(prefix + "-%%%%-%%%%"))
+    {
+        boost::filesystem::create_directories(m_path);
+    }
+
+    ~ScratchDirectory()
+    {
+        boost::system::error_code ignored;
+        boost::filesystem::remove_all(m_path, ignored);
+    }
+
+    ScratchDirectory(const ScratchDirectory&) = delete;
+    ScratchDirectory& operator=(const ScratchDirectory&) = delete;
+
+    const boost::filesystem::path & path() const { return m_path; }
+
+    /** path of an entry in the directory */
+    std::string operator/(const std::string & name) const { return (m_path / name).string(); }
+
+private:
+    boost::filesystem::path m_path;
+};
+
+
+/** a pseudo-terminal pair, the harness acts as the device on the master side */
+class Terminal
+{
+public:
+    Terminal()
+    {
+        m_master = ::posix_openpt(O_RDWR | O_NOCTTY);
+
+        if (m_master < 0 || 0 != ::grantpt(m_master) || 0 != ::unlockpt(m_master) || nullptr == ::ptsname(m_master))
+        {
+            close();
+            throw "Failed to create a pseudo-terminal!";
+        }
+
+        m_slaveName = ::ptsname(m_master);
+
+        // held open so the terminal stays raw and never hangs up while the bridge reopens it
+        m_slave = ::open(m_slaveName.c_str(), O_RDWR | O_NOCTTY);
+        termios settings{};
+
+        if (m_slave < 0 || 0 != ::tcgetattr(m_slave, &settings))
+        {
+            close();
+            throw "Failed to open the pseudo-terminal!";
+        }
+
+        ::cfmakeraw(&settings);
+        ::tcsetattr(m_slave, TCSANOW, &settings);
+
+        BridgeHarness::setNonBlocking(m_master);
+    }
+
+    ~Terminal()
+    {
+        close();
+    }
+
+    Terminal(const Terminal&) = delete;
+    Terminal& operator=(const Terminal&) = delete;
+
+    int master() const { return m_master; }
+    int slave() const { return m_slave; }
+    const std::string & slaveName() const { return m_slaveName; }
+
+private:
+    void close()
+    {
+        if (m_slave >= 0)
+        {
+            ::close(m_slave);
+        }
+
+        if (m_master >= 0)
+        {
+            ::close(m_master);
+        }
+
+        m_slave = m_master = -1;
+    }
+
+    int         m_master = -1;
+    int         m_slave = -1;
+    std::string m_slaveName;
+};
+
+
+/** a bridge as a child process, killed when going out of scope */
+class BridgeProcess
+{
+public:
+    /** starts the executable with the arguments, its output goes to the log file */
+    BridgeProcess(const std::string & executable, const std::vector<std::string> & arguments, const std::string & log = "/dev/null")
+    {
+        std::vector<std::string> command = { executable };
+        command.insert(command.end(), arguments.begin(), arguments.end());
+
+        std::vector<char*> argv;
+
+        for (auto & argument : command)
+        {
+            argv.push_back(&argument[0]);
+        }
+
+        argv.push_back(nullptr);
+
+        m_pid = ::fork();
+
+        if (m_pid < 0)
+        {
+            throw "Failed to start the bridge!";
+        }
+
+        if (0 == m_pid)
+        {
+            const int output = ::open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+            ::dup2(output, STDOUT_FILENO);
+            ::dup2(output, STDERR_FILENO);
+            ::execv(argv[0], argv.data());
+            ::_exit(127);
+        }
+    }
+
+    ~BridgeProcess()
+    {
+        ::kill(m_pid, SIGKILL);
+        ::waitpid(m_pid, nullptr, 0);
+    }
+
+    BridgeProcess(const BridgeProcess&) = delete;
+    BridgeProcess& operator=(const BridgeProcess&) = delete;
+
+    void signal(int number) const
+    {
+        ::kill(m_pid, number);
+    }
+
+    bool alive() const
+    {
+        return 0 == ::waitpid(m_pid, nullptr, WNOHANG);
+    }
+
+    /** user and system time so far */
+    double cpuSeconds() const
+    {
+        std::ifstream file("/proc/" + std::to_string(m_pid) + "/stat");
+        std::string line;
+        std::getline(file, line);
+
+        // the fields after the command name, which may contain blanks
+        std::istringstream fields(line.substr(line.rfind(')') + 2));
+        std::string field;
+        unsigned long long user = 0;
+        unsigned long long system = 0;
+
+        for (int i = 3; i <= 15 && fields >> field; ++i)
+        {
+            if (14 == i)
+            {
+                user = std::stoull(field);
+            }
+            else if (15 == i)
+            {
+                system = std::stoull(field);
+            }
+        }
+
+        return static_cast<double>(user + system) / static_cast<double>(::sysconf(_SC_CLK_TCK));
+    }
+
+    /** read and write family system calls so far (syscr + syscw) */
+    uint64_t syscalls() const
+    {
+        std::ifstream file("/proc/" + std::to_string(m_pid) + "/io");
+        uint64_t count = 0;
+
+        for (std::string line; std::getline(file, line); )
+        {
+            if (0 == line.compare(0, 6, "syscr:") || 0 == line.compare(0, 6, "syscw:"))
+            {
+                count += std::stoull(line.substr(6));
+            }
+        }
+
+        return count;
+    }
+
+    /** KiB, VmHWM */
+    uint64_t peakRss() const
+    {
+        std::ifstream file("/proc/" + std::to_string(m_pid) + "/status");
+
+        for (std::string line; std::getline(file, line); )
+        {
+            if (0 == line.compare(0, 6, "VmHWM:"))
+            {
+                return std::stoull(line.substr(6));
+            }
+        }
+
+        return 0;
+    }
+
+    /** connects the clients and waits for each hello, throws if the bridge does not get ready */
+    std::vector<int> connectClients(uint16_t port, unsigned count) const
+    {
+        std::vector<int> clients;
+        const BridgeHarness::Clock::time_point deadline = BridgeHarness::Clock::now() + std::chrono::seconds(5);
+
+        while (clients.size() < count)
+        {
+            const int fd = alive() ? BridgeHarness::connect(port, std::min(deadline, BridgeHarness::Clock::now() + std::chrono::milliseconds(200))) : -1;
+
+            if (fd < 0 && (BridgeHarness::Clock::now() > deadline || !alive()))
+            {
+                closeAll(clients);
+                throw "The bridge does not accept clients!";
+            }
+
+            if (fd >= 0)
+            {
+                clients.push_back(fd);
+            }
+        }
+
+        for (const int client : clients)
+        {
+            char hello[BridgeHarness::HELLO_LENGTH];
+
+            if (!BridgeHarness::readExactly(client, hello, sizeof(hello), deadline))
+            {
+                closeAll(clients);
+                throw "The bridge did not open the device!";
+            }
+        }
+
+        return clients;
+    }
+
+    static void closeAll(const std::vector<int> & fds)
+    {
+        for (const int fd : fds)
+        {
+            ::close(fd);
+        }
+    }
+
+private:
+    pid_t m_pid = -1;
+};
+
+#endif /* BRIDGEHARNESS_H_6A1D8E35_F74C_4B02_9C3E_D15B70A4E8F2 */
@@ -0,0 +1,373 @@
+/**
+ * @file		BridgeTest.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ *
+ * Runs the SerialBridge executable against pseudo-terminals and loopback clients
+ */
+
+#define BOOST_TEST_MODULE Bridge
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BridgeHarness.h"
+#include "ReliableSession.h"
+
+
+using Clock = BridgeHarness::Clock;
+
+uint32_t dataSegmentsIn(int fd);
+
+
+/** a bridge on a pty in a scratch directory, its output is shown with --log_level=message */
+struct BridgeFixture
+{
+    ScratchDirectory               directory{ "serialbridge-test" };
+    uint16_t                       port = BridgeHarness::freePort();
+    std::unique_ptr<Terminal>      terminal{ new Terminal() };
+    std::unique_ptr<BridgeProcess> bridge;
+    std::vector<int>               clients;
+
+    ~BridgeFixture()
+    {
+        BridgeProcess::closeAll(clients);
+        bridge.reset();
+
+        BOOST_TEST_MESSAGE("bridge output:\n" << log());
+    }
+
+    void start(const std::string & device, const std::vector<std::string> & options = {})
+    {
+        std::vector<std::string> arguments = { "-d", device, "-p", std::to_string(port), "-i", "127.0.0.1", "--reconnect-min", "20", "--reconnect-max", "100" };
+
+        arguments.insert(arguments.end(), options.begin(), options.end());
+        bridge.reset(new BridgeProcess(SERIALBRIDGE_EXECUTABLE, arguments, directory / "bridge.log"));
+    }
+
+    std::string log() const
+    {
+        std::ifstream file(directory / "bridge.log");
+        std::stringstream text;
+
+        text << file.rdbuf();
+        return text.str();
+    }
+
+    /** the device writes the data while a reliable udp client acknowledges it, returns what the client got after the hello */
+    std::string streamReliable(const std::string & data)
+    {
+        const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        sockaddr_in address{};
+
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        BOOST_REQUIRE(0 == ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)));
+        clients.push_back(fd);
+
+        std::string received;
+        ReliableSession session([&received](const char* payload, size_t length) { received.append(payload, length); },
+                                [fd](const uint8_t* header, size_t headerLength, const SharedChunk & payload)
+                                {
+                                    std::vector<char> frame(header, header + headerLength);
+
+                                    if (payload)
+                                    {
+                                        frame.insert(frame.end(), payload->begin(), payload->end());
+                                    }
+
+                                    ::send(fd, frame.data(), frame.size(), 0);
+                                });
+
+        // an empty frame makes the bridge know the peer, its retransmissions cover the simulated loss
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        session.send(makeChunk("", 0), Clock::now());
+
+        const std::string hello = "SerialBridge\n\r";
+        const Clock::time_point deadline = Clock::now() + std::chrono::seconds(20);
+        size_t written = 0;
+
+        while (received.size() < hello.size() + data.size() && Clock::now() < deadline)
+        {
+            char frame[2048];
+
+            if (BridgeHarness::waitFor(fd, POLLIN, Clock::now() + std::chrono::milliseconds(5)))
+            {
+                const ssize_t length = ::recv(fd, frame, sizeof(frame), 0);
+
+                if (length > 0)
+                {
+                    session.receive(frame, static_cast<size_t>(length), Clock::now());
+                }
+            }
+
+            session.poll(Clock::now());
+
+            // written as the terminal takes it, a paused bridge leaves it full
+            if (received.size() >= hello.size() && written < data.size())
+            {
+                const ssize_t length = ::write(terminal->master(), data.data() + written, data.size() - written);
+
+                written += (length > 0) ? static_cast<size_t>(length) : 0;
+            }
+        }
+
+        BOOST_TEST(received.compare(0, hello.size(), hello) == 0);
+        return received.substr(std::min(hello.size(), received.size()));
+    }
+
+    static std::string receive(int fd, size_t length, Clock::duration timeout = std::chrono::seconds(5))
+    {
+        std::string data(length, '\0');
+
+        if (!BridgeHarness::readExactly(fd, &data[0], length, Clock::now() + timeout))
+        {
+            return std::string();
+        }
+
+        return data;
+    }
+
+    static bool send(int fd, const std::string & data)
+    {
+        return BridgeHarness::writeAll(fd, data.data(), data.size(), Clock::now() + std::chrono::seconds(5));
+    }
+};
+
+
+BOOST_FIXTURE_TEST_SUITE(bridge, BridgeFixture)
+
+BOOST_AUTO_TEST_CASE(serial_data_goes_out_in_few_segments)
+{
+    start(terminal->slaveName());
+    clients = bridge->connectClients(port, 1);
+
+    const std::string data = BridgeHarness::pattern(64 * 1024);
+    const uint32_t before = dataSegmentsIn(clients[0]);
+
+    BOOST_REQUIRE(send(terminal->master(), data));
+    BOOST_TEST(receive(clients[0], data.size()) == data);
+
+    // one segment per byte would be 1024 per KiB, batched writes take at most one per receive buffer (512 B)
+    const double perKiB = static_cast<double>(dataSegmentsIn(clients[0]) - before) / 64.0;
+
+    BOOST_TEST_MESSAGE("segments per KiB: " << perKiB);
+    BOOST_TEST(perKiB <= 4.0);
+}
+
+
+BOOST_AUTO_TEST_CASE(client_data_reaches_the_device)
+{
+    start(terminal->slaveName());
+    clients = bridge->connectClients(port, 2);
+
+    const std::string first = BridgeHarness::pattern(10000);
+    const std::string second(10000, 'x');
+
+    BOOST_REQUIRE(send(clients[0], first));
+    BOOST_TEST(receive(terminal->master(), first.size()) == first);
+
+    BOOST_REQUIRE(send(clients[1], second));
+    BOOST_TEST(receive(terminal->master(), second.size()) == second);
+}
+
+
+BOOST_AUTO_TEST_CASE(custom_baud_rate_is_set_through_termios2)
+{
+    start(terminal->slaveName(), { "-b", "250000" });
+    clients = bridge->connectClients(port, 1);
+
+    termios settings{};
+    BOOST_REQUIRE(0 == ::tcgetattr(terminal->slave(), &settings));
+
+    // BOTHER (asm/termbits.h): the rate is taken from c_ospeed, no Bxxx code exists for 250000
+    BOOST_TEST((settings.c_cflag & CBAUD) == 0010000U);
+    BOOST_TEST(log().find("connected (250000 baud") != std::string::npos);
+}
+
+
+BOOST_AUTO_TEST_CASE(replaced_device_node_keeps_the_clients)
+{
+    const std::string link = directory / "ttyTEST";
+
+    BOOST_REQUIRE(0 == ::symlink(terminal->slaveName().c_str(), link.c_str()));
+
+    start(link);
+    clients = bridge->connectClients(port, 1);
+
+    BOOST_REQUIRE(send(terminal->master(), "before"));
+    BOOST_TEST(receive(clients[0], 6) == "before");
+
+    // unplugged: the node goes away and the old terminal hangs up
+    ::unlink(link.c_str());
+    terminal.reset();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    const Clock::time_point replugged = Clock::now();
+
+    terminal.reset(new Terminal());
+    BOOST_REQUIRE(0 == ::symlink(terminal->slaveName().c_str(), link.c_str()));
+
+    // the same connection gets a new hello once the device is open again
+    BOOST_TEST(receive(clients[0], BridgeHarness::HELLO_LENGTH) == "SerialBridge\n\r");
+    BOOST_REQUIRE(send(terminal->master(), "after"));
+    BOOST_TEST(receive(clients[0], 5) == "after");
+
+    BOOST_TEST_MESSAGE("replug to data: " << std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - replugged).count() << " ms");
+    BOOST_TEST(bridge->alive());
+}
+
+
+#ifdef SERIALBRIDGE_WITH_SPOOL
+BOOST_AUTO_TEST_CASE(spool_drains_with_a_zero_low_watermark)
+{
+    start(terminal->slaveName(), { "--spool-dir", directory / "spool", "--tx-low-watermark", "0", "--tx-high-watermark", "16" });
+
+    // nobody listens yet, so everything goes to the spool; the bridge has to open the device first
+    const std::string spooled = BridgeHarness::pattern(200000);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    BOOST_REQUIRE(send(terminal->master(), spooled));
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    clients = bridge->connectClients(port, 1);
+    BOOST_TEST(receive(clients[0], spooled.size()) == spooled);
+
+    BOOST_REQUIRE(send(terminal->master(), "live"));
+    BOOST_TEST(receive(clients[0], 4) == "live");
+    BOOST_TEST(log().find("Spool drained") != std::string::npos);
+}
+#endif
+
+
+BOOST_AUTO_TEST_CASE(bridges_file_reload_keeps_untouched_bridges)
+{
+    Terminal second;
+    const uint16_t secondPort = BridgeHarness::freePort();
+    const uint16_t movedPort = BridgeHarness::freePort();
+    const std::string file = directory / "bridges.ini";
+
+    auto configure = [&](uint16_t portOfSecond)
+                     {
+                         std::ofstream ini(file, std::ios::trunc);
+
+                         ini << "ip = 127.0.0.1\n"
+                             << "[first]\ndevice = " << terminal->slaveName() << "\nport = " << port << "\n"
+                             << "[second]\ndevice = " << second.slaveName() << "\nport = " << portOfSecond << "\n";
+                     };
+
+    configure(secondPort);
+    bridge.reset(new BridgeProcess(SERIALBRIDGE_EXECUTABLE, { "-c", file }, directory / "bridge.log"));
+
+    clients = bridge->connectClients(port, 1);
+
+    const std::vector<int> others = bridge->connectClients(secondPort, 1);
+    clients.insert(clients.end(), others.begin(), others.end());
+
+    BOOST_REQUIRE(send(second.master(), "second"));
+    BOOST_TEST(receive(clients[1], 6) == "second");
+
+    // only the second bridge changes, the client of the first one stays connected
+    configure(movedPort);
+    bridge->signal(SIGHUP);
+
+    const std::vector<int> moved = bridge->connectClients(movedPort, 1);
+    clients.insert(clients.end(), moved.begin(), moved.end());
+
+    BOOST_REQUIRE(send(second.master(), "moved"));
+    BOOST_TEST(receive(clients[2], 5) == "moved");
+
+    BOOST_REQUIRE(send(terminal->master(), "first"));
+    BOOST_TEST(receive(clients[0], 5) == "first");
+}
+
+
+BOOST_AUTO_TEST_CASE(history_replays_the_configured_amount)
+{
+    // 3 KiB, while the ring behind it has 4 KiB
+    start(terminal->slaveName(), { "--history", "3" });
+
+    const std::string data = BridgeHarness::pattern(10000);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    BOOST_REQUIRE(send(terminal->master(), data));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    clients = bridge->connectClients(port, 1);
+    BOOST_REQUIRE(send(terminal->master(), "live"));
+
+    BOOST_TEST(receive(clients[0], 3072 + 4) == data.substr(data.size() - 3072) + "live");
+}
+
+
+BOOST_AUTO_TEST_CASE(udp_history_replay_keeps_the_datagram_size)
+{
+    start(terminal->slaveName(), { "-u", "--udp-max-datagram", "512", "--history", "4" });
+
+    const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    sockaddr_in address{};
+
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    BOOST_REQUIRE(0 == ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)));
+    clients.push_back(fd);
+
+    // recorded before the peer is known, replayed in one piece once it registers with its first datagram
+    const std::string data = BridgeHarness::pattern(3000);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    BOOST_REQUIRE(send(terminal->master(), data));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    BOOST_REQUIRE(1 == ::send(fd, "x", 1, 0));
+
+    const std::string hello = "SerialBridge\n\r";
+    const Clock::time_point deadline = Clock::now() + std::chrono::seconds(5);
+    std::string received;
+    size_t largest = 0;
+
+    while (received.size() < hello.size() + data.size() && BridgeHarness::waitFor(fd, POLLIN, deadline))
+    {
+        char datagram[65536];
+        const ssize_t length = ::recv(fd, datagram, sizeof(datagram), 0);
+
+        if (length > 0)
+        {
+            received.append(datagram, static_cast<size_t>(length));
+            largest = std::max(largest, static_cast<size_t>(length));
+        }
+    }
+
+    BOOST_TEST(largest <= 512U);
+    BOOST_TEST((received == hello + data));
+}
+
+
+BOOST_AUTO_TEST_CASE(reliable_udp_survives_loss_and_reordering)
+{
+    start(terminal->slaveName(), { "-u", "--udp-reliable", "--udp-sim-loss", "10", "--udp-sim-reorder", "10" });
+
+    const std::string data = BridgeHarness::pattern(100000);
+    BOOST_TEST((streamReliable(data) == data));
+}
+
+
+BOOST_AUTO_TEST_CASE(reliable_udp_pauses_the_device_instead_of_dropping)
+{
+    // the unacknowledged bytes of the session exceed 4 KiB at once, the device has to wait for the acks
+    start(terminal->slaveName(), { "-u", "--udp-reliable", "--udp-sim-loss", "10", "--tx-high-watermark", "4", "--tx-low-watermark", "1" });
+
+    const std::string data = BridgeHarness::pattern(300000);
+    BOOST_TEST((streamReliable(data) == data));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
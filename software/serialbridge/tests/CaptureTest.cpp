@@ -0,0 +1,168 @@
+/**
+ * @file		CaptureTest.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#define BOOST_TEST_MODULE Capture
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "BridgeHarness.h"
+#include "Capture.h"
+
+
+/** records of varying size in both directions, in a scratch directory */
+struct CaptureFixture
+{
+    struct Expected
+    {
+        Capture::eDirection direction;
+        ClientId            client;
+        std::string         data;
+    };
+
+    ScratchDirectory      scratch{ "serialbridge-capture" };
+    std::string           path = scratch / "capture.sbc";
+    std::vector<Expected> records;
+
+    /** appends count records, about the given bytes each */
+    void write(CaptureWriter & writer, size_t count, size_t size)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const bool fromSerial = 0 == i % 3;
+            Expected record{ fromSerial ? Capture::eDirection::SerialToNetwork : Capture::eDirection::NetworkToSerial,
+                             fromSerial ? 0U : static_cast<ClientId>(1 + i % 4),
+                             std::string(size + i % 7, static_cast<char>('a' + i % 26)) };
+
+            writer.record(record.direction, record.client, record.data.data(), record.data.size());
+            records.push_back(record);
+        }
+    }
+
+    /** every record has to come back in order, with increasing timestamps */
+    void verify(CaptureReader & reader)
+    {
+        CaptureRecord record;
+        uint64_t previous = 0;
+        size_t index = 0;
+
+        while (reader.next(record))
+        {
+            BOOST_REQUIRE(index < records.size());
+            BOOST_TEST((record.direction == records[index].direction));
+            BOOST_TEST(record.client == records[index].client);
+            BOOST_TEST(std::string(record.data, record.length) == records[index].data);
+            BOOST_TEST(record.timestamp >= previous);
+
+            previous = record.timestamp;
+            ++index;
+        }
+
+        BOOST_TEST(index == records.size());
+    }
+};
+
+
+BOOST_FIXTURE_TEST_SUITE(capture, CaptureFixture)
+
+BOOST_AUTO_TEST_CASE(reads_back_what_was_written)
+{
+    {
+        CaptureWriter writer(path);
+        write(writer, 1000, 100);
+
+        BOOST_TEST(writer.records() == records.size());
+    }
+
+    CaptureReader reader(path);
+
+    BOOST_TEST(reader.header().version == Capture::VERSION);
+    verify(reader);
+
+    // the reserved rest of the last window is cut off on close
+    BOOST_TEST(boost::filesystem::file_size(path) == reader.header().end);
+
+    reader.rewind();
+    verify(reader);
+}
+
+
+BOOST_AUTO_TEST_CASE(reads_a_capture_still_being_recorded)
+{
+    CaptureWriter writer(path);
+    write(writer, 200, 1000);
+
+    // the file still has its reserved window and no index, the header tells where the records end
+    CaptureReader reader(path);
+    verify(reader);
+}
+
+
+BOOST_AUTO_TEST_CASE(seeks_via_the_index_chain)
+{
+    // 5 MB, two index records with the 64 KiB stride and 64 entries per index record
+    {
+        CaptureWriter writer(path);
+        write(writer, 5000, 1024);
+    }
+
+    CaptureReader reader(path);
+    std::vector<CaptureRecord> all;
+    CaptureRecord record;
+
+    while (reader.next(record))
+    {
+        all.push_back(record);
+    }
+
+    BOOST_REQUIRE(all.size() == records.size());
+    BOOST_TEST(0U != reader.header().lastIndex);
+
+    for (size_t target : { size_t(0), size_t(10), size_t(2500), size_t(4000), all.size() - 1 })
+    {
+        // records sharing a timestamp cannot be told apart by seeking
+        while (target > 0 && target + 1 < all.size() &&
+               (all[target - 1].timestamp == all[target].timestamp || all[target + 1].timestamp == all[target].timestamp))
+        {
+            --target;
+        }
+
+        reader.seek(all[target].timestamp);
+
+        BOOST_REQUIRE(reader.next(record));
+
+        // lands on an indexed record at or before the target, at most one stride away
+        BOOST_TEST(record.offset <= all[target].offset);
+        BOOST_TEST(all[target].offset - record.offset <= Capture::INDEX_STRIDE + 2048);
+        BOOST_TEST(record.timestamp <= all[target].timestamp);
+
+        while (record.offset < all[target].offset && reader.next(record))
+        {
+        }
+
+        BOOST_TEST(record.offset == all[target].offset);
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(rejects_other_files)
+{
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    BOOST_REQUIRE(file);
+    std::fputs("this is not a capture file, but long enough to hold a header of 64 bytes........", file);
+    std::fclose(file);
+
+    BOOST_CHECK_THROW(CaptureReader reader(path), const char*);
+    BOOST_CHECK_THROW(CaptureReader reader(path + ".missing"), const char*);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,87 @@
+/**
+ * @file		ChunkQueueTest.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#define BOOST_TEST_MODULE ChunkQueue
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#include "ChunkQueue.h"
+
+
+static SharedChunk chunk(const std::string & text)
+{
+    return makeChunk(text.data(), text.size());
+}
+
+/** the queued chunks from the front, concatenated */
+static std::string contents(const ChunkQueue & queue)
+{
+    std::string text;
+
+    for (size_t i = 0; i < queue.size(); ++i)
+    {
+        text.append(queue.at(i)->begin(), queue.at(i)->end());
+    }
+
+    return text;
+}
+
+
+BOOST_AUTO_TEST_CASE(erase_keeps_the_gathered_front)
+{
+    ChunkQueue queue(8);
+
+    for (const char* text : { "a", "b", "c", "d", "e" })
+    {
+        BOOST_REQUIRE(queue.push(chunk(text)));
+    }
+
+    // a pending write owns the first two chunks, their data has to stay where it is
+    std::vector<boost::asio::const_buffer> buffers;
+    BOOST_REQUIRE(queue.gather(buffers, 2) == 2U);
+
+    queue.erase(2, 2);
+
+    BOOST_TEST(contents(queue) == "abe");
+    BOOST_TEST(buffers[0].data() == queue.at(0)->data());
+    BOOST_TEST(buffers[1].data() == queue.at(1)->data());
+
+    queue.pop(2);
+    BOOST_TEST(contents(queue) == "e");
+}
+
+
+BOOST_AUTO_TEST_CASE(erase_across_the_wrap_around)
+{
+    ChunkQueue queue(4);
+
+    for (const char* text : { "x", "y", "z" })
+    {
+        BOOST_REQUIRE(queue.push(chunk(text)));
+    }
+
+    queue.pop(3);
+
+    for (const char* text : { "a", "b", "c", "d" })
+    {
+        BOOST_REQUIRE(queue.push(chunk(text)));
+    }
+
+    BOOST_TEST(!queue.push(chunk("full")));
+
+    queue.erase(1, 3);
+    BOOST_TEST(contents(queue) == "a");
+
+    // the freed slots take new chunks behind the kept one
+    BOOST_REQUIRE(queue.push(chunk("e")));
+    BOOST_TEST(contents(queue) == "ae");
+
+    queue.erase(0, 1);
+    BOOST_TEST(contents(queue) == "e");
+}
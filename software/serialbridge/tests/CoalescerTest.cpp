@@ -0,0 +1,115 @@
+/**
+ * @file		CoalescerTest.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#define BOOST_TEST_MODULE Coalescer
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+
+#include "Coalescer.h"
+
+
+/** a coalescer on a single threaded io_context, collecting what it flushes */
+struct CoalescerFixture
+{
+    boost::asio::io_context    io;
+    Coalescer::Settings        settings;
+    std::vector<std::string>   flushes;
+    std::shared_ptr<Coalescer> coalescer;
+
+    CoalescerFixture()
+    {
+        settings.maxDelayMicros = 20000;
+        settings.maxBytes = 64;
+    }
+
+    void create()
+    {
+        coalescer = std::make_shared<Coalescer>(io.get_executor(), settings, [this](const char* data, size_t length)
+                                                {
+                                                    flushes.emplace_back(data, length);
+                                                });
+    }
+
+    uint64_t count(Coalescer::eFlush reason) const
+    {
+        return coalescer->statistics().flushes[static_cast<size_t>(reason)];
+    }
+};
+
+
+BOOST_FIXTURE_TEST_SUITE(coalescer, CoalescerFixture)
+
+BOOST_AUTO_TEST_CASE(collects_until_the_delay_expires)
+{
+    create();
+
+    coalescer->append("ab", 2);
+    coalescer->append("cd", 2);
+    BOOST_TEST(flushes.empty());
+
+    io.run_for(std::chrono::milliseconds(100));
+
+    BOOST_REQUIRE(flushes.size() == 1U);
+    BOOST_TEST(flushes[0] == "abcd");
+    BOOST_TEST(count(Coalescer::eFlush::Timer) == 1U);
+}
+
+
+BOOST_AUTO_TEST_CASE(flushes_up_to_the_delimiter_and_at_the_size)
+{
+    settings.delimiter = '\n';
+    create();
+
+    coalescer->append("one\ntw", 6);
+    coalescer->append(std::string(64, 'x').data(), 64);
+
+    BOOST_REQUIRE(flushes.size() == 2U);
+    BOOST_TEST(flushes[0] == "one\n");
+    BOOST_TEST(flushes[1] == "tw" + std::string(64, 'x'));
+    BOOST_TEST(count(Coalescer::eFlush::Delimiter) == 1U);
+    BOOST_TEST(count(Coalescer::eFlush::Size) == 1U);
+}
+
+
+BOOST_AUTO_TEST_CASE(an_expired_timer_does_not_cut_the_next_buffer_short)
+{
+    create();
+
+    coalescer->append("old", 3);
+
+    // the timer expires while the loop is busy, its completion is ready before the flush below cancels it
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    boost::asio::post(io, [this]()
+                      {
+                          coalescer->flush();
+                          coalescer->append("new", 3);
+                      });
+
+    io.poll();
+
+    BOOST_REQUIRE(flushes.size() == 1U);
+    BOOST_TEST(flushes[0] == "old");
+    BOOST_TEST(count(Coalescer::eFlush::Explicit) == 1U);
+    BOOST_TEST(count(Coalescer::eFlush::Timer) == 0U);
+
+    // the new data still waits for its own delay
+    io.run_for(std::chrono::milliseconds(100));
+
+    BOOST_REQUIRE(flushes.size() == 2U);
+    BOOST_TEST(flushes[1] == "new");
+    BOOST_TEST(count(Coalescer::eFlush::Timer) == 1U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
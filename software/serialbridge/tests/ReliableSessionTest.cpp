@@ -0,0 +1,289 @@
+/**
+ * @file		ReliableSessionTest.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ *
+ * Two sessions connected by a simulated link with loss, reordering and latency, on a virtual clock
+ */
+
+#define BOOST_TEST_MODULE ReliableSession
+#include <boost/test/unit_test.hpp>
+
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ReliableSession.h"
+
+
+using Clock = ReliableSession::Clock;
+
+
+/** one direction of the link: frames arrive after the latency, some later (reordered), some never */
+struct Wire
+{
+    struct Datagram
+    {
+        Clock::time_point arrival;
+        std::vector<char> bytes;
+    };
+
+    std::mt19937                   random{ 4711 };
+    unsigned                       lossPercent = 0;
+    unsigned                       reorderPercent = 0;
+    Clock::duration                latency = std::chrono::milliseconds(5);
+    Clock::time_point *            now = nullptr;
+    std::deque<Datagram>           inFlight;
+    std::vector<std::vector<char>> sent;          /**< everything put on the wire, lost ones included */
+    std::vector<uint32_t>          dropOnce;      /**< data sequences lost on their first transmission */
+
+    void transmit(const uint8_t* header, size_t headerLength, const SharedChunk & payload)
+    {
+        std::vector<char> bytes(header, header + headerLength);
+
+        if (payload)
+        {
+            bytes.insert(bytes.end(), payload->begin(), payload->end());
+        }
+
+        sent.push_back(bytes);
+
+        const uint32_t sequence = (uint32_t(uint8_t(bytes[4])) << 24) | (uint32_t(uint8_t(bytes[5])) << 16) |
+                                  (uint32_t(uint8_t(bytes[6])) << 8) | uint32_t(uint8_t(bytes[7]));
+
+        for (auto drop = dropOnce.begin(); drop != dropOnce.end(); ++drop)
+        {
+            if (static_cast<uint8_t>(ReliableSession::eFrameType::Data) == bytes[1] && *drop == sequence)
+            {
+                dropOnce.erase(drop);
+                return;
+            }
+        }
+
+        if (std::uniform_int_distribution<unsigned>(0, 99)(random) < lossPercent)
+        {
+            return;
+        }
+
+        const bool late = std::uniform_int_distribution<unsigned>(0, 99)(random) < reorderPercent;
+        inFlight.push_back(Datagram{ *now + latency + (late ? 3 * latency : Clock::duration::zero()), std::move(bytes) });
+    }
+
+    /** hands the frames due by now to the receiver */
+    void deliver(ReliableSession & receiver)
+    {
+        for (auto datagram = inFlight.begin(); datagram != inFlight.end(); )
+        {
+            if (datagram->arrival <= *now)
+            {
+                const std::vector<char> bytes = std::move(datagram->bytes);
+
+                datagram = inFlight.erase(datagram);
+                BOOST_REQUIRE(receiver.receive(bytes.data(), bytes.size(), *now));
+            }
+            else
+            {
+                ++datagram;
+            }
+        }
+    }
+};
+
+
+/** the sender streams data to the receiver, which only acknowledges */
+struct Link
+{
+    Clock::time_point now{ std::chrono::seconds(1) };
+    Wire              forward;
+    Wire              backward;
+    std::string       received;
+
+    ReliableSession   sender{ [](const char*, size_t) {},
+                              [this](const uint8_t* header, size_t length, const SharedChunk & payload) { forward.transmit(header, length, payload); } };
+    ReliableSession   receiver{ [this](const char* data, size_t length) { received.append(data, length); },
+                                [this](const uint8_t* header, size_t length, const SharedChunk & payload) { backward.transmit(header, length, payload); } };
+
+    Link()
+    {
+        forward.now = &now;
+        backward.now = &now;
+    }
+
+    /** advances the clock in 1 ms steps, with or without the retransmission timer of the sender */
+    void run(Clock::duration duration, bool withTimeouts = true)
+    {
+        for (const Clock::time_point end = now + duration; now < end; now += std::chrono::milliseconds(1))
+        {
+            forward.deliver(receiver);
+            backward.deliver(sender);
+
+            if (withTimeouts)
+            {
+                sender.poll(now);
+                receiver.poll(now);
+            }
+        }
+    }
+
+    /** sends numbered payloads and returns what has to arrive */
+    std::string send(unsigned count, unsigned first = 0)
+    {
+        std::string expected;
+
+        for (unsigned i = first; i < first + count; ++i)
+        {
+            const std::string payload = "payload " + std::to_string(i) + ";";
+
+            expected += payload;
+            sender.send(makeChunk(payload.data(), payload.size()), now);
+        }
+
+        return expected;
+    }
+};
+
+
+BOOST_AUTO_TEST_CASE(lossless_link_delivers_in_order_without_retransmissions)
+{
+    Link link;
+    const std::string expected = link.send(500);
+
+    link.run(std::chrono::seconds(2));
+
+    BOOST_TEST(link.received == expected);
+    BOOST_TEST(link.sender.pendingBytes() == 0U);
+    BOOST_TEST(link.sender.retransmissions() == 0U);
+    BOOST_TEST(link.receiver.duplicates() == 0U);
+}
+
+
+BOOST_AUTO_TEST_CASE(window_limits_the_frames_in_flight)
+{
+    Link link;
+
+    link.send(3 * ReliableSession::WINDOW);
+
+    BOOST_TEST(link.forward.sent.size() == ReliableSession::WINDOW);
+    BOOST_TEST(link.sender.pendingBytes() > 0U);
+}
+
+
+BOOST_AUTO_TEST_CASE(discarding_the_backlog_keeps_the_frames_in_flight)
+{
+    Link link;
+    const std::string inFlight = link.send(ReliableSession::WINDOW);
+
+    link.send(2 * ReliableSession::WINDOW, ReliableSession::WINDOW);
+
+    const size_t pending = link.sender.pendingBytes();
+
+    BOOST_TEST(link.sender.discardBacklog(0) == pending - inFlight.size());
+    BOOST_TEST(link.sender.pendingBytes() == inFlight.size());
+
+    // the sequence continues without a hole, later payloads follow the ones in flight
+    const std::string later = link.send(10, 1000);
+
+    link.run(std::chrono::seconds(1));
+
+    BOOST_TEST(link.received == inFlight + later);
+    BOOST_TEST(link.sender.pendingBytes() == 0U);
+    BOOST_TEST(link.sender.retransmissions() == 0U);
+}
+
+
+BOOST_AUTO_TEST_CASE(loss_and_reordering_keep_order_and_exactly_once)
+{
+    Link link;
+
+    link.forward.lossPercent = 20;
+    link.forward.reorderPercent = 20;
+    link.backward.lossPercent = 20;
+    link.backward.reorderPercent = 20;
+
+    std::string expected;
+
+    // fed in bursts, so the window runs full and drains repeatedly
+    for (unsigned burst = 0; burst < 20; ++burst)
+    {
+        expected += link.send(50, burst * 50);
+        link.run(std::chrono::milliseconds(100));
+    }
+
+    link.run(std::chrono::seconds(30));
+
+    BOOST_TEST(link.received == expected);
+    BOOST_TEST(link.sender.pendingBytes() == 0U);
+    BOOST_TEST(link.sender.retransmissions() > 0U);
+    BOOST_TEST(link.receiver.duplicates() > 0U);
+}
+
+
+BOOST_AUTO_TEST_CASE(selective_ack_retransmits_a_hole_before_the_timeout)
+{
+    Link link;
+    std::string expected;
+
+    link.forward.dropOnce.push_back(0);
+
+    // without the retransmission timer only acks revealing the hole can repair it
+    for (unsigned i = 0; i < 20; ++i)
+    {
+        expected += link.send(1, i);
+        link.run(std::chrono::milliseconds(5), false);
+    }
+
+    link.run(std::chrono::milliseconds(50), false);
+
+    BOOST_TEST(link.received == expected);
+    BOOST_TEST(link.sender.retransmissions() >= 1U);
+    BOOST_TEST(link.sender.pendingBytes() == 0U);
+}
+
+
+BOOST_AUTO_TEST_CASE(timeout_retransmits_a_lost_tail)
+{
+    Link link;
+
+    // the last frame has no successor whose ack could reveal its loss
+    link.forward.dropOnce.push_back(0);
+
+    const std::string expected = link.send(1);
+
+    link.run(std::chrono::milliseconds(100), false);
+    BOOST_TEST(link.received.empty());
+
+    link.run(std::chrono::seconds(1));
+    BOOST_TEST(link.received == expected);
+    BOOST_TEST(link.sender.retransmissions() == 1U);
+}
+
+
+BOOST_AUTO_TEST_CASE(duplicate_frames_are_delivered_once)
+{
+    Link link;
+    const std::string expected = link.send(1);
+
+    link.run(std::chrono::milliseconds(20));
+
+    const std::vector<char> frame = link.forward.sent.front();
+
+    BOOST_TEST(link.receiver.receive(frame.data(), frame.size(), link.now));
+    BOOST_TEST(link.receiver.receive(frame.data(), frame.size(), link.now));
+
+    BOOST_TEST(link.received == expected);
+    BOOST_TEST(link.receiver.duplicates() == 2U);
+}
+
+
+BOOST_AUTO_TEST_CASE(foreign_datagrams_are_rejected)
+{
+    Link link;
+    const char garbage[ReliableSession::HEADER_SIZE + 4] = { 'h', 'e', 'l', 'l', 'o' };
+
+    BOOST_TEST(!ReliableSession::isFrame(garbage, sizeof(garbage)));
+    BOOST_TEST(!link.receiver.receive(garbage, sizeof(garbage), link.now));
+    BOOST_TEST(!link.receiver.receive(garbage, 3, link.now));
+    BOOST_TEST(link.received.empty());
+}
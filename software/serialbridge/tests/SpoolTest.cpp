@@ -0,0 +1,229 @@
+/**
+ * @file		SpoolTest.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ */
+
+#define BOOST_TEST_MODULE Spool
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/filesystem.hpp>
+
+#include "BridgeHarness.h"
+#include "Spool.h"
+
+
+/** a spool in a fresh directory, removed afterwards */
+struct SpoolFixture
+{
+    ScratchDirectory        scratch{ "serialbridge-spool" };
+    boost::asio::io_context io;
+    Spool::Settings         settings;
+
+    SpoolFixture()
+    {
+        settings.directory = scratch / "spool";
+        settings.maxBytes = 64 * 1024;
+        settings.segmentBytes = 4096;
+        settings.syncMillis = 0;
+    }
+
+    std::shared_ptr<Spool> open()
+    {
+        return Spool::open(io.get_executor(), settings);
+    }
+
+    size_t files() const
+    {
+        return static_cast<size_t>(std::distance(boost::filesystem::directory_iterator(settings.directory), boost::filesystem::directory_iterator()));
+    }
+
+    /** takes everything out the way the bridge drains, in pieces of at most the given size */
+    static std::string drain(Spool & spool, size_t piece)
+    {
+        std::string data;
+
+        while (!spool.empty())
+        {
+            const boost::asio::const_buffer chunk = spool.front(piece);
+
+            BOOST_REQUIRE(chunk.size() > 0);
+            BOOST_REQUIRE(chunk.size() <= piece);
+
+            data.append(static_cast<const char*>(chunk.data()), chunk.size());
+            spool.consume(chunk.size());
+        }
+
+        return data;
+    }
+};
+
+
+BOOST_FIXTURE_TEST_SUITE(spool, SpoolFixture)
+
+BOOST_AUTO_TEST_CASE(drains_in_order_across_segments)
+{
+    auto spool = open();
+    BOOST_REQUIRE(spool);
+
+    const std::string data = BridgeHarness::pattern(20000);
+
+    // uneven appends, so records straddle the segment boundaries
+    for (size_t offset = 0; offset < data.size(); offset += 777)
+    {
+        spool->append(data.data() + offset, std::min<size_t>(777, data.size() - offset));
+    }
+
+    BOOST_TEST(spool->size() == data.size());
+    BOOST_TEST(spool->segments() > 1U);
+
+    BOOST_TEST(drain(*spool, 1000) == data);
+    BOOST_TEST(spool->empty());
+
+    // drained segments are deleted, the one being written stays
+    BOOST_TEST(spool->segments() == 1U);
+    BOOST_TEST(files() == 1U);
+    BOOST_TEST(spool->statistics().spooledBytes == data.size());
+    BOOST_TEST(spool->statistics().drainedBytes == data.size());
+}
+
+
+BOOST_AUTO_TEST_CASE(recovers_the_pending_data_after_a_restart)
+{
+    const std::string data = BridgeHarness::pattern(10000);
+
+    {
+        auto spool = open();
+        BOOST_REQUIRE(spool);
+
+        spool->append(data.data(), data.size());
+
+        const boost::asio::const_buffer chunk = spool->front(3000);
+        spool->consume(chunk.size());
+    }
+
+    auto spool = open();
+    BOOST_REQUIRE(spool);
+
+    BOOST_TEST(spool->size() == data.size() - 3000);
+    BOOST_TEST(drain(*spool, 512) == data.substr(3000));
+
+    // appending continues behind the recovered segments
+    spool->append("tail", 4);
+    BOOST_TEST(drain(*spool, 512) == "tail");
+}
+
+
+BOOST_AUTO_TEST_CASE(recovers_only_what_was_synced_after_a_crash)
+{
+    settings.syncMillis = 20;
+
+    const std::string data = BridgeHarness::pattern(6000);
+
+    // the child dies without unwinding, the data appended after the last sync was never published
+    const pid_t child = ::fork();
+    BOOST_REQUIRE(child >= 0);
+
+    if (0 == child)
+    {
+        auto spool = open();
+
+        spool->append(data.data(), 4000);
+        io.run_for(std::chrono::milliseconds(100));
+
+        // the flusher thread publishes the sync on its own time
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        spool->append(data.data() + 4000, 2000);
+        ::_exit(spool->statistics().syncs > 0 ? 0 : 1);
+    }
+
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    BOOST_REQUIRE(WIFEXITED(status) && 0 == WEXITSTATUS(status));
+
+    auto spool = open();
+    BOOST_REQUIRE(spool);
+
+    BOOST_TEST(spool->size() == 4000U);
+    BOOST_TEST(drain(*spool, 1024) == data.substr(0, 4000));
+}
+
+
+BOOST_AUTO_TEST_CASE(removes_unreadable_segments_on_recovery)
+{
+    {
+        auto spool = open();
+        BOOST_REQUIRE(spool);
+        spool->append("kept", 4);
+    }
+
+    std::FILE* broken = std::fopen((boost::filesystem::path(settings.directory) / "00000000000000ff.spool").string().c_str(), "w");
+    BOOST_REQUIRE(broken);
+    std::fputs("not a spool segment, far too short", broken);
+    std::fclose(broken);
+
+    auto spool = open();
+    BOOST_REQUIRE(spool);
+
+    BOOST_TEST(drain(*spool, 512) == "kept");
+    BOOST_TEST(!boost::filesystem::exists(boost::filesystem::path(settings.directory) / "00000000000000ff.spool"));
+}
+
+
+BOOST_AUTO_TEST_CASE(drops_the_oldest_data_beyond_its_size)
+{
+    settings.maxBytes = 16 * 1024;
+
+    auto spool = open();
+    BOOST_REQUIRE(spool);
+
+    const std::string data = BridgeHarness::pattern(100000);
+    spool->append(data.data(), data.size());
+
+    BOOST_TEST(spool->size() <= settings.maxBytes);
+    BOOST_TEST(spool->statistics().droppedBytes == data.size() - spool->size());
+
+    // what is left is the newest data, without gaps
+    const std::string kept = drain(*spool, 4096);
+    BOOST_TEST(kept == data.substr(data.size() - kept.size()));
+}
+
+
+BOOST_AUTO_TEST_CASE(syncs_are_batched_per_interval)
+{
+    settings.syncMillis = 20;
+
+    auto spool = open();
+    BOOST_REQUIRE(spool);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        spool->append("x", 1);
+    }
+
+    io.run_for(std::chrono::milliseconds(100));
+
+    BOOST_TEST(spool->statistics().syncs == 1U);
+}
+
+
+BOOST_AUTO_TEST_CASE(rejects_unusable_settings)
+{
+    settings.segmentBytes = 32;
+    BOOST_TEST(!open());
+
+    settings.segmentBytes = 4096;
+    settings.maxBytes = 1024;
+    BOOST_TEST(!open());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
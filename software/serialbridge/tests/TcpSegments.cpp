@@ -0,0 +1,28 @@
+/**
+ * @file		TcpSegments.cpp
+ * @date		17.10.2026
+ * @author		Falk Schilling (db8fs)
+ * @copyright	GPLv3
+ * @remark		a unit of its own: the tcp_info of linux/tcp.h clashes with netinet/tcp.h
+ */
+
+#include <cstdint>
+
+#include <linux/tcp.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+
+/** data segments received on the socket so far (Linux 4.6+) */
+uint32_t dataSegmentsIn(int fd)
+{
+    struct tcp_info info{};
+    socklen_t length = sizeof(info);
+
+    if (0 != ::getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &length))
+    {
+        return 0;
+    }
+
+    return info.tcpi_data_segs_in;
+}